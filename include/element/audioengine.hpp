@@ -16,6 +16,25 @@ class Context;
 class Settings;
 class RootGraph;
 
+/** A snapshot of the engine's realtime counters.
+    @see AudioEngine::getStatistics
+ */
+struct EngineStatistics final {
+    double sampleRate = 0.0;      ///< Current sample rate.
+    int bufferSize = 0;           ///< Block size the engine is prepared for.
+    int lastBlockSize = 0;        ///< Samples rendered by the last callback.
+    int64 callbacks = 0;          ///< Callbacks since the last reset.
+    float cpuLoad = 0.f;          ///< Smoothed share of each block spent rendering.
+    float peakCpuLoad = 0.f;      ///< Highest load since the last reset.
+    int overruns = 0;             ///< Callbacks which took longer than their block.
+    int deviceXRuns = -1;         ///< Xruns reported by the audio device, -1 if unknown.
+    int midiInputEvents = 0;      ///< MIDI events queued for the last block.
+    int peakMidiInputEvents = 0;  ///< Most MIDI events queued for one block.
+    int midiOutputEvents = 0;     ///< MIDI events produced by the last block.
+    int peakMidiOutputEvents = 0; ///< Most MIDI events produced by one block.
+    int latencySamples = 0;       ///< Latency of the active graph.
+};
+
 class AudioEngine final : public juce::ReferenceCountedObject {
 public:
     Signal<void()> sampleLatencyChanged;
@@ -97,6 +116,15 @@ public:
     LevelMeterPtr getLevelMeter (int channel, bool input);
     int getNumChannels (bool input) const noexcept;
 
+    //==========================================================================
+    /** Returns the current statistics.  The counters are updated lock-free
+        on the audio thread, so this is cheap enough to poll from a timer.
+     */
+    EngineStatistics getStatistics() const;
+
+    /** Reset callback counts and peaks. */
+    void resetStatistics();
+
 private:
     class Private;
     std::unique_ptr<Private> priv;
@@ -24,6 +24,11 @@ public:
      */
     static const juce::File applicationDataDir();
 
+    /** Returns the directory for files that can be rebuilt at any time.
+        For example, on Linux this is ~/.cache/Kushview/Element
+     */
+    static const juce::File applicationCacheDir();
+
     /** Returns the default settings file */
     static const juce::File defaultSettingsFile();
 
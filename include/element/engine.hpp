@@ -122,6 +122,31 @@ public:
     /** called when the session loads or re-loads */
     void sessionReloaded();
 
+    /** Set the sessions of a set list.
+
+        The sessions following the one currently open are preloaded on
+        standby: instantiated and prepared but not rendered. Opening one of
+        them swaps its graphs in with the usual graph change crossfade
+        instead of rebuilding them.
+
+        @param sessions     Session files in set list order
+        @param numPreloaded How many of the following sessions to keep loaded
+     */
+    void setSetList (const Array<File>& sessions, int numPreloaded = 1);
+
+    /** Returns the sessions of the current set list. */
+    Array<File> getSetList() const;
+
+    /** Preload a single session on standby. */
+    void preloadSession (const File& file);
+
+    /** Returns the data of a preloaded session, or an invalid tree if the
+        file isn't preloaded or changed since. */
+    ValueTree getPreloadedSession (const File& file) const;
+
+    /** Unload all preloaded sessions. */
+    void clearPreloadedSessions();
+
     /** replace a node with a given plugin */
     void replace (const Node&, const PluginDescription&);
 
@@ -134,6 +159,9 @@ private:
     class RootGraphs;
     friend class RootGraphs;
     std::unique_ptr<RootGraphs> graphs;
+    class SetList;
+    friend class SetList;
+    std::unique_ptr<SetList> setList;
 
     friend class ChangeBroadcaster;
     Node addPlugin (GraphManager& controller, const PluginDescription& desc);
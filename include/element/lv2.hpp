@@ -19,6 +19,7 @@ public:
     juce::String format() const override { return "LV2"; }
     Processor* create (const juce::String&) override;
     juce::StringArray findTypes() override;
+    bool isThreadSafe() const override { return true; }
 
     String nameForURI (const String& uri) const noexcept;
 
@@ -399,9 +399,22 @@ public:
     /** Saves the node state from Processor to state property */
     void savePluginState();
 
+    /** Reads the Processor's state without touching the model. Returns
+        false if there is no prepared Processor. */
+    bool getPluginState (MemoryBlock& state, MemoryBlock& programState) const;
+
+    /** Writes bypass, program, buses and the other settings savePluginState()
+        stores to target, which is this node's data or a copy of it. The
+        plugin state itself isn't read. */
+    void saveProcessorSettings (ValueTree target) const;
+
     /** Reads state property and applies to Processor */
     void restorePluginState();
 
+    /** Applies bypass, gain, MIDI and other node settings to the Processor
+        without touching its program or state. */
+    void restoreProcessorSettings();
+
     //=========================================================================
     /** Get the number of factory presets */
     int getNumPrograms() const;
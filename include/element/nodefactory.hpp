@@ -24,6 +24,9 @@ public:
     virtual StringArray findTypes() = 0;
     /** Return a list of types that should be hidden in the UI by default. */
     virtual StringArray getHiddenTypes() { return {}; }
+    /** Return true if create() and the state of the processors it returns
+        may be used from a background thread while a graph loads. */
+    virtual bool isThreadSafe() const { return false; }
 };
 
 //==========================================================================
@@ -68,6 +71,10 @@ public:
     /** Instantiate a node processor. */
     Processor* instantiate (const String& identifier);
 
+    /** Returns the provider for a description if it can create nodes from a
+        background thread, otherwise nullptr. */
+    NodeProvider* findThreadSafeProvider (const PluginDescription&) const;
+
     /** Wrap an audio plugin instance as a node processor. */
     static Processor* wrap (AudioProcessor*);
 
@@ -15,6 +15,7 @@ class Node;
 class NodeFactory;
 class NodeProvider;
 class PluginScannerCoordinator;
+class PluginScanCache;
 class PluginScanner;
 
 class PluginManager : public juce::ChangeBroadcaster {
@@ -135,7 +136,8 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginManager)
 };
 
-class PluginScanner : private juce::Timer {
+class PluginScanner : private juce::Timer,
+                      private juce::AsyncUpdater {
 public:
     PluginScanner (juce::KnownPluginList&);
     ~PluginScanner();
@@ -150,8 +152,26 @@ public:
         virtual void audioPluginScanStarted (const juce::String& name) {}
     };
 
+    /** The merged plugin list written when a scan finishes. */
     static const juce::File& getWorkerPluginListFile();
 
+    /** Set the number of scanner processes used in parallel. Plugin files
+        are divided evenly between them. */
+    void setNumWorkers (int numWorkers);
+
+    /** Returns the number of scanner processes used in parallel. */
+    int getNumWorkers() const noexcept { return numWorkers; }
+
+    /** Returns the default number of scanner processes for this machine. */
+    static int getDefaultNumWorkers();
+
+    /** Set the time a single plugin may take to scan before it is
+        considered hung and added to the dead plugins list. */
+    void setPluginTimeout (int milliseconds) { pluginTimeout = milliseconds; }
+
+    /** Returns the time a single plugin may take to scan. */
+    int getPluginTimeout() const noexcept { return pluginTimeout; }
+
     /** scan for plugins of type */
     void scanForAudioPlugins (const juce::String& formatName);
 
@@ -176,11 +196,16 @@ public:
 private:
     friend class PluginScannerCoordinator;
     friend class juce::Timer;
-    std::unique_ptr<PluginScannerCoordinator> master;
+    juce::OwnedArray<PluginScannerCoordinator> workers;
+    std::shared_ptr<PluginScanCache> cache;
     juce::ListenerList<Listener> listeners;
     juce::StringArray failedIdentifiers;
     juce::KnownPluginList& list;
+    int numWorkers = 1;
+    int pluginTimeout = 60000;
     void timerCallback() override;
+    void handleAsyncUpdate() override;
+    void workerFinished();
 };
 
 } // namespace element
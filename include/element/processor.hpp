@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <element/juce/core.hpp>
 #include <element/juce/audio_basics.hpp>
 #include <element/juce/audio_processors.hpp>
@@ -288,6 +290,20 @@ public:
     void setOutputRMS (int chan, float val);
     float getOutputRMS (int chan) const { return (chan < outRMS.size()) ? outRMS.getUnchecked (chan)->get() : 0.0f; }
 
+    /** Returns the smoothed share of each block this node spends rendering.
+        1.0 means rendering takes as long as the block lasts.
+     */
+    float getCpuLoad() const noexcept { return cpuLoad.get(); }
+
+    /** Returns the highest load seen since the last call to resetPeakCpuLoad. */
+    float getPeakCpuLoad() const noexcept { return peakCpuLoad.get(); }
+
+    /** Forget the peak load. */
+    void resetPeakCpuLoad() noexcept { peakCpuLoad = 0.f; }
+
+    /** Record how long one render took. Called by the graph on the audio thread. */
+    void updateCpuLoad (int64 elapsedTicks, int numSamples) noexcept;
+
     //=========================================================================
     /** Connect this node's output audio to another node's input audio */
     void connectAudioTo (const Processor* other);
@@ -328,6 +344,13 @@ public:
     /** Returns the file used for the current global MIDI Program */
     File getMidiProgramFile (int program = -1) const;
 
+    /** Returns the directory global MIDI programs are kept in. */
+    static File getGlobalMidiProgramsDirectory();
+
+    /** Change the directory global MIDI programs are kept in.  An invalid
+        file goes back to DataPath::defaultGlobalMidiProgramsDir(). */
+    static void setGlobalMidiProgramsDirectory (const File& directory);
+
     /** Returns true if this node should use global MIDI programs */
     inline bool useGlobalMidiPrograms() const { return globalMidiPrograms.get() == 1; }
 
@@ -362,6 +385,16 @@ public:
     /** Removes a MIDI Program */
     void removeMidiProgram (int program, bool global);
 
+    /** Reads and decodes this node's global MIDI programs into memory so
+        program changes can be applied without touching the disk. The cache
+        is shared by every node using the same program files. */
+    void preloadMidiPrograms();
+
+    /** Forget a cached global MIDI program so it is read again from disk
+        next time, pass -1 to forget all of them. Call this after writing
+        a program file so other nodes using it see the new state. */
+    void clearMidiProgramCache (int program = -1);
+
     /** Get all MIDI program states stored directly on the node */
     void getMidiProgramsState (String& state) const;
 
@@ -419,7 +452,22 @@ public:
     virtual void getState (MemoryBlock&) = 0;
     virtual void setState (const void*, int sizeInBytes) = 0;
 
+    /** Returns a number that changes whenever this node's state may have
+        changed. Autosave uses it to skip nodes that didn't change. */
+    int getStateVersion() const noexcept { return stateVersion.get(); }
+
+    /** Flag the state as changed. Input parameter changes do this already,
+        nodes with state outside their parameters should call it when that
+        state changes. Safe to call from any thread. */
+    void markStateChanged() noexcept { ++stateVersion; }
+
     //==========================================================================
+    /** Set the oversampling factor (1, 2, 4 or 8).
+
+        When used on a sub graph, the whole graph renders at the higher rate
+        with a single up and down conversion at its IO boundary. Has no effect
+        on root graphs.
+     */
     void setOversamplingFactor (int osFactor);
     int getOversamplingFactor();
 
@@ -428,6 +476,18 @@ public:
     double getDelayCompensation() const;
     int getDelayCompensationSamples() const;
 
+    //==========================================================================
+    /** Exclude this node's paths from the parent graph's latency alignment.
+
+        Connections into and out of a live node are never delayed, so signals
+        through it take the shortest path. Setting this on a sub graph does the
+        same for every node inside it. Other paths are still aligned.
+     */
+    void setLiveMode (bool live);
+
+    /** Returns true if live mode is enabled on this node. */
+    bool isLiveMode() const { return liveMode.get() == 1; }
+
     //=========================================================================
     virtual bool hasEditor() { return false; }
     virtual Editor* createEditor() { return nullptr; }
@@ -504,6 +564,7 @@ private:
     Atomic<int> bypassed { 0 };
     Atomic<int> mute { 0 };
     Atomic<int> muteInput { 0 };
+    Atomic<int> liveMode { 0 };
 
     double sampleRate = 0.0;
     int blockSize = 0;
@@ -513,8 +574,18 @@ private:
     ParameterArray parameters, parametersOut;
     PatchParameterArray _patches;
 
+    struct StateTracker : public Parameter::Listener
+    {
+        StateTracker (Processor& p) : owner (p) {}
+        void controlValueChanged (int, float) override { owner.markStateChanged(); }
+        void controlTouched (int, bool) override {}
+        Processor& owner;
+    } stateTracker { *this };
+    Atomic<int> stateVersion { 0 };
+
     Atomic<float> gain, lastGain, inputGain, lastInputGain;
     OwnedArray<AtomicValue<float>> inRMS, outRMS;
+    Atomic<float> cpuLoad { 0.f }, peakCpuLoad { 0.f };
 
     Atomic<int> keyRangeLow { 0 };
     Atomic<int> keyRangeHigh { 127 };
@@ -557,6 +628,10 @@ private:
     mutable OwnedArray<MidiProgram> midiPrograms;
     MidiProgram* getMidiProgram (int) const;
 
+    /** Returns the decoded state of a global program from the cache shared
+        by all nodes, empty when the program has no file. */
+    std::shared_ptr<const MemoryBlock> getGlobalMidiProgramState (int program);
+
     void setParentGraph (GraphNode*);
     void prepare (double sampleRate, int blockSize, GraphNode*, bool willBeEnabled = false);
     void unprepare();
@@ -100,8 +100,10 @@ public:
     void setActiveGraph (int index);
     bool containsGraph (const Node& graph) const;
 
-    /** Writes an encoded file */
+    /** Writes a binary, chunked session archive. */
     bool writeToFile (const File&) const;
+
+    /** Reads a session archive or an older gzipped session file. */
     static ValueTree readFromFile (const File&);
 
     Value getActiveGraphIndexObject (bool syncUpdate = false) const
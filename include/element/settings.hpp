@@ -50,6 +50,10 @@ public:
     static const char* updateKeyKey;
     static const char* updateKeyUserKey;
     static const char* transportStartStopContinue;
+    static const char* diskStreamingThreadsKey;
+    static const char* diskStreamingLatencyKey;
+    static const char* binarySessionsKey;
+    static const char* autosaveIntervalKey;
 
     std::unique_ptr<juce::XmlElement> getLastGraph() const;
     void setLastGraph (const juce::ValueTree& data);
@@ -85,6 +89,14 @@ public:
     bool askToSaveSession();
     void setAskToSaveSession (const bool);
 
+    /** True if sessions should be saved as binary archives instead of XML */
+    bool binarySessions() const;
+    void setBinarySessions (bool);
+
+    /** Seconds between autosaves of a changed session, zero disables it */
+    int getAutosaveInterval() const;
+    void setAutosaveInterval (int seconds);
+
     const juce::File getDefaultNewSessionFile() const;
     void setDefaultNewSessionFile (const juce::File&);
 
@@ -158,6 +170,15 @@ public:
     void setTransportRespondToStartStopContinue (bool shouldRespond);
     bool transportRespondToStartStopContinue() const;
 
+    /** Returns the number of threads shared by audio file streaming. */
+    int getDiskStreamingThreads() const;
+    void setDiskStreamingThreads (int numThreads);
+
+    /** Returns the worst case disk read time, in milliseconds, that audio
+        file streams buffer ahead for. */
+    double getDiskStreamingLatency() const;
+    void setDiskStreamingLatency (double latencyMs);
+
 private:
     juce::PropertiesFile* getProps() const;
 };
@@ -60,6 +60,10 @@ public:
         panic,
         importSession,
 
+        sessionOpenSetList,
+        sessionNextInSetList,
+        sessionPreviousInSetList,
+
         checkNewerVersion = 0x0500,
 
         signIn,
@@ -142,6 +146,10 @@ public:
             panic,
             importSession,
 
+            sessionOpenSetList,
+            sessionNextInSetList,
+            sessionPreviousInSetList,
+
             checkNewerVersion,
 
             signIn,
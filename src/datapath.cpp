@@ -58,6 +58,24 @@ const File DataPath::applicationDataDir()
 #endif
 }
 
+const File DataPath::applicationCacheDir()
+{
+#if JUCE_MAC
+    return File::getSpecialLocation (File::userApplicationDataDirectory)
+        .getChildFile ("Caches")
+        .getChildFile (EL_APP_DATA_SUBDIR);
+#elif JUCE_WINDOWS
+    return File::getSpecialLocation (File::windowsLocalAppData)
+        .getChildFile (EL_APP_DATA_SUBDIR)
+        .getChildFile ("Cache");
+#else
+    const auto xdg = SystemStats::getEnvironmentVariable ("XDG_CACHE_HOME", {});
+    const auto base = File::isAbsolutePath (xdg) ? File (xdg)
+                                                 : File::getSpecialLocation (File::userHomeDirectory).getChildFile (".cache");
+    return base.getChildFile (EL_APP_DATA_SUBDIR);
+#endif
+}
+
 const File DataPath::defaultUserDataPath()
 {
     return File::getSpecialLocation (File::userMusicDirectory)
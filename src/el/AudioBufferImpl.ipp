@@ -196,6 +196,93 @@ static int audio_fade (lua_State* L)
     return 0;
 }
 
+/** Source and range of a bulk operation.  Resolves the two call forms,
+    `(src [, gain])` for all channels and `(channel, src, srcchannel [, gain])`
+    for one.
+ */
+namespace {
+struct BulkOp
+{
+    Buffer* source;
+    int channel, sourceChannel, numChannels, numFrames;
+    SampleType gain;
+};
+} // namespace
+
+static BulkOp audio_bulkop (lua_State* L, Buffer* buf, lua_Number defaultGain)
+{
+    BulkOp op;
+    if (lua_isinteger (L, 2))
+    {
+        op.channel = static_cast<int> (lua_tointeger (L, 2) - 1);
+        op.source = *(Buffer**) luaL_checkudata (L, 3, EL_MT_AUDIO_BUFFER_IMPL);
+        op.sourceChannel = static_cast<int> (luaL_checkinteger (L, 4) - 1);
+        op.numChannels = 1;
+        op.gain = static_cast<SampleType> (luaL_optnumber (L, 5, defaultGain));
+        luaL_argcheck (L, op.channel >= 0 && op.channel < buf->getNumChannels(), 2, "channel out of range");
+        luaL_argcheck (L, op.sourceChannel >= 0 && op.sourceChannel < op.source->getNumChannels(), 4, "channel out of range");
+    }
+    else
+    {
+        op.source = *(Buffer**) luaL_checkudata (L, 2, EL_MT_AUDIO_BUFFER_IMPL);
+        op.channel = op.sourceChannel = 0;
+        op.numChannels = juce::jmin (buf->getNumChannels(), op.source->getNumChannels());
+        op.gain = static_cast<SampleType> (luaL_optnumber (L, 3, defaultGain));
+    }
+
+    op.numFrames = juce::jmin (buf->getNumSamples(), op.source->getNumSamples());
+    return op;
+}
+
+static int audio_copy (lua_State* L)
+{
+    auto* buf = toclassref (L, 1);
+    const auto op = audio_bulkop (L, buf, 1.0);
+    for (int i = 0; i < op.numChannels; ++i)
+    {
+        if (op.gain == SampleType (1))
+            buf->copyFrom (op.channel + i, 0, *op.source, op.sourceChannel + i, 0, op.numFrames);
+        else
+            buf->copyFromWithRamp (op.channel + i, 0, op.source->getReadPointer (op.sourceChannel + i), op.numFrames, op.gain, op.gain);
+    }
+    return 0;
+}
+
+static int audio_add (lua_State* L)
+{
+    auto* buf = toclassref (L, 1);
+    const auto op = audio_bulkop (L, buf, 1.0);
+    for (int i = 0; i < op.numChannels; ++i)
+        buf->addFrom (op.channel + i, 0, *op.source, op.sourceChannel + i, 0, op.numFrames, op.gain);
+    return 0;
+}
+
+static int audio_multiply (lua_State* L)
+{
+    auto* buf = toclassref (L, 1);
+    const auto op = audio_bulkop (L, buf, 1.0);
+    for (int i = 0; i < op.numChannels; ++i)
+    {
+        auto* dst = buf->getWritePointer (op.channel + i);
+        juce::FloatVectorOperations::multiply (dst, op.source->getReadPointer (op.sourceChannel + i), op.numFrames);
+        if (op.gain != SampleType (1))
+            juce::FloatVectorOperations::multiply (dst, op.gain, op.numFrames);
+    }
+    return 0;
+}
+
+static int audio_mix (lua_State* L)
+{
+    auto* buf = toclassref (L, 1);
+    const auto op = audio_bulkop (L, buf, 0.5);
+    for (int i = 0; i < op.numChannels; ++i)
+    {
+        buf->applyGain (op.channel + i, 0, op.numFrames, SampleType (1) - op.gain);
+        buf->addFrom (op.channel + i, 0, *op.source, op.sourceChannel + i, 0, op.numFrames, op.gain);
+    }
+    return 0;
+}
+
 static int audio_free (lua_State* L)
 {
     auto** buf = (Buffer**) lua_touserdata (L, 1);
@@ -358,6 +445,60 @@ static const luaL_Reg buffer_methods[] = {
     // @number gain2 End gain
     // @function AudioBuffer:fade
     { "fade", audio_fade },
+
+    /// Copy another buffer into this one, channel by channel.
+    // Only the channels and samples both buffers have are copied.
+    // @param src Buffer to copy from, same precision as this one
+    // @number[opt=1] gain Gain to apply while copying
+    // @function AudioBuffer:copy
+
+    /// Copy one channel of another buffer into a channel of this one.
+    // @int channel Channel to copy to
+    // @param src Buffer to copy from
+    // @int srcchannel Channel to copy from
+    // @number[opt=1] gain Gain to apply while copying
+    // @function AudioBuffer:copy
+    { "copy", audio_copy },
+
+    /// Add another buffer to this one, channel by channel.
+    // @param src Buffer to add
+    // @number[opt=1] gain Gain to apply to the source
+    // @function AudioBuffer:add
+
+    /// Add one channel of another buffer to a channel of this one.
+    // @int channel Channel to add to
+    // @param src Buffer to add
+    // @int srcchannel Channel to add from
+    // @number[opt=1] gain Gain to apply to the source
+    // @function AudioBuffer:add
+    { "add", audio_add },
+
+    /// Multiply this buffer by another one, sample by sample.
+    // @param src Buffer to multiply by
+    // @number[opt=1] gain Extra gain applied to the result
+    // @function AudioBuffer:multiply
+
+    /// Multiply a channel by a channel of another buffer.
+    // @int channel Channel to multiply
+    // @param src Buffer to multiply by
+    // @int srcchannel Channel to multiply by
+    // @number[opt=1] gain Extra gain applied to the result
+    // @function AudioBuffer:multiply
+    { "multiply", audio_multiply },
+
+    /// Crossfade towards another buffer.
+    // Each sample becomes `self * (1 - amount) + src * amount`.
+    // @param src Buffer to mix in
+    // @number[opt=0.5] amount Amount of the source, 0 to 1
+    // @function AudioBuffer:mix
+
+    /// Crossfade one channel towards a channel of another buffer.
+    // @int channel Channel to mix into
+    // @param src Buffer to mix in
+    // @int srcchannel Channel to mix from
+    // @number[opt=0.5] amount Amount of the source, 0 to 1
+    // @function AudioBuffer:mix
+    { "mix", audio_mix },
     { NULL, NULL }
 };
 
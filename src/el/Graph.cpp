@@ -8,8 +8,32 @@
 
 #include <element/element.h>
 #include <element/graph.hpp>
+#include "engine/graphmanager.hpp"
+#include "engine/graphnode.hpp"
 #include "./nodetype.hpp"
 
+namespace element {
+namespace lua {
+
+static GraphManager& checkManager (const Graph& graph)
+{
+    if (auto* manager = GraphManager::forModel (graph))
+        return *manager;
+    throw std::runtime_error ("graph is not loaded in the engine");
+}
+
+static uint32 checkNodeId (const sol::object& obj)
+{
+    if (obj.is<Node>())
+        return obj.as<Node&>().getNodeId();
+    if (obj.get_type() == sol::type::number)
+        return static_cast<uint32> (obj.as<lua_Integer>());
+    throw std::runtime_error ("expected el.Node or node ID");
+}
+
+} // namespace lua
+} // namespace element
+
 // clang-format off
 EL_PLUGIN_EXPORT int luaopen_el_Graph (lua_State* L)
 {
@@ -30,7 +54,104 @@ EL_PLUGIN_EXPORT int luaopen_el_Graph (lua_State* L)
         /// Returns the view script if available.
         // @function Graph:viewScript
         // @treturn el.Script True if yes
-        "viewScript",     &Graph::findViewScript
+        "viewScript",     &Graph::findViewScript,
+
+        /// Add a node to this graph.
+        // The graph must be loaded in the engine.
+        // @function Graph:addNode
+        // @string identifier Node or plugin identifier
+        // @string[opt="Element"] format Plugin format name
+        // @treturn el.Node The new node or nil if it couldn't be created
+        "addNode", [](Graph& self, const std::string& identifier, sol::optional<std::string> format) {
+            auto& manager = lua::checkManager (self);
+            PluginDescription desc;
+            desc.fileOrIdentifier = identifier;
+            desc.pluginFormatName = format.value_or (EL_NODE_FORMAT_NAME);
+            const auto nodeId = manager.addNode (&desc, 0.5, 0.5);
+            const auto node = manager.getNodeModelForId (nodeId);
+            return node.isValid() ? std::make_shared<Node> (node.data(), false)
+                                  : std::shared_ptr<Node>();
+        },
+
+        /// Connect two ports.
+        // Nodes can be given as @{el.Node}s or node IDs.
+        // @function Graph:connect
+        // @param source Source node
+        // @int sourcePort Source port index
+        // @param destination Destination node
+        // @int destinationPort Destination port index
+        // @treturn bool True if connected
+        "connect", [](Graph& self, sol::object src, int srcPort, sol::object dst, int dstPort) {
+            auto& manager = lua::checkManager (self);
+            return manager.addConnection (lua::checkNodeId (src), srcPort, lua::checkNodeId (dst), dstPort);
+        },
+
+        /// Make many changes at once.
+        // Calls a function and defers updating the connections model and
+        // rebuilding the engine until it returns, so adding hundreds of
+        // nodes and connections costs a single rebuild. Calls may nest.
+        // Errors raised by the function are passed on after the batch ends.
+        // @function Graph:batch
+        // @tparam function f Function making the changes
+        // @return Whatever `f` returns
+        // @usage
+        // graph:batch (function()
+        //     local last = nil
+        //     for i = 1, 100 do
+        //         local node = graph:addNode ('el.Volume')
+        //         if last then graph:connect (last, 0, node, 0) end
+        //         last = node
+        //     end
+        // end)
+        "batch", [](Graph& self, sol::protected_function f, sol::this_state ts) {
+            auto& manager = lua::checkManager (self);
+            sol::protected_function_result result;
+            {
+                GraphManager::ScopedBatch batch (manager);
+                result = f();
+            }
+
+            if (! result.valid())
+            {
+                sol::error error = result;
+                throw error;
+            }
+
+            return result;
+        },
+
+        /// Returns the delay compensation applied to connections.
+        // Each entry is a table with `source`, `sourcePort`, `destination`,
+        // `destinationPort`, `type`, `delay`, `live` and `unaligned` fields.
+        // Node fields are node IDs. `delay` and `unaligned` are in samples,
+        // `unaligned` being how far a live mode path is ahead of the slowest
+        // input it mixes with.
+        // @function Graph:latencyCompensation
+        // @treturn table Array of compensation entries.
+        "latencyCompensation", [](Graph& self, sol::this_state ts) {
+            sol::state_view L (ts);
+            auto report = L.create_table();
+            auto* const graph = dynamic_cast<GraphNode*> (self.getObject());
+            if (graph == nullptr)
+                return report;
+
+            int index = 0;
+            for (const auto& lc : graph->getLatencyCompensation())
+            {
+                auto entry = L.create_table();
+                entry["source"]          = static_cast<lua_Integer> (lc.sourceNode);
+                entry["sourcePort"]      = static_cast<lua_Integer> (lc.sourcePort);
+                entry["destination"]     = static_cast<lua_Integer> (lc.destNode);
+                entry["destinationPort"] = static_cast<lua_Integer> (lc.destPort);
+                entry["type"]            = lc.type.getSlug().toStdString();
+                entry["delay"]           = lc.delaySamples;
+                entry["live"]            = lc.live;
+                entry["unaligned"]       = lc.unalignedSamples;
+                report[++index] = entry;
+            }
+
+            return report;
+        }
     );
 
     sol::stack::push (L, element::lua::removeAndClear (M, "Graph"));
@@ -14,6 +14,8 @@
 
 #include <element/juce.hpp>
 
+#include <limits>
+
 #define EL_MT_MIDI_BUFFER_TYPE "el.MidiBufferClass"
 
 using MidiBuffer = juce::MidiBuffer;
@@ -64,6 +66,7 @@ static int midibuffer_reserve (lua_State* L)
     {
         auto size = lua_tointeger (L, 2);
         (*impl).buffer.ensureSize (static_cast<size_t> (size));
+        (*impl).scratch.ensureSize (static_cast<size_t> (size));
         lua_pushinteger (L, size);
     }
     else
@@ -73,6 +76,19 @@ static int midibuffer_reserve (lua_State* L)
     return 1;
 }
 
+/** Push an iterator closure bound to the buffer, creating it only once. */
+static void midibuffer_pushiterator (lua_State* L, Impl* impl, int& ref, lua_CFunction f)
+{
+    impl->resetIterator();
+    if (ref == LUA_REFNIL)
+    {
+        lua_pushlightuserdata (L, impl);
+        lua_pushcclosure (L, f, 1);
+        ref = luaL_ref (L, LUA_REGISTRYINDEX);
+    }
+    lua_rawgeti (L, LUA_REGISTRYINDEX, ref);
+}
+
 //==============================================================================
 static int midibuffer_events_closure (lua_State* L)
 {
@@ -96,9 +112,7 @@ static int midibuffer_events_closure (lua_State* L)
 static int midibuffer_events (lua_State* L)
 {
     auto* impl = *(Impl**) lua_touserdata (L, 1);
-    impl->resetIterator();
-    lua_pushlightuserdata (L, impl);
-    lua_pushcclosure (L, midibuffer_events_closure, 1);
+    midibuffer_pushiterator (L, impl, impl->eventsref, midibuffer_events_closure);
     return 1;
 }
 
@@ -124,12 +138,99 @@ static int midibuffer_messages_closure (lua_State* L)
 static int midibuffer_messages (lua_State* L)
 {
     auto* impl = *(Impl**) lua_touserdata (L, 1);
-    impl->resetIterator();
-    lua_pushlightuserdata (L, impl);
-    lua_pushcclosure (L, midibuffer_messages_closure, 1);
+    midibuffer_pushiterator (L, impl, impl->messagesref, midibuffer_messages_closure);
+    return 1;
+}
+
+//==============================================================================
+static void midibuffer_pushraw (lua_State* L, const juce::MidiMessageMetadata& ref)
+{
+    lua_pushinteger (L, ref.numBytes > 0 ? ref.data[0] : 0);
+    lua_pushinteger (L, ref.numBytes > 1 ? ref.data[1] : 0);
+    lua_pushinteger (L, ref.numBytes > 2 ? ref.data[2] : 0);
+    lua_pushinteger (L, ref.samplePosition + 1);
+}
+
+static int midibuffer_raw_closure (lua_State* L)
+{
+    auto* impl = (Impl*) lua_touserdata (L, lua_upvalueindex (1));
+    if (impl->iter == impl->buffer.end())
+    {
+        lua_pushnil (L);
+        return 1;
+    }
+
+    midibuffer_pushraw (L, *impl->iter);
+    ++impl->iter;
+    return 4;
+}
+
+static int midibuffer_raw (lua_State* L)
+{
+    auto* impl = *(Impl**) lua_touserdata (L, 1);
+    midibuffer_pushiterator (L, impl, impl->rawref, midibuffer_raw_closure);
     return 1;
 }
 
+static int midibuffer_filter (lua_State* L)
+{
+    auto* impl = *(Impl**) lua_touserdata (L, 1);
+    luaL_checktype (L, 2, LUA_TFUNCTION);
+
+    auto& out = impl->scratch;
+    out.clear();
+
+    for (const auto ref : impl->buffer)
+    {
+        lua_pushvalue (L, 2);
+        midibuffer_pushraw (L, ref);
+        lua_call (L, 4, 3);
+
+        if (lua_isinteger (L, -3))
+        {
+            const juce::uint8 bytes[3] = {
+                static_cast<juce::uint8> (lua_tointeger (L, -3)),
+                static_cast<juce::uint8> (lua_isinteger (L, -2) ? lua_tointeger (L, -2) : (ref.numBytes > 1 ? ref.data[1] : 0)),
+                static_cast<juce::uint8> (lua_isinteger (L, -1) ? lua_tointeger (L, -1) : (ref.numBytes > 2 ? ref.data[2] : 0))
+            };
+            out.addEvent (bytes, MidiMessage::getMessageLengthFromFirstByte (bytes[0]), ref.samplePosition);
+        }
+        else if (lua_toboolean (L, -3))
+        {
+            out.addEvent (ref.data, ref.numBytes, ref.samplePosition);
+        }
+
+        lua_pop (L, 3);
+    }
+
+    impl->buffer.swapWith (out);
+    out.clear();
+    return 0;
+}
+
+static int midibuffer_insertRaw (lua_State* L)
+{
+    auto* impl = *(Impl**) luaL_checkudata (L, 1, EL_MT_MIDI_BUFFER);
+    const auto status = luaL_checkinteger (L, 2);
+    const auto data1 = luaL_checkinteger (L, 3);
+    const auto data2 = luaL_checkinteger (L, 4);
+    const auto frame = luaL_checkinteger (L, 5);
+    luaL_argcheck (L, status >= 0x80 && status <= 0xff, 2, "not a status byte");
+    luaL_argcheck (L, data1 >= 0 && data1 <= 0x7f, 3, "not a data byte");
+    luaL_argcheck (L, data2 >= 0 && data2 <= 0x7f, 4, "not a data byte");
+    luaL_argcheck (L, frame >= 1 && frame <= std::numeric_limits<int>::max(), 5, "frame out of range");
+
+    const juce::uint8 bytes[3] = {
+        static_cast<juce::uint8> (status),
+        static_cast<juce::uint8> (data1),
+        static_cast<juce::uint8> (data2)
+    };
+    impl->buffer.addEvent (bytes,
+                           MidiMessage::getMessageLengthFromFirstByte (bytes[0]),
+                           static_cast<int> (frame) - 1);
+    return 0;
+}
+
 //==============================================================================
 static int midibuffer_insertMessage (lua_State* L)
 {
@@ -364,6 +465,44 @@ static const luaL_Reg buffer_methods[] = {
     // @int frame Sample position to insert at
     { "insertMessage", midibuffer_insertMessage },
 
+    /// Iterate over events as plain integers.
+    // Nothing is allocated, so this is the fastest way to read MIDI. Bytes
+    // past the end of a short message are 0, for longer ones like SysEx only
+    // the first three bytes are given.
+    // @function MidiBuffer:raw
+    // @return event iterator
+    // @usage
+    // for status, data1, data2, frame in buffer:raw() do
+    //     -- do something with midi data
+    // end
+    { "raw", midibuffer_raw },
+
+    /// Filter events in place.
+    // Calls a function for every event with `status, data1, data2, frame`.
+    // Return true to keep the event, false or nothing to drop it, or new
+    // `status [, data1 [, data2]]` integers to replace it. Events go to a
+    // buffer reserved with the same size as this one, so filtering doesn't
+    // allocate unless the output outgrows it.
+    // @function MidiBuffer:filter
+    // @tparam function f Filter function
+    // @usage
+    // -- transpose notes up an octave, drop everything else
+    // buffer:filter (function (status, d1, d2)
+    //     local kind = status & 0xf0
+    //     if kind == 0x90 or kind == 0x80 then return status, d1 + 12, d2 end
+    // end)
+    { "filter", midibuffer_filter },
+
+    /// Add a short message from integers.
+    // The message length follows from the status byte. Unlike most methods
+    // the arguments are checked, bytes and frame must be in range.
+    // @function MidiBuffer:insertRaw
+    // @int status Status byte
+    // @int data1 First data byte
+    // @int data2 Second data byte
+    // @int frame Sample position to insert at
+    { "insertRaw", midibuffer_insertRaw },
+
     /// Add messages from another buffer.
     // @function MidiBuffer:addBuffer
     // @tparam el.MidiBuffer buf Buffer to copy from
@@ -0,0 +1,298 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+/// A fixed size vector of 32bit samples.
+// Bulk methods run natively and use SIMD where available, so scripts can
+// process whole blocks without a per-sample loop in Lua.
+// - **Indexing**: Values are 1-indexed. `#vec` is the size.
+// - **Realtime**: Nothing allocates except `Vector.new`.
+// @classmod el.Vector
+// @pragma nostrip
+
+#include <cmath>
+
+#include "vector.hpp"
+
+#define EL_MT_VECTOR_TYPE "el.VectorClass"
+
+namespace lua = element::lua;
+using FVO = juce::FloatVectorOperations;
+
+static lua::Vector* vector_check (lua_State* L, int index)
+{
+    return (lua::Vector*) luaL_checkudata (L, index, EL_MT_VECTOR);
+}
+
+/// Create a new vector.
+// @int size Number of values, all zero
+// @function Vector.new
+// @return A new vector
+// @within Constructors
+// @usage
+// local Vector = require ('el.Vector')
+// local tmp = Vector.new (512)
+static int vector_new (lua_State* L)
+{
+    lua::new_vector (L, (int) luaL_optinteger (L, 1, 0));
+    return 1;
+}
+
+static int vector_len (lua_State* L)
+{
+    lua_pushinteger (L, ((lua::Vector*) lua_touserdata (L, 1))->size);
+    return 1;
+}
+
+static int vector_index (lua_State* L)
+{
+    auto* vec = (lua::Vector*) lua_touserdata (L, 1);
+    if (lua_isinteger (L, 2))
+    {
+        const auto i = lua_tointeger (L, 2) - 1;
+        if (i >= 0 && i < vec->size)
+            lua_pushnumber (L, vec->values[i]);
+        else
+            lua_pushnil (L);
+        return 1;
+    }
+
+    lua_pushvalue (L, 2);
+    lua_rawget (L, lua_upvalueindex (1));
+    return 1;
+}
+
+static int vector_newindex (lua_State* L)
+{
+    auto* vec = (lua::Vector*) lua_touserdata (L, 1);
+    const auto i = luaL_checkinteger (L, 2) - 1;
+    luaL_argcheck (L, i >= 0 && i < vec->size, 2, "index out of range");
+    vec->values[i] = static_cast<float> (luaL_checknumber (L, 3));
+    return 0;
+}
+
+static int vector_tostring (lua_State* L)
+{
+    auto* vec = (lua::Vector*) lua_touserdata (L, 1);
+    lua_pushfstring (L, "el.Vector: size=%d", vec->size);
+    return 1;
+}
+
+static int vector_size (lua_State* L)
+{
+    lua_pushinteger (L, vector_check (L, 1)->size);
+    return 1;
+}
+
+static int vector_clear (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    FVO::clear (vec->values, vec->size);
+    return 0;
+}
+
+static int vector_fill (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    FVO::fill (vec->values, static_cast<float> (luaL_checknumber (L, 2)), vec->size);
+    return 0;
+}
+
+static int vector_copy (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    auto* src = vector_check (L, 2);
+    const auto gain = static_cast<float> (luaL_optnumber (L, 3, 1.0));
+    const int n = juce::jmin (vec->size, src->size);
+    if (gain == 1.f)
+        FVO::copy (vec->values, src->values, n);
+    else
+        FVO::copyWithMultiply (vec->values, src->values, gain, n);
+    return 0;
+}
+
+static int vector_add (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    if (lua_type (L, 2) == LUA_TNUMBER)
+    {
+        FVO::add (vec->values, static_cast<float> (lua_tonumber (L, 2)), vec->size);
+        return 0;
+    }
+
+    auto* src = vector_check (L, 2);
+    const auto gain = static_cast<float> (luaL_optnumber (L, 3, 1.0));
+    const int n = juce::jmin (vec->size, src->size);
+    if (gain == 1.f)
+        FVO::add (vec->values, src->values, n);
+    else
+        FVO::addWithMultiply (vec->values, src->values, gain, n);
+    return 0;
+}
+
+static int vector_multiply (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    if (lua_type (L, 2) == LUA_TNUMBER)
+    {
+        FVO::multiply (vec->values, static_cast<float> (lua_tonumber (L, 2)), vec->size);
+        return 0;
+    }
+
+    auto* src = vector_check (L, 2);
+    FVO::multiply (vec->values, src->values, juce::jmin (vec->size, src->size));
+    return 0;
+}
+
+static int vector_mix (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    auto* src = vector_check (L, 2);
+    const auto amount = static_cast<float> (luaL_optnumber (L, 3, 0.5));
+    const int n = juce::jmin (vec->size, src->size);
+    FVO::multiply (vec->values, 1.f - amount, n);
+    FVO::addWithMultiply (vec->values, src->values, amount, n);
+    return 0;
+}
+
+static int vector_peak (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    const auto range = FVO::findMinAndMax (vec->values, vec->size);
+    lua_pushnumber (L, juce::jmax (std::abs (range.getStart()), std::abs (range.getEnd())));
+    return 1;
+}
+
+static int vector_rms (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    double sum = 0.0;
+    for (int i = 0; i < vec->size; ++i)
+        sum += (double) vec->values[i] * vec->values[i];
+    lua_pushnumber (L, vec->size > 0 ? std::sqrt (sum / vec->size) : 0.0);
+    return 1;
+}
+
+static int vector_read (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    lua::SampleBlock block;
+    lua::check_block (L, 2, block);
+    const int n = juce::jmin (vec->size, block.size);
+    if (block.f32 != nullptr)
+        FVO::copy (vec->values, block.f32, n);
+    else
+        for (int i = 0; i < n; ++i)
+            vec->values[i] = static_cast<float> (block.f64[i]);
+    return 0;
+}
+
+static int vector_write (lua_State* L)
+{
+    auto* vec = vector_check (L, 1);
+    lua::SampleBlock block;
+    const int next = lua::check_block (L, 2, block);
+    const auto gain = static_cast<float> (luaL_optnumber (L, next, 1.0));
+    const int n = juce::jmin (vec->size, block.size);
+    if (block.f32 != nullptr)
+        FVO::copyWithMultiply (block.f32, vec->values, gain, n);
+    else
+        for (int i = 0; i < n; ++i)
+            block.f64[i] = static_cast<double> (vec->values[i] * gain);
+    return 0;
+}
+
+//==============================================================================
+static const luaL_Reg vector_metamethods[] = {
+    { "__len", vector_len },
+    { "__newindex", vector_newindex },
+    { "__tostring", vector_tostring },
+    { NULL, NULL }
+};
+
+static const luaL_Reg vector_methods[] = {
+    /// Number of values.
+    // @function Vector:size
+    // @return The size, same as `#vec`
+    { "size", vector_size },
+
+    /// Set all values to zero.
+    // @function Vector:clear
+    { "clear", vector_clear },
+
+    /// Set all values to a number.
+    // @number value Value to set
+    // @function Vector:fill
+    { "fill", vector_fill },
+
+    /// Copy another vector into this one.
+    // @param src Vector to copy
+    // @number[opt=1] gain Gain to apply while copying
+    // @function Vector:copy
+    { "copy", vector_copy },
+
+    /// Add a vector or a number to every value.
+    // @param src Vector or number to add
+    // @number[opt=1] gain Gain applied to a source vector
+    // @function Vector:add
+    { "add", vector_add },
+
+    /// Multiply by a vector or a number.
+    // @param src Vector or number to multiply by
+    // @function Vector:multiply
+    { "multiply", vector_multiply },
+
+    /// Crossfade towards another vector.
+    // Each value becomes `self * (1 - amount) + src * amount`.
+    // @param src Vector to mix in
+    // @number[opt=0.5] amount Amount of the source, 0 to 1
+    // @function Vector:mix
+    { "mix", vector_mix },
+
+    /// Largest absolute value.
+    // @function Vector:peak
+    // @return The peak level
+    { "peak", vector_peak },
+
+    /// Root mean square of the values.
+    // @function Vector:rms
+    // @return The RMS level
+    { "rms", vector_rms },
+
+    /// Copy a channel of an audio buffer into this vector.
+    // @param buffer Buffer to read from
+    // @int[opt=1] channel Channel to read
+    // @function Vector:read
+    { "read", vector_read },
+
+    /// Copy this vector into a channel of an audio buffer.
+    // @param buffer Buffer to write to
+    // @int[opt=1] channel Channel to write
+    // @number[opt=1] gain Gain to apply while copying
+    // @function Vector:write
+    { "write", vector_write },
+    { NULL, NULL }
+};
+
+EL_PLUGIN_EXPORT
+int luaopen_el_Vector (lua_State* L)
+{
+    if (luaL_newmetatable (L, EL_MT_VECTOR))
+    {
+        luaL_setfuncs (L, vector_metamethods, 0);
+        luaL_newlib (L, vector_methods);
+        lua_pushcclosure (L, vector_index, 1);
+        lua_setfield (L, -2, "__index");
+    }
+    lua_pop (L, 1);
+
+    if (luaL_newmetatable (L, EL_MT_VECTOR_TYPE))
+    {
+        lua_pop (L, 1);
+    }
+
+    lua_newtable (L);
+    luaL_setmetatable (L, EL_MT_VECTOR_TYPE);
+    lua_pushcfunction (L, vector_new);
+    lua_setfield (L, -2, "new");
+    return 1;
+}
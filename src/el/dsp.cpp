@@ -0,0 +1,531 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+/// Native DSP building blocks.
+// Every processor works on whole blocks: pass an `el.Vector`, or an
+// `el.AudioBuffer` and a channel (default 1), and it is processed in place.
+// Processors hold state for one channel, so create one per channel.
+// Constructors allocate, `process` and the setters never do.
+// @module el.dsp
+// @usage
+// local dsp = require ('el.dsp')
+// local lp = dsp.biquad()
+// lp:lowpass (44100, 1000, 0.707)
+// lp:process (audio, 1)
+
+#include <cmath>
+#include <cstring>
+
+#include "vector.hpp"
+
+#define EL_MT_BIQUAD     "el.Biquad"
+#define EL_MT_ONE_POLE   "el.OnePole"
+#define EL_MT_DELAY_LINE "el.DelayLine"
+#define EL_MT_FIR        "el.FIR"
+
+namespace lua = element::lua;
+
+namespace {
+
+struct Biquad
+{
+    double b0, b1, b2, a1, a2;
+    double z1, z2;
+
+    void set (const juce::IIRCoefficients& c) noexcept
+    {
+        b0 = c.coefficients[0];
+        b1 = c.coefficients[1];
+        b2 = c.coefficients[2];
+        a1 = c.coefficients[3];
+        a2 = c.coefficients[4];
+    }
+
+    template <typename T>
+    void process (T* data, int n) noexcept
+    {
+        auto s1 = z1, s2 = z2;
+        for (int i = 0; i < n; ++i)
+        {
+            const double x = data[i];
+            const double y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            data[i] = static_cast<T> (y);
+        }
+        z1 = s1;
+        z2 = s2;
+    }
+};
+
+struct OnePole
+{
+    double coeff, z;
+    bool highpass;
+
+    template <typename T>
+    void process (T* data, int n) noexcept
+    {
+        auto s = z;
+        for (int i = 0; i < n; ++i)
+        {
+            const double x = data[i];
+            s += coeff * (x - s);
+            data[i] = static_cast<T> (highpass ? x - s : s);
+        }
+        z = s;
+    }
+};
+
+struct DelayLine
+{
+    float* line;
+    int size, write;
+    double delay, feedback, mix;
+
+    template <typename T>
+    void process (T* data, int n) noexcept
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            double pos = write - delay;
+            if (pos < 0.0)
+                pos += size;
+            const int i0 = (int) pos;
+            const int i1 = i0 + 1 == size ? 0 : i0 + 1;
+            const double frac = pos - i0;
+            const double y = line[i0] + frac * (line[i1] - line[i0]);
+
+            const double x = data[i];
+            line[write] = static_cast<float> (x + y * feedback);
+            if (++write == size)
+                write = 0;
+
+            data[i] = static_cast<T> (x + mix * (y - x));
+        }
+    }
+};
+
+struct FIR
+{
+    float* taps;
+    float* history; // twice the size so the newest samples are contiguous
+    int size, pos;
+
+    template <typename T>
+    void process (T* data, int n) noexcept
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            pos = pos == 0 ? size - 1 : pos - 1;
+            history[pos] = history[pos + size] = static_cast<float> (data[i]);
+
+            const float* h = history + pos;
+            float y = 0.f;
+            for (int k = 0; k < size; ++k)
+                y += taps[k] * h[k];
+            data[i] = static_cast<T> (y);
+        }
+    }
+};
+
+/** Userdata with a trailing, aligned float array. */
+template <class Obj>
+static Obj* new_object (lua_State* L, const char* mt, int numFloats, float*& floats)
+{
+    constexpr size_t alignment = 16;
+    auto* obj = (Obj*) lua_newuserdatauv (L, sizeof (Obj) + sizeof (float) * (size_t) numFloats + alignment, 0);
+    std::memset (obj, 0, sizeof (Obj));
+    auto addr = reinterpret_cast<uintptr_t> (obj + 1);
+    floats = reinterpret_cast<float*> ((addr + alignment - 1) & ~(uintptr_t) (alignment - 1));
+    juce::FloatVectorOperations::clear (floats, numFloats);
+    luaL_setmetatable (L, mt);
+    return obj;
+}
+
+template <class Obj>
+static int process_block (lua_State* L, const char* mt)
+{
+    auto* self = (Obj*) luaL_checkudata (L, 1, mt);
+    lua::SampleBlock block;
+    lua::check_block (L, 2, block);
+    if (block.f32 != nullptr)
+        self->process (block.f32, block.size);
+    else
+        self->process (block.f64, block.size);
+    return 0;
+}
+
+/** Checked `rate, freq` arguments starting at index. */
+static void check_rate_freq (lua_State* L, int index, double& rate, double& freq)
+{
+    rate = luaL_checknumber (L, index);
+    freq = luaL_checknumber (L, index + 1);
+    luaL_argcheck (L, rate > 0.0, index, "sample rate must be positive");
+    luaL_argcheck (L, freq > 0.0 && freq < rate * 0.5, index + 1, "frequency out of range");
+}
+
+} // namespace
+
+//==============================================================================
+static Biquad* biquad_check (lua_State* L) { return (Biquad*) luaL_checkudata (L, 1, EL_MT_BIQUAD); }
+
+static int biquad_design (lua_State* L, juce::IIRCoefficients (*make) (double, double, double))
+{
+    auto* self = biquad_check (L);
+    double rate, freq;
+    check_rate_freq (L, 2, rate, freq);
+    self->set (make (rate, freq, luaL_optnumber (L, 4, 1.0 / juce::MathConstants<double>::sqrt2)));
+    return 0;
+}
+
+static int biquad_design_gain (lua_State* L, juce::IIRCoefficients (*make) (double, double, double, float))
+{
+    auto* self = biquad_check (L);
+    double rate, freq;
+    check_rate_freq (L, 2, rate, freq);
+    self->set (make (rate, freq, luaL_checknumber (L, 4), (float) luaL_checknumber (L, 5)));
+    return 0;
+}
+
+static int biquad_lowpass (lua_State* L) { return biquad_design (L, juce::IIRCoefficients::makeLowPass); }
+static int biquad_highpass (lua_State* L) { return biquad_design (L, juce::IIRCoefficients::makeHighPass); }
+static int biquad_bandpass (lua_State* L) { return biquad_design (L, juce::IIRCoefficients::makeBandPass); }
+static int biquad_notch (lua_State* L) { return biquad_design (L, juce::IIRCoefficients::makeNotchFilter); }
+static int biquad_peak (lua_State* L) { return biquad_design_gain (L, juce::IIRCoefficients::makePeakFilter); }
+static int biquad_lowshelf (lua_State* L) { return biquad_design_gain (L, juce::IIRCoefficients::makeLowShelf); }
+static int biquad_highshelf (lua_State* L) { return biquad_design_gain (L, juce::IIRCoefficients::makeHighShelf); }
+
+static int biquad_set (lua_State* L)
+{
+    auto* self = biquad_check (L);
+    self->b0 = luaL_checknumber (L, 2);
+    self->b1 = luaL_checknumber (L, 3);
+    self->b2 = luaL_checknumber (L, 4);
+    self->a1 = luaL_checknumber (L, 5);
+    self->a2 = luaL_checknumber (L, 6);
+    return 0;
+}
+
+static int biquad_reset (lua_State* L)
+{
+    auto* self = biquad_check (L);
+    self->z1 = self->z2 = 0.0;
+    return 0;
+}
+
+static int biquad_process (lua_State* L) { return process_block<Biquad> (L, EL_MT_BIQUAD); }
+
+static const luaL_Reg biquad_methods[] = {
+    /// Biquad filter.
+    // Starts as a pass-through. Frequencies are in Hz, `q` defaults to 0.707
+    // and `gain` is a linear factor (see `el.audio.togain`).
+    // @type Biquad
+
+    /// Design a low-pass filter.
+    // @function Biquad:lowpass
+    // @number rate Sample rate
+    // @number freq Cutoff frequency
+    // @number[opt] q Resonance
+    { "lowpass", biquad_lowpass },
+    /// Design a high-pass filter.
+    // @function Biquad:highpass
+    // @number rate Sample rate
+    // @number freq Cutoff frequency
+    // @number[opt] q Resonance
+    { "highpass", biquad_highpass },
+    /// Design a band-pass filter.
+    // @function Biquad:bandpass
+    // @number rate Sample rate
+    // @number freq Centre frequency
+    // @number[opt] q Bandwidth
+    { "bandpass", biquad_bandpass },
+    /// Design a notch filter.
+    // @function Biquad:notch
+    // @number rate Sample rate
+    // @number freq Centre frequency
+    // @number[opt] q Bandwidth
+    { "notch", biquad_notch },
+    /// Design a peak filter.
+    // @function Biquad:peak
+    // @number rate Sample rate
+    // @number freq Centre frequency
+    // @number q Bandwidth
+    // @number gain Gain at the centre
+    { "peak", biquad_peak },
+    /// Design a low shelf.
+    // @function Biquad:lowshelf
+    // @number rate Sample rate
+    // @number freq Shelf frequency
+    // @number q Slope
+    // @number gain Shelf gain
+    { "lowshelf", biquad_lowshelf },
+    /// Design a high shelf.
+    // @function Biquad:highshelf
+    // @number rate Sample rate
+    // @number freq Shelf frequency
+    // @number q Slope
+    // @number gain Shelf gain
+    { "highshelf", biquad_highshelf },
+    /// Set normalized coefficients directly.
+    // @function Biquad:set
+    // @number b0
+    // @number b1
+    // @number b2
+    // @number a1
+    // @number a2
+    { "set", biquad_set },
+    /// Clear the filter state.
+    // @function Biquad:reset
+    { "reset", biquad_reset },
+    /// Filter a block in place.
+    // @function Biquad:process
+    // @param target Vector or AudioBuffer
+    // @int[opt=1] channel Buffer channel
+    { "process", biquad_process },
+    { NULL, NULL }
+};
+
+//==============================================================================
+static OnePole* onepole_check (lua_State* L) { return (OnePole*) luaL_checkudata (L, 1, EL_MT_ONE_POLE); }
+
+static int onepole_design (lua_State* L, bool highpass)
+{
+    auto* self = onepole_check (L);
+    double rate, freq;
+    check_rate_freq (L, 2, rate, freq);
+    self->coeff = 1.0 - std::exp (-juce::MathConstants<double>::twoPi * freq / rate);
+    self->highpass = highpass;
+    return 0;
+}
+
+static int onepole_lowpass (lua_State* L) { return onepole_design (L, false); }
+static int onepole_highpass (lua_State* L) { return onepole_design (L, true); }
+
+static int onepole_reset (lua_State* L)
+{
+    onepole_check (L)->z = 0.0;
+    return 0;
+}
+
+static int onepole_process (lua_State* L) { return process_block<OnePole> (L, EL_MT_ONE_POLE); }
+
+static const luaL_Reg onepole_methods[] = {
+    /// One-pole filter, 6dB per octave.
+    // @type OnePole
+
+    /// Make this a low-pass.
+    // @function OnePole:lowpass
+    // @number rate Sample rate
+    // @number freq Cutoff frequency
+    { "lowpass", onepole_lowpass },
+    /// Make this a high-pass.
+    // @function OnePole:highpass
+    // @number rate Sample rate
+    // @number freq Cutoff frequency
+    { "highpass", onepole_highpass },
+    /// Clear the filter state.
+    // @function OnePole:reset
+    { "reset", onepole_reset },
+    /// Filter a block in place.
+    // @function OnePole:process
+    // @param target Vector or AudioBuffer
+    // @int[opt=1] channel Buffer channel
+    { "process", onepole_process },
+    { NULL, NULL }
+};
+
+//==============================================================================
+static DelayLine* delay_check (lua_State* L) { return (DelayLine*) luaL_checkudata (L, 1, EL_MT_DELAY_LINE); }
+
+static int delay_set (lua_State* L)
+{
+    auto* self = delay_check (L);
+    self->delay = juce::jlimit (1.0, (double) (self->size - 1), luaL_checknumber (L, 2));
+    self->feedback = juce::jlimit (-1.0, 1.0, luaL_optnumber (L, 3, self->feedback));
+    self->mix = juce::jlimit (0.0, 1.0, luaL_optnumber (L, 4, self->mix));
+    return 0;
+}
+
+static int delay_reset (lua_State* L)
+{
+    auto* self = delay_check (L);
+    juce::FloatVectorOperations::clear (self->line, self->size);
+    self->write = 0;
+    return 0;
+}
+
+static int delay_process (lua_State* L) { return process_block<DelayLine> (L, EL_MT_DELAY_LINE); }
+
+static const luaL_Reg delay_methods[] = {
+    /// Delay line with feedback and fractional delay times.
+    // @type DelayLine
+
+    /// Set delay parameters.
+    // @function DelayLine:set
+    // @number samples Delay time in samples, fractions are interpolated
+    // @number[opt] feedback Amount fed back, -1 to 1 (initially 0)
+    // @number[opt] mix Wet amount, 0 to 1 (initially 1)
+    { "set", delay_set },
+    /// Clear the delay memory.
+    // @function DelayLine:reset
+    { "reset", delay_reset },
+    /// Delay a block in place.
+    // @function DelayLine:process
+    // @param target Vector or AudioBuffer
+    // @int[opt=1] channel Buffer channel
+    { "process", delay_process },
+    { NULL, NULL }
+};
+
+//==============================================================================
+static FIR* fir_check (lua_State* L) { return (FIR*) luaL_checkudata (L, 1, EL_MT_FIR); }
+
+static int fir_reset (lua_State* L)
+{
+    auto* self = fir_check (L);
+    juce::FloatVectorOperations::clear (self->history, self->size * 2);
+    self->pos = 0;
+    return 0;
+}
+
+static int fir_size (lua_State* L)
+{
+    lua_pushinteger (L, fir_check (L)->size);
+    return 1;
+}
+
+static int fir_process (lua_State* L) { return process_block<FIR> (L, EL_MT_FIR); }
+
+static const luaL_Reg fir_methods[] = {
+    /// FIR filter.
+    // @type FIR
+
+    /// Number of taps.
+    // @function FIR:size
+    { "size", fir_size },
+    /// Clear the filter history.
+    // @function FIR:reset
+    { "reset", fir_reset },
+    /// Filter a block in place.
+    // @function FIR:process
+    // @param target Vector or AudioBuffer
+    // @int[opt=1] channel Buffer channel
+    { "process", fir_process },
+    { NULL, NULL }
+};
+
+//==============================================================================
+/// Create a biquad filter. It passes audio through until designed.
+// @function biquad
+// @treturn Biquad A new filter
+static int f_biquad (lua_State* L)
+{
+    float* unused = nullptr;
+    auto* self = new_object<Biquad> (L, EL_MT_BIQUAD, 0, unused);
+    self->b0 = 1.0;
+    return 1;
+}
+
+/// Create a one-pole low-pass filter.
+// @function onepole
+// @number[opt] rate Sample rate
+// @number[opt] freq Cutoff frequency
+// @treturn OnePole A new filter
+static int f_onepole (lua_State* L)
+{
+    const bool design = lua_gettop (L) >= 2;
+    float* unused = nullptr;
+    new_object<OnePole> (L, EL_MT_ONE_POLE, 0, unused)->coeff = 1.0;
+    if (design)
+    {
+        lua_insert (L, 1);
+        onepole_lowpass (L);
+        lua_settop (L, 1);
+    }
+    return 1;
+}
+
+/// Create a delay line.
+// @function delay
+// @int maxsamples Longest delay time needed
+// @treturn DelayLine A new delay line
+static int f_delay (lua_State* L)
+{
+    const auto maxSamples = luaL_checkinteger (L, 1);
+    luaL_argcheck (L, maxSamples > 0 && maxSamples < (1 << 24), 1, "delay length out of range");
+
+    const int size = (int) maxSamples + 1;
+    float* line = nullptr;
+    auto* self = new_object<DelayLine> (L, EL_MT_DELAY_LINE, size, line);
+    self->line = line;
+    self->size = size;
+    self->delay = (double) maxSamples;
+    self->mix = 1.0;
+    return 1;
+}
+
+/// Create an FIR filter.
+// @function fir
+// @param taps Coefficients, a table of numbers or a Vector
+// @treturn FIR A new filter
+static int f_fir (lua_State* L)
+{
+    auto* vec = lua::test_vector (L, 1);
+    if (vec == nullptr)
+        luaL_checktype (L, 1, LUA_TTABLE);
+
+    const auto size = vec != nullptr ? (lua_Integer) vec->size : luaL_len (L, 1);
+    luaL_argcheck (L, size > 0 && size <= (1 << 16), 1, "tap count out of range");
+
+    float* floats = nullptr;
+    auto* self = new_object<FIR> (L, EL_MT_FIR, (int) size * 3, floats);
+    self->size = (int) size;
+    self->taps = floats;
+    self->history = floats + size;
+
+    for (int i = 0; i < self->size; ++i)
+    {
+        if (vec != nullptr)
+        {
+            self->taps[i] = vec->values[i];
+            continue;
+        }
+
+        lua_geti (L, 1, i + 1);
+        self->taps[i] = static_cast<float> (lua_tonumber (L, -1));
+        lua_pop (L, 1);
+    }
+
+    return 1;
+}
+
+static const luaL_Reg dsp_f[] = {
+    { "biquad", f_biquad },
+    { "onepole", f_onepole },
+    { "delay", f_delay },
+    { "fir", f_fir },
+    { NULL, NULL }
+};
+
+static void dsp_metatable (lua_State* L, const char* name, const luaL_Reg* methods)
+{
+    if (luaL_newmetatable (L, name))
+    {
+        lua_pushvalue (L, -1);
+        lua_setfield (L, -2, "__index");
+        luaL_setfuncs (L, methods, 0);
+    }
+    lua_pop (L, 1);
+}
+
+EL_PLUGIN_EXPORT
+int luaopen_el_dsp (lua_State* L)
+{
+    dsp_metatable (L, EL_MT_BIQUAD, biquad_methods);
+    dsp_metatable (L, EL_MT_ONE_POLE, onepole_methods);
+    dsp_metatable (L, EL_MT_DELAY_LINE, delay_methods);
+    dsp_metatable (L, EL_MT_FIR, fir_methods);
+    luaL_newlib (L, dsp_f);
+    return 1;
+}
@@ -19,6 +19,15 @@ struct MidiBufferImpl final
     /** Cached message used by iterator */
     juce::MidiMessage** message { nullptr };
     int msgref { LUA_REFNIL };
+    /** Output of filter(), swapped with the buffer so neither allocates */
+    juce::MidiBuffer scratch;
+    /** Iterator closures, created once and reused */
+    int rawref { LUA_REFNIL },
+        eventsref { LUA_REFNIL },
+        messagesref { LUA_REFNIL };
+
+    /** Bytes reserved for events when a buffer is created */
+    static constexpr int defaultCapacity = 2048;
 
     MidiBufferImpl (lua_State* L)
     {
@@ -26,16 +35,21 @@ struct MidiBufferImpl final
         *message = new juce::MidiMessage();
         luaL_setmetatable (L, EL_MT_MIDI_MESSAGE);
         msgref = luaL_ref (L, LUA_REGISTRYINDEX);
+        buffer.ensureSize (defaultCapacity);
+        scratch.ensureSize (defaultCapacity);
     }
     ~MidiBufferImpl() = default;
 
     void free (lua_State* L)
     {
         // garbage collector will free the data
-        if (msgref != LUA_REFNIL)
+        for (auto* ref : { &msgref, &rawref, &eventsref, &messagesref })
         {
-            msgref = LUA_REFNIL;
-            luaL_unref (L, LUA_REGISTRYINDEX, msgref);
+            if (*ref != LUA_REFNIL)
+            {
+                luaL_unref (L, LUA_REGISTRYINDEX, *ref);
+                *ref = LUA_REFNIL;
+            }
         }
 
         if (message != nullptr)
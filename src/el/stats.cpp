@@ -0,0 +1,166 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+/// Engine statistics.
+// Read the audio engine's realtime counters: callback load, overruns, xruns,
+// block sizes, MIDI queue depths and per-node render time.  The counters
+// are updated lock-free on the audio thread, so polling them from a timer
+// or an OSC exporter doesn't disturb rendering.
+// Loads are the share of a block's duration spent rendering: 1.0 means
+// rendering took as long as the block lasts.
+// @module el.stats
+// @usage
+// local stats = require ('el.stats')
+// local s = stats.snapshot()
+// print (s.cpuLoad, s.overruns)
+
+#include <element/audioengine.hpp>
+#include <element/context.hpp>
+#include <element/element.h>
+
+#include "engine/graphnode.hpp"
+#include "engine/rootgraph.hpp"
+#include "sol_helpers.hpp"
+
+using namespace element;
+
+static AudioEngine* stats_engine (lua_State* L)
+{
+    sol::state_view view (L);
+    auto ctx = view.globals().get<sol::optional<Context&>> ("el.context");
+    return ctx ? ctx->audio().get() : nullptr;
+}
+
+static AudioEngine* stats_check_engine (lua_State* L)
+{
+    auto* engine = stats_engine (L);
+    if (engine == nullptr)
+        luaL_error (L, "el.stats: audio engine not available");
+    return engine;
+}
+
+/** Push the table at index or a new one when it isn't a table. */
+static void stats_push_table (lua_State* L, int index, int nrec)
+{
+    if (lua_istable (L, index))
+        lua_pushvalue (L, index);
+    else
+        lua_createtable (L, 0, nrec);
+}
+
+static void stats_set (lua_State* L, const char* key, lua_Number value)
+{
+    lua_pushnumber (L, value);
+    lua_setfield (L, -2, key);
+}
+
+static void stats_set (lua_State* L, const char* key, lua_Integer value)
+{
+    lua_pushinteger (L, value);
+    lua_setfield (L, -2, key);
+}
+
+/// Returns the engine's current statistics.
+// Fields: `sampleRate`, `bufferSize`, `lastBlockSize`, `callbacks`,
+// `cpuLoad`, `peakCpuLoad`, `overruns`, `deviceXRuns` (-1 if unknown),
+// `midiInputEvents`, `peakMidiInputEvents`, `midiOutputEvents`,
+// `peakMidiOutputEvents` and `latencySamples`.
+// @function snapshot
+// @tparam[opt] table t Table to fill instead of creating a new one
+// @treturn table The statistics
+static int f_snapshot (lua_State* L)
+{
+    const auto s = stats_check_engine (L)->getStatistics();
+    stats_push_table (L, 1, 13);
+    stats_set (L, "sampleRate", (lua_Number) s.sampleRate);
+    stats_set (L, "bufferSize", (lua_Integer) s.bufferSize);
+    stats_set (L, "lastBlockSize", (lua_Integer) s.lastBlockSize);
+    stats_set (L, "callbacks", (lua_Integer) s.callbacks);
+    stats_set (L, "cpuLoad", (lua_Number) s.cpuLoad);
+    stats_set (L, "peakCpuLoad", (lua_Number) s.peakCpuLoad);
+    stats_set (L, "overruns", (lua_Integer) s.overruns);
+    stats_set (L, "deviceXRuns", (lua_Integer) s.deviceXRuns);
+    stats_set (L, "midiInputEvents", (lua_Integer) s.midiInputEvents);
+    stats_set (L, "peakMidiInputEvents", (lua_Integer) s.peakMidiInputEvents);
+    stats_set (L, "midiOutputEvents", (lua_Integer) s.midiOutputEvents);
+    stats_set (L, "peakMidiOutputEvents", (lua_Integer) s.peakMidiOutputEvents);
+    stats_set (L, "latencySamples", (lua_Integer) s.latencySamples);
+    return 1;
+}
+
+/// Returns render time for each node in the active graph.
+// Each entry has `id`, `name`, `cpuLoad` and `peakCpuLoad`.
+// @function nodes
+// @tparam[opt] table t Table to fill instead of creating a new one
+// @treturn table Array of node entries
+static int f_nodes (lua_State* L)
+{
+    auto* engine = stats_check_engine (L);
+    auto* graph = engine->getGraph (engine->getActiveGraph());
+    stats_push_table (L, 1, 0);
+    const int numNodes = graph != nullptr ? graph->getNumNodes() : 0;
+
+    for (int i = 0; i < numNodes; ++i)
+    {
+        auto* node = graph->getNode (i);
+        if (lua_geti (L, -1, i + 1) != LUA_TTABLE)
+        {
+            lua_pop (L, 1);
+            lua_createtable (L, 0, 4);
+            lua_pushvalue (L, -1);
+            lua_seti (L, -3, i + 1);
+        }
+
+        stats_set (L, "id", (lua_Integer) node->nodeId);
+        lua_pushstring (L, node->getName().toRawUTF8());
+        lua_setfield (L, -2, "name");
+        stats_set (L, "cpuLoad", (lua_Number) node->getCpuLoad());
+        stats_set (L, "peakCpuLoad", (lua_Number) node->getPeakCpuLoad());
+        lua_pop (L, 1);
+    }
+
+    // trim entries left over from a larger graph
+    for (auto n = (lua_Integer) luaL_len (L, -1); n > numNodes; --n)
+    {
+        lua_pushnil (L);
+        lua_seti (L, -2, n);
+    }
+
+    return 1;
+}
+
+/// Reset callback counts and peaks, including each node's peak load.
+// @function reset
+static int f_reset (lua_State* L)
+{
+    auto* engine = stats_check_engine (L);
+    engine->resetStatistics();
+    if (auto* graph = engine->getGraph (engine->getActiveGraph()))
+        for (int i = graph->getNumNodes(); --i >= 0;)
+            graph->getNode (i)->resetPeakCpuLoad();
+    return 0;
+}
+
+/// Returns true if an audio engine is available to query.
+// @function available
+// @treturn bool
+static int f_available (lua_State* L)
+{
+    lua_pushboolean (L, stats_engine (L) != nullptr);
+    return 1;
+}
+
+static const luaL_Reg stats_f[] = {
+    { "available", f_available },
+    { "snapshot", f_snapshot },
+    { "nodes", f_nodes },
+    { "reset", f_reset },
+    { NULL, NULL }
+};
+
+EL_PLUGIN_EXPORT
+int luaopen_el_stats (lua_State* L)
+{
+    luaL_newlib (L, stats_f);
+    return 1;
+}
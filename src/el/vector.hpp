@@ -0,0 +1,92 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <element/element.h>
+#include <element/juce/audio_basics.hpp>
+
+#include "sol_helpers.hpp"
+
+namespace element {
+namespace lua {
+
+/** A fixed size block of 32bit samples.  The values live in the same Lua
+    userdata as this header, so creating one goes through the state's
+    allocator and there's nothing else to free.
+ */
+struct Vector final
+{
+    float* values;
+    int size;
+};
+
+/** Create a vector and push it on the stack. Values are zeroed. */
+inline static Vector* new_vector (lua_State* L, int size)
+{
+    constexpr size_t alignment = 16;
+    size = juce::jmax (0, size);
+    auto* vec = (Vector*) lua_newuserdatauv (L, sizeof (Vector) + sizeof (float) * (size_t) size + alignment, 0);
+    auto addr = reinterpret_cast<uintptr_t> (vec + 1);
+    vec->values = reinterpret_cast<float*> ((addr + alignment - 1) & ~(uintptr_t) (alignment - 1));
+    vec->size = size;
+    juce::FloatVectorOperations::clear (vec->values, size);
+    luaL_setmetatable (L, EL_MT_VECTOR);
+    return vec;
+}
+
+/** Returns the vector at a stack index or nullptr. */
+inline static Vector* test_vector (lua_State* L, int index)
+{
+    return (Vector*) luaL_testudata (L, index, EL_MT_VECTOR);
+}
+
+/** Samples a bulk operation works on: a vector, or one channel of an
+    AudioBuffer.  Exactly one of f32 and f64 is set.
+ */
+struct SampleBlock final
+{
+    float* f32 { nullptr };
+    double* f64 { nullptr };
+    int size { 0 };
+};
+
+/** Read a `vector` or `buffer [, channel]` argument starting at index.
+    The channel defaults to 1.  Raises a Lua error on bad arguments and
+    returns the index of the next argument.
+ */
+inline static int check_block (lua_State* L, int index, SampleBlock& block)
+{
+    if (auto* vec = test_vector (L, index))
+    {
+        block.f32 = vec->values;
+        block.size = vec->size;
+        return index + 1;
+    }
+
+    const bool single = luaL_testudata (L, index, EL_MT_AUDIO_BUFFER_32) != nullptr;
+    if (! single && luaL_testudata (L, index, EL_MT_AUDIO_BUFFER_64) == nullptr)
+        luaL_typeerror (L, index, "el.Vector or el.AudioBuffer");
+
+    const int next = lua_isinteger (L, index + 1) ? index + 2 : index + 1;
+    const int channel = next > index + 1 ? (int) lua_tointeger (L, index + 1) - 1 : 0;
+    if (single)
+    {
+        auto* buf = *(juce::AudioBuffer<float>**) lua_touserdata (L, index);
+        luaL_argcheck (L, channel >= 0 && channel < buf->getNumChannels(), index + 1, "channel out of range");
+        block.f32 = buf->getWritePointer (channel);
+        block.size = buf->getNumSamples();
+    }
+    else
+    {
+        auto* buf = *(juce::AudioBuffer<double>**) lua_touserdata (L, index);
+        luaL_argcheck (L, channel >= 0 && channel < buf->getNumChannels(), index + 1, "channel out of range");
+        block.f64 = buf->getWritePointer (channel);
+        block.size = buf->getNumSamples();
+    }
+
+    return next;
+}
+
+} // namespace lua
+} // namespace element
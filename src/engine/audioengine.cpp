@@ -4,8 +4,10 @@
 #include <element/audioengine.hpp>
 #include <element/transport.hpp>
 #include <element/context.hpp>
+#include <element/devices.hpp>
 #include <element/settings.hpp>
 
+#include "engine/diskstreaming.hpp"
 #include "engine/internalformat.hpp"
 #include "engine/midiclock.hpp"
 #include "engine/midichannelmap.hpp"
@@ -113,6 +115,11 @@ struct RootGraphRender : public AsyncUpdater
 
             for (auto* const graph : graphs)
             {
+                // standby graphs are prepared but silent until activated,
+                // a retiring graph still renders while it fades out.
+                if (graph->isStandby() && graph != current && graph != last)
+                    continue;
+
                 // copy inputs, clear outs if more than input count
                 for (int i = 0; i < numInputChans; ++i)
                     audioTemp.copyFrom (i, 0, buffer, i, 0, numSamples);
@@ -236,9 +243,19 @@ struct RootGraphRender : public AsyncUpdater
     void removeGraph (RootGraph* graph)
     {
         jassert (graphs.contains (graph));
+        auto* const current = getCurrentGraph();
+        auto* const last = isPositiveAndBelow (lastGraph, graphs.size()) ? graphs.getUnchecked (lastGraph) : nullptr;
+
         graphs.removeFirstMatchingValue (graph);
         graph->engineIndex = -1;
         updateIndexes();
+
+        // keep pointing at the same graphs when one before them goes away
+        if (current != nullptr && current != graph)
+            currentGraph = current->engineIndex;
+        if (last != nullptr && last != graph)
+            lastGraph = last->engineIndex;
+
         if (currentGraph >= graphs.size())
             currentGraph = graphs.size() - 1;
         if (lastGraph >= graphs.size())
@@ -287,6 +304,8 @@ private:
             for (int i = 0; i < graphs.size(); ++i)
             {
                 auto* const g = graphs.getUnchecked (i);
+                if (g->isStandby())
+                    continue;
                 if (g->midiProgram == r.program && g->acceptsMidiChannel (program.channel))
                     return g->engineIndex;
             }
@@ -296,6 +315,57 @@ private:
     }
 };
 
+/** Counters behind EngineStatistics.  Only the audio thread writes them,
+    except for reset, which can race with a callback and lose one update.
+ */
+struct StatisticCounters final
+{
+    std::atomic<int64> callbacks { 0 };
+    std::atomic<int> lastBlockSize { 0 };
+    std::atomic<float> cpuLoad { 0.f }, peakCpuLoad { 0.f };
+    std::atomic<int> overruns { 0 };
+    std::atomic<int> midiIn { 0 }, peakMidiIn { 0 };
+    std::atomic<int> midiOut { 0 }, peakMidiOut { 0 };
+
+    void update (double sampleRate, int numSamples, int64 elapsedTicks, int numMidiIn, int numMidiOut) noexcept
+    {
+        static const double ticksPerSecond = (double) Time::getHighResolutionTicksPerSecond();
+
+        callbacks.store (callbacks.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        lastBlockSize.store (numSamples, std::memory_order_relaxed);
+        midiIn.store (numMidiIn, std::memory_order_relaxed);
+        midiOut.store (numMidiOut, std::memory_order_relaxed);
+        raise (peakMidiIn, numMidiIn);
+        raise (peakMidiOut, numMidiOut);
+
+        if (sampleRate <= 0.0 || numSamples <= 0)
+            return;
+
+        const auto load = (float) ((double) elapsedTicks * sampleRate / (ticksPerSecond * numSamples));
+        const auto smoothed = cpuLoad.load (std::memory_order_relaxed);
+        cpuLoad.store (smoothed + 0.1f * (load - smoothed), std::memory_order_relaxed);
+        raise (peakCpuLoad, load);
+        if (load > 1.f)
+            overruns.store (overruns.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void reset() noexcept
+    {
+        callbacks.store (0, std::memory_order_relaxed);
+        peakCpuLoad.store (0.f, std::memory_order_relaxed);
+        overruns.store (0, std::memory_order_relaxed);
+        peakMidiIn.store (0, std::memory_order_relaxed);
+        peakMidiOut.store (0, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void raise (std::atomic<T>& peak, T value) noexcept
+    {
+        if (value > peak.load (std::memory_order_relaxed))
+            peak.store (value, std::memory_order_relaxed);
+    }
+};
+
 class AudioEngine::Private : public AudioIODeviceCallback,
                              public MidiInputCallback,
                              public Value::Listener,
@@ -348,9 +418,21 @@ public:
     void onCurrentGraphChanged()
     {
         int renderingIndex = -1;
+        int sessionIndex = -1;
         {
             ScopedLock sl (lock);
             renderingIndex = graphs.getCurrentGraphIndex();
+
+            // standby graphs belong to preloaded sessions, skip them when
+            // mapping the engine index to the session's graph index.
+            auto* const current = graphs.getCurrentGraph();
+            if (current != nullptr && ! current->isStandby())
+            {
+                sessionIndex = 0;
+                for (int i = 0; i < renderingIndex; ++i)
+                    if (! graphs.getGraph (i)->isStandby())
+                        ++sessionIndex;
+            }
         }
 
         if (renderingIndex != currentGraph.get())
@@ -360,13 +442,13 @@ public:
         }
 
         auto session = engine.context().session();
-        if (currentGraph.get() >= 0 && currentGraph.get() != session->getActiveGraphIndex())
+        if (sessionIndex >= 0 && sessionIndex != session->getActiveGraphIndex())
         {
             // NOTE: this is a cheap way to refresh the GUI, in the future this
             // will need to be smarter by determining whether or not EC needs to
             // handle the change at the model layer.
             auto graphs = session->data().getChildWithName (tags::graphs);
-            graphs.setProperty (tags::active, currentGraph.get(), nullptr);
+            graphs.setProperty (tags::active, sessionIndex, nullptr);
         }
     }
 
@@ -449,6 +531,7 @@ public:
 
     void processCurrentGraph (AudioBuffer<float>& buffer, MidiBuffer& midi)
     {
+        const auto start = Time::getHighResolutionTicks();
         const int numSamples = buffer.getNumSamples();
         messageCollector.removeNextBlockOfMessages (midi, numSamples);
 
@@ -460,6 +543,7 @@ public:
             extraMidi.clear();
         }
 
+        const int numMidiIn = midi.getNumEvents();
         const ScopedLock sl (lock);
         const bool wasPlaying = transport.isPlaying();
         transport.preProcess (numSamples);
@@ -526,6 +610,8 @@ public:
             transport.advance (numSamples);
 
         transport.postProcess (numSamples);
+
+        statistics.update (sampleRate, numSamples, Time::getHighResolutionTicks() - start, numMidiIn, midi.getNumEvents());
     }
 
     bool isTimeMaster() const
@@ -634,6 +720,8 @@ public:
         {
             graph->renderingSequenceChanged.connect (
                 std::bind (&AudioEngine::updateExternalLatencySamples, &engine));
+            graph->latencyChanged.connect (
+                std::bind (&AudioEngine::updateExternalLatencySamples, &engine));
         }
     }
 
@@ -642,9 +730,11 @@ public:
         {
             ScopedLock sl (lock);
             graphs.removeGraph (graph);
+            currentGraph.set (graphs.getCurrentGraphIndex());
         }
 
         graph->renderingSequenceChanged.disconnect_all_slots();
+        graph->latencyChanged.disconnect_all_slots();
         if (isPrepared)
             graph->releaseResources();
     }
@@ -759,9 +849,12 @@ private:
     int latencySamples = 0;
 
     MidiIOMonitorPtr midiIOMonitor;
+    StatisticCounters statistics;
 
     Atomic<double> midiOutLatency { 0.0 };
 
+    SharedResourcePointer<DiskStreamingPool> diskStreaming;
+
     ReferenceCountedArray<AudioEngine::LevelMeter> inMeters, outMeters;
 
     void prepareGraph (RootGraph* graph, double sampleRate, int estimatedBlockSize)
@@ -858,6 +951,9 @@ void AudioEngine::applySettings (Settings& settings)
     }
 
     priv->startStopCont.set (settings.transportRespondToStartStopContinue() ? 1 : 0);
+
+    priv->diskStreaming->setNumThreads (settings.getDiskStreamingThreads());
+    priv->diskStreaming->setDiskLatency (settings.getDiskStreamingLatency());
 }
 
 bool AudioEngine::removeGraph (RootGraph* graph)
@@ -1028,6 +1124,38 @@ int AudioEngine::getExternalLatencySamples() const
     return priv != nullptr ? priv->latencySamples : 0;
 }
 
+EngineStatistics AudioEngine::getStatistics() const
+{
+    EngineStatistics stats;
+    if (priv == nullptr)
+        return stats;
+
+    const auto& counters = priv->statistics;
+    stats.sampleRate = priv->isPrepared ? priv->sampleRate : 0.0;
+    stats.bufferSize = priv->isPrepared ? priv->blockSize : 0;
+    stats.lastBlockSize = counters.lastBlockSize.load (std::memory_order_relaxed);
+    stats.callbacks = counters.callbacks.load (std::memory_order_relaxed);
+    stats.cpuLoad = counters.cpuLoad.load (std::memory_order_relaxed);
+    stats.peakCpuLoad = counters.peakCpuLoad.load (std::memory_order_relaxed);
+    stats.overruns = counters.overruns.load (std::memory_order_relaxed);
+    stats.midiInputEvents = counters.midiIn.load (std::memory_order_relaxed);
+    stats.peakMidiInputEvents = counters.peakMidiIn.load (std::memory_order_relaxed);
+    stats.midiOutputEvents = counters.midiOut.load (std::memory_order_relaxed);
+    stats.peakMidiOutputEvents = counters.peakMidiOut.load (std::memory_order_relaxed);
+    stats.latencySamples = priv->latencySamples;
+
+    if (runMode == RunMode::Standalone)
+        stats.deviceXRuns = world.devices().getXRunCount();
+
+    return stats;
+}
+
+void AudioEngine::resetStatistics()
+{
+    if (priv != nullptr)
+        priv->statistics.reset();
+}
+
 MidiIOMonitorPtr AudioEngine::getMidiIOMonitor() const
 {
     return priv != nullptr ? priv->midiIOMonitor : nullptr;
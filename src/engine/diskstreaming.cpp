@@ -0,0 +1,431 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include "engine/diskstreaming.hpp"
+
+namespace element {
+
+//==============================================================================
+DiskStreamingPool::DiskStreamingPool()
+    : numThreads (getDefaultNumThreads()) {}
+
+DiskStreamingPool::~DiskStreamingPool()
+{
+    // streams hold a reference to the pool, they should all be gone by now.
+    jassert (streams.isEmpty());
+    for (auto* thread : threads)
+        thread->stopThread (500);
+    threads.clear();
+}
+
+int DiskStreamingPool::getDefaultNumThreads()
+{
+    return jlimit (1, 4, SystemStats::getNumCpus() / 2);
+}
+
+void DiskStreamingPool::setNumThreads (int newNumThreads)
+{
+    newNumThreads = jlimit (1, 32, newNumThreads);
+    OwnedArray<TimeSliceThread> removed;
+
+    {
+        ScopedLock sl (lock);
+        if (numThreads == newNumThreads)
+            return;
+        numThreads = newNumThreads;
+
+        while (threads.size() > numThreads)
+            removed.add (threads.removeAndReturn (threads.size() - 1));
+
+        for (auto* stream : streams)
+        {
+            if (! removed.contains (stream->thread))
+                continue;
+            stream->thread->removeTimeSliceClient (stream);
+            stream->thread = getLeastBusyThread();
+            stream->thread->addTimeSliceClient (stream);
+        }
+    }
+
+    ++generation;
+
+    for (auto* thread : removed)
+        thread->stopThread (500);
+}
+
+int DiskStreamingPool::getNumThreads() const
+{
+    ScopedLock sl (lock);
+    return numThreads;
+}
+
+void DiskStreamingPool::setDiskLatency (double milliseconds)
+{
+    {
+        ScopedLock sl (lock);
+        diskLatencyMs = jlimit (1.0, 2000.0, milliseconds);
+    }
+    ++generation;
+}
+
+double DiskStreamingPool::getDiskLatency() const
+{
+    ScopedLock sl (lock);
+    return diskLatencyMs;
+}
+
+int DiskStreamingPool::getNumStreams() const
+{
+    ScopedLock sl (lock);
+    return streams.size();
+}
+
+int DiskStreamingPool::getReadAheadSamples (double sampleRate, int blockSize) const
+{
+    ScopedLock sl (lock);
+    return computeReadAhead (sampleRate, blockSize);
+}
+
+bool DiskStreamingPool::tryGetReadAheadSamples (double sampleRate, int blockSize, int& samples) const
+{
+    // called from stream threads, which detach() may be waiting on.
+    const ScopedTryLock sl (lock);
+    if (! sl.isLocked())
+        return false;
+    samples = computeReadAhead (sampleRate, blockSize);
+    return true;
+}
+
+int DiskStreamingPool::computeReadAhead (double sampleRate, int blockSize) const
+{
+    // Each thread reads its streams in turn, so a stream may wait for
+    // every other stream on its thread before it gets serviced.
+    const int streamsPerThread = jmax (1, (streams.size() + numThreads - 1) / numThreads);
+    const int latency = roundToInt (diskLatencyMs * 0.001 * sampleRate) * streamsPerThread;
+    return jmax (4096, nextPowerOfTwo (latency + jmax (1, blockSize) * 4));
+}
+
+TimeSliceThread* DiskStreamingPool::getLeastBusyThread()
+{
+    TimeSliceThread* best = nullptr;
+    for (auto* thread : threads)
+        if (best == nullptr || thread->getNumClients() < best->getNumClients())
+            best = thread;
+
+    if (threads.size() < numThreads && (best == nullptr || best->getNumClients() > 0))
+    {
+        auto* thread = threads.add (new TimeSliceThread ("Disk Stream " + String (threads.size() + 1)));
+        thread->startThread (Thread::Priority::high);
+        best = thread;
+    }
+
+    return best;
+}
+
+void DiskStreamingPool::attach (DiskStream& stream)
+{
+    {
+        ScopedLock sl (lock);
+        if (stream.thread != nullptr)
+            return;
+        streams.addIfNotAlreadyThere (&stream);
+        stream.thread = getLeastBusyThread();
+        stream.thread->addTimeSliceClient (&stream);
+    }
+    ++generation;
+}
+
+void DiskStreamingPool::detach (DiskStream& stream)
+{
+    {
+        ScopedLock sl (lock);
+        if (stream.thread != nullptr)
+            stream.thread->removeTimeSliceClient (&stream);
+        stream.thread = nullptr;
+        streams.removeFirstMatchingValue (&stream);
+    }
+    ++generation;
+}
+
+void DiskStreamingPool::wake (DiskStream& stream)
+{
+    // called when seeking, possibly from the audio thread.
+    const ScopedTryLock sl (lock);
+    if (sl.isLocked() && stream.thread != nullptr)
+        stream.thread->moveToFrontOfQueue (&stream);
+}
+
+//==============================================================================
+DiskStream::DiskStream (DiskStreamingPool& p, PositionableAudioSource* s,
+                        bool deleteSourceWhenDeleted, int channels)
+    : pool (p),
+      source (s, deleteSourceWhenDeleted),
+      numChannels (jmax (1, channels))
+{
+    jassert (source != nullptr);
+}
+
+DiskStream::~DiskStream()
+{
+    releaseResources();
+}
+
+void DiskStream::prepareToPlay (int samplesPerBlockExpected, double newSampleRate)
+{
+    const int bufferSize = jmax (samplesPerBlockExpected * 2,
+                                 pool.getReadAheadSamples (newSampleRate, samplesPerBlockExpected));
+
+    if (newSampleRate != sampleRate
+        || samplesPerBlockExpected != blockSize
+        || bufferSize > buffer.getNumSamples()
+        || thread == nullptr)
+    {
+        pool.detach (*this);
+        sampleRate = newSampleRate;
+        blockSize = samplesPerBlockExpected;
+
+        {
+            const ScopedLock sl (readLock);
+            {
+                const SpinLock::ScopedLockType bl (bufferLock);
+                buffer.setSize (numChannels, bufferSize);
+                buffer.clear();
+            }
+            readAheadSamples = bufferSize;
+            source->prepareToPlay (samplesPerBlockExpected, newSampleRate);
+        }
+
+        {
+            const SpinLock::ScopedLockType sl (rangeLock);
+            bufferValidStart = 0;
+            bufferValidEnd = 0;
+        }
+
+        // fill what we can now so playback starts without underruns.
+        for (int i = 0; i < 8 && readNextBufferChunk(); ++i)
+            ;
+
+        pool.attach (*this);
+    }
+}
+
+void DiskStream::releaseResources()
+{
+    pool.detach (*this);
+
+    const ScopedLock sl (readLock);
+    {
+        const SpinLock::ScopedLockType bl (bufferLock);
+        buffer.setSize (numChannels, 0);
+    }
+    readAheadSamples = 0;
+    source->releaseResources();
+}
+
+void DiskStream::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    // the buffer is being resized, play silence rather than wait.
+    const SpinLock::ScopedTryLockType bl (bufferLock);
+    if (! bl.isLocked())
+    {
+        info.clearActiveBufferRegion();
+        nextPlayPos += info.numSamples;
+        return;
+    }
+
+    int64 validStart, validEnd;
+    const auto pos = nextPlayPos.load();
+
+    {
+        const SpinLock::ScopedLockType sl (rangeLock);
+        validStart = jlimit (bufferValidStart.load(), bufferValidEnd.load(), pos) - pos;
+        validEnd = jlimit (bufferValidStart.load(), bufferValidEnd.load(), pos + info.numSamples) - pos;
+    }
+
+    const int bufferSize = buffer.getNumSamples();
+
+    if (validStart == validEnd || bufferSize <= 0)
+    {
+        info.clearActiveBufferRegion();
+    }
+    else
+    {
+        if (validStart > 0)
+            info.buffer->clear (info.startSample, (int) validStart);
+        if (validEnd < info.numSamples)
+            info.buffer->clear (info.startSample + (int) validEnd, info.numSamples - (int) validEnd);
+
+        for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+        {
+            const int srcChan = jmin (chan, buffer.getNumChannels() - 1);
+            const auto startIndex = (int) ((validStart + pos) % bufferSize);
+            const auto endIndex = (int) ((validEnd + pos) % bufferSize);
+
+            if (startIndex < endIndex)
+            {
+                info.buffer->copyFrom (chan, info.startSample + (int) validStart, buffer, srcChan, startIndex, endIndex - startIndex);
+            }
+            else
+            {
+                const int initialSize = bufferSize - startIndex;
+                info.buffer->copyFrom (chan, info.startSample + (int) validStart, buffer, srcChan, startIndex, initialSize);
+                info.buffer->copyFrom (chan, info.startSample + (int) validStart + initialSize, buffer, srcChan, 0, (int) (validEnd - validStart) - initialSize);
+            }
+        }
+    }
+
+    // only count blocks which should have had audio in them.
+    if ((validStart > 0 || validEnd < info.numSamples) && pos >= 0
+        && (isLooping() || pos + info.numSamples <= getTotalLength()))
+        underruns.set (underruns.get() + 1);
+
+    nextPlayPos += info.numSamples;
+}
+
+void DiskStream::setNextReadPosition (int64 newPosition)
+{
+    {
+        const SpinLock::ScopedLockType sl (rangeLock);
+        nextPlayPos = newPosition;
+    }
+
+    pool.wake (*this);
+}
+
+int64 DiskStream::getNextReadPosition() const
+{
+    const auto pos = nextPlayPos.load();
+    return (isLooping() && pos > 0 && getTotalLength() > 0) ? pos % getTotalLength() : pos;
+}
+
+int DiskStream::useTimeSlice()
+{
+    if (readAheadGeneration != pool.generation.load())
+        updateReadAhead();
+
+    if (readNextBufferChunk())
+        return 1;
+
+    // streams with less headroom are visited sooner.
+    const auto headroom = bufferValidEnd.load() - nextPlayPos.load();
+    const auto headroomMs = sampleRate > 0.0 ? (int) (1000.0 * (double) headroom / sampleRate) : 100;
+    return jlimit (1, 100, headroomMs / 4);
+}
+
+bool DiskStream::readNextBufferChunk()
+{
+    const ScopedLock rl (readLock);
+    const int bufferSize = buffer.getNumSamples();
+    if (bufferSize <= 0)
+        return false;
+
+    int64 newBVS, newBVE, sectionToReadStart, sectionToReadEnd;
+
+    {
+        const SpinLock::ScopedLockType sl (rangeLock);
+
+        if (wasSourceLooping != isLooping())
+        {
+            wasSourceLooping = isLooping();
+            bufferValidStart = 0;
+            bufferValidEnd = 0;
+        }
+
+        newBVS = jmax ((int64) 0, nextPlayPos.load());
+        newBVE = newBVS + bufferSize - 4;
+        sectionToReadStart = 0;
+        sectionToReadEnd = 0;
+
+        constexpr int maxChunkSize = 2048;
+
+        if (newBVS < bufferValidStart || newBVS >= bufferValidEnd)
+        {
+            newBVE = jmin (newBVE, newBVS + maxChunkSize);
+            sectionToReadStart = newBVS;
+            sectionToReadEnd = newBVE;
+            bufferValidStart = 0;
+            bufferValidEnd = 0;
+        }
+        else if (std::abs ((int) (newBVS - bufferValidStart)) > 512
+                 || std::abs ((int) (newBVE - bufferValidEnd)) > 512)
+        {
+            newBVE = jmin (newBVE, bufferValidEnd + maxChunkSize);
+            sectionToReadStart = bufferValidEnd;
+            sectionToReadEnd = newBVE;
+            bufferValidStart = newBVS;
+            bufferValidEnd = jmin (bufferValidEnd.load(), newBVE);
+        }
+    }
+
+    if (sectionToReadStart == sectionToReadEnd)
+        return false;
+
+    const auto startIndex = (int) (sectionToReadStart % bufferSize);
+    const auto endIndex = (int) (sectionToReadEnd % bufferSize);
+
+    if (startIndex < endIndex)
+    {
+        readBufferSection (sectionToReadStart, (int) (sectionToReadEnd - sectionToReadStart), startIndex);
+    }
+    else
+    {
+        const int initialSize = bufferSize - startIndex;
+        readBufferSection (sectionToReadStart, initialSize, startIndex);
+        readBufferSection (sectionToReadStart + initialSize, (int) (sectionToReadEnd - sectionToReadStart) - initialSize, 0);
+    }
+
+    {
+        const SpinLock::ScopedLockType sl (rangeLock);
+        bufferValidStart = newBVS;
+        bufferValidEnd = newBVE;
+    }
+
+    return true;
+}
+
+void DiskStream::updateReadAhead()
+{
+    const int generation = pool.generation.load();
+    int wanted = 0;
+    if (! pool.tryGetReadAheadSamples (sampleRate, blockSize, wanted))
+        return; // try again next time slice.
+    readAheadGeneration = generation;
+
+    // buffers only grow, so a stream going away never costs a refill.
+    const ScopedLock rl (readLock);
+    const int oldSize = buffer.getNumSamples();
+    wanted = jmax (blockSize * 2, wanted);
+    if (oldSize <= 0 || wanted <= oldSize)
+        return;
+
+    // move what's been read already to where it lives in the larger buffer.
+    AudioBuffer<float> newBuffer (numChannels, wanted);
+    newBuffer.clear();
+    const auto start = bufferValidStart.load(), end = bufferValidEnd.load();
+    for (auto pos = start; pos < end;)
+    {
+        const auto from = (int) (pos % oldSize), to = (int) (pos % wanted);
+        const auto num = (int) jmin (end - pos, (int64) (oldSize - from), (int64) (wanted - to));
+        for (int c = 0; c < numChannels; ++c)
+            newBuffer.copyFrom (c, to, buffer, c, from, num);
+        pos += num;
+    }
+
+    {
+        const SpinLock::ScopedLockType bl (bufferLock);
+        std::swap (buffer, newBuffer);
+    }
+
+    readAheadSamples = wanted;
+}
+
+void DiskStream::readBufferSection (int64 start, int length, int bufferOffset)
+{
+    if (source->getNextReadPosition() != start)
+        source->setNextReadPosition (start);
+
+    AudioSourceChannelInfo info (&buffer, bufferOffset, length);
+    source->getNextAudioBlock (info);
+}
+
+} // namespace element
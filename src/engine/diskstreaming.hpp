@@ -0,0 +1,126 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include "ElementApp.h"
+
+namespace element {
+
+class DiskStream;
+
+/** A small set of threads shared by every disk stream in the app.
+
+    Streams are spread over the threads, and each thread services the stream
+    closest to running dry first. Use it through a SharedResourcePointer.
+ */
+class DiskStreamingPool
+{
+public:
+    DiskStreamingPool();
+    ~DiskStreamingPool();
+
+    /** Change the number of reading threads. Streams on removed threads are
+        moved to the remaining ones. */
+    void setNumThreads (int newNumThreads);
+    int getNumThreads() const;
+
+    /** Set the worst case time a disk read is expected to take. */
+    void setDiskLatency (double milliseconds);
+    double getDiskLatency() const;
+
+    /** Returns the number of streams attached to the pool. */
+    int getNumStreams() const;
+
+    /** Returns the number of samples a stream should buffer ahead, in the
+        stream's own sample rate and block size. This grows with the number
+        of streams sharing a thread, and streams already playing enlarge
+        their buffers to match when streams are added. */
+    int getReadAheadSamples (double sampleRate, int blockSize) const;
+
+    /** Returns the default number of threads for this machine. */
+    static int getDefaultNumThreads();
+
+private:
+    friend class DiskStream;
+    CriticalSection lock;
+    OwnedArray<TimeSliceThread> threads;
+    Array<DiskStream*> streams;
+    int numThreads = 1;
+    double diskLatencyMs = 50.0;
+    // bumped whenever the read-ahead streams need may have changed.
+    std::atomic<int> generation { 0 };
+
+    void attach (DiskStream&);
+    void detach (DiskStream&);
+    void wake (DiskStream&);
+    TimeSliceThread* getLeastBusyThread();
+    int computeReadAhead (double sampleRate, int blockSize) const;
+    bool tryGetReadAheadSamples (double sampleRate, int blockSize, int& samples) const;
+
+    JUCE_DECLARE_NON_COPYABLE (DiskStreamingPool)
+};
+
+/** Reads a source ahead of playback on a DiskStreamingPool thread.
+
+    Works like juce::BufferingAudioSource, but the audio thread never waits on
+    disk reads and blocks which couldn't be filled in time are counted as
+    underruns.
+ */
+class DiskStream : public PositionableAudioSource,
+                   private TimeSliceClient
+{
+public:
+    DiskStream (DiskStreamingPool& pool, PositionableAudioSource* source,
+                bool deleteSourceWhenDeleted, int numChannels);
+    ~DiskStream() override;
+
+    /** Returns the number of blocks which played before they were read. */
+    int getNumUnderruns() const noexcept { return underruns.get(); }
+
+    /** Reset the underrun counter. */
+    void resetUnderruns() noexcept { underruns.set (0); }
+
+    /** Returns the number of samples being buffered ahead. */
+    int getReadAheadSamples() const noexcept { return readAheadSamples.load(); }
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock (const AudioSourceChannelInfo&) override;
+
+    void setNextReadPosition (int64 newPosition) override;
+    int64 getNextReadPosition() const override;
+    int64 getTotalLength() const override { return source->getTotalLength(); }
+    bool isLooping() const override { return source->isLooping(); }
+    void setLooping (bool shouldLoop) override { source->setLooping (shouldLoop); }
+
+private:
+    friend class DiskStreamingPool;
+    DiskStreamingPool& pool;
+    OptionalScopedPointer<PositionableAudioSource> source;
+    TimeSliceThread* thread = nullptr;
+    const int numChannels;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int readAheadGeneration = -1;
+
+    AudioBuffer<float> buffer;
+    // held while the buffer is resized, the audio thread only tries it.
+    SpinLock bufferLock;
+    SpinLock rangeLock;
+    CriticalSection readLock;
+    std::atomic<int64> bufferValidStart { 0 }, bufferValidEnd { 0 }, nextPlayPos { 0 };
+    bool wasSourceLooping = false;
+    Atomic<int> underruns { 0 };
+    std::atomic<int> readAheadSamples { 0 };
+
+    int useTimeSlice() override;
+    bool readNextBufferChunk();
+    void updateReadAhead();
+    void readBufferSection (int64 start, int length, int bufferOffset);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DiskStream)
+};
+
+} // namespace element
@@ -327,42 +327,178 @@ private:
     JUCE_DECLARE_NON_COPYABLE (AddMidiBufferOp)
 };
 
-class DelayChannelOp : public GraphOp
+/** Returns true if a connection between these types can be delay compensated. */
+static bool canCompensate (const PortType src, const PortType dst) noexcept
+{
+    if (dst.isAudio() || dst.isCv())
+        return src.isAudio() || src.isCv();
+    return dst.isMidi() && src.isMidi();
+}
+
+static int delayCapacityFor (const int numSamplesDelay) noexcept
+{
+    // leave headroom so plugins changing latency at runtime can usually be
+    // compensated without rebuilding the rendering sequence.
+    return nextPowerOfTwo (jmax (1024, numSamplesDelay * 2));
+}
+
+class DelayChannelOp : public LatencyCompensationOp
 {
 public:
-    DelayChannelOp (const int channel_, const int numSamplesDelay_)
+    DelayChannelOp (const int channel_, const int numSamplesDelay_, const int maxBlockSize_)
         : channel (channel_),
-          bufferSize (numSamplesDelay_ + 1),
-          readIndex (0),
-          writeIndex (numSamplesDelay_)
+          maxDelay (delayCapacityFor (numSamplesDelay_)),
+          blockSize (jmax (1, maxBlockSize_)),
+          bufferSize (maxDelay + blockSize),
+          delay (numSamplesDelay_)
     {
         buffer.calloc ((size_t) bufferSize);
     }
 
-    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray<MidiBuffer>&, const SharedAtom&, const int numSamples)
+    std::string traceStep() const noexcept override
     {
+        String str;
+        str << "DelayChannelOp: channel " << channel << " by " << delay.load() << " samples";
+        return str.toStdString();
+    }
+
+    int getMaxDelaySamples() const noexcept override { return maxDelay; }
+    void setDelaySamples (int newDelay) noexcept override { delay.store (jlimit (0, maxDelay, newDelay)); }
+
+    void perform (AudioSampleBuffer& sharedBufferChans, const OwnedArray<MidiBuffer>&, const SharedAtom&, const int numSamples) override
+    {
+        const int currentDelay = delay.load (std::memory_order_relaxed);
         float* data = sharedBufferChans.getWritePointer (channel, 0);
 
-        for (int i = numSamples; --i >= 0;)
+        for (int done = 0; done < numSamples;)
         {
-            buffer[writeIndex] = *data;
-            *data++ = buffer[readIndex];
-
-            if (++readIndex >= bufferSize)
-                readIndex = 0;
-            if (++writeIndex >= bufferSize)
-                writeIndex = 0;
+            const int count = jmin (blockSize, numSamples - done);
+            write (data + done, count);
+            read (data + done, count, currentDelay);
+            writeIndex = (writeIndex + count) % bufferSize;
+            done += count;
         }
     }
 
 private:
     HeapBlock<float> buffer;
-    const int channel, bufferSize;
-    int readIndex, writeIndex;
+    const int channel, maxDelay, blockSize, bufferSize;
+    std::atomic<int> delay;
+    int writeIndex = 0;
+
+    void write (const float* src, const int count) noexcept
+    {
+        const int first = jmin (count, bufferSize - writeIndex);
+        FloatVectorOperations::copy (buffer + writeIndex, src, first);
+        if (first < count)
+            FloatVectorOperations::copy (buffer.get(), src + first, count - first);
+    }
+
+    void read (float* dst, const int count, const int delaySamples) noexcept
+    {
+        int readIndex = writeIndex - delaySamples;
+        if (readIndex < 0)
+            readIndex += bufferSize;
+
+        const int first = jmin (count, bufferSize - readIndex);
+        FloatVectorOperations::copy (dst, buffer + readIndex, first);
+        if (first < count)
+            FloatVectorOperations::copy (dst + first, buffer.get(), count - first);
+    }
 
     JUCE_DECLARE_NON_COPYABLE (DelayChannelOp)
 };
 
+class DelayMidiBufferOp : public LatencyCompensationOp
+{
+public:
+    DelayMidiBufferOp (const int bufferNum_, const int numSamplesDelay_, const int maxBlockSize_)
+        : bufferNum (bufferNum_),
+          maxDelay (delayCapacityFor (numSamplesDelay_)),
+          capacity (jmin (maxPendingBytes, maxDelay + jmax (1, maxBlockSize_))),
+          delay (numSamplesDelay_)
+    {
+        // about a byte per sample in flight, a short message every nine
+        // samples or so. Anything denser is dropped instead of allocating.
+        pending.ensureSize ((size_t) capacity);
+        scratch.ensureSize ((size_t) capacity);
+    }
+
+    std::string traceStep() const noexcept override
+    {
+        String str;
+        str << "DelayMidiBufferOp: buffer " << bufferNum << " by " << delay.load() << " samples";
+        return str.toStdString();
+    }
+
+    int getMaxDelaySamples() const noexcept override { return maxDelay; }
+    void setDelaySamples (int newDelay) noexcept override { delay.store (jlimit (0, maxDelay, newDelay)); }
+    int getNumDroppedEvents() const noexcept override { return numDropped.load (std::memory_order_relaxed); }
+
+    void perform (AudioSampleBuffer&, const OwnedArray<MidiBuffer>& sharedMidiBuffers, const SharedAtom&, const int numSamples) override
+    {
+        auto& midi = *sharedMidiBuffers.getUnchecked (bufferNum);
+        const int delaySamples = delay.load (std::memory_order_relaxed);
+
+        for (const auto msg : midi)
+        {
+            if (msg.samplePosition >= numSamples)
+                continue;
+
+            if (pending.data.size() + getStoredSize (msg.numBytes) > capacity)
+            {
+                numDropped.fetch_add (1, std::memory_order_relaxed);
+                continue;
+            }
+
+            pending.addEvent (msg.data, msg.numBytes, msg.samplePosition + delaySamples);
+        }
+
+        midi.clear();
+        scratch.clear();
+
+        for (const auto msg : pending)
+        {
+            if (msg.samplePosition < numSamples)
+                midi.addEvent (msg.data, msg.numBytes, msg.samplePosition);
+            else
+                scratch.addEvent (msg.data, msg.numBytes, msg.samplePosition - numSamples);
+        }
+
+        pending.swapWith (scratch);
+    }
+
+private:
+    static constexpr int maxPendingBytes = 1 << 20;
+    const int bufferNum, maxDelay, capacity;
+    std::atomic<int> delay;
+    std::atomic<int> numDropped { 0 };
+    MidiBuffer pending, scratch;
+
+    /** Returns the bytes a MidiBuffer uses for an event, its time and size
+        are stored ahead of the data. */
+    static int getStoredSize (int numBytes) noexcept
+    {
+        return (int) (sizeof (int32) + sizeof (uint16)) + numBytes;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (DelayMidiBufferOp)
+};
+
+/** Measures how long a node takes to render, see Processor::updateCpuLoad. */
+struct ScopedCpuLoad final
+{
+    ScopedCpuLoad (Processor& p, int n) noexcept
+        : node (p), numSamples (n), start (Time::getHighResolutionTicks()) {}
+    ~ScopedCpuLoad() { node.updateCpuLoad (Time::getHighResolutionTicks() - start, numSamples); }
+
+    Processor& node;
+    const int numSamples;
+    const int64 start;
+    JUCE_DECLARE_NON_COPYABLE (ScopedCpuLoad)
+};
+
+//==============================================================================
 class ProcessBufferOp : public GraphOp
 {
 public:
@@ -411,6 +547,7 @@ public:
                   const SharedAtom& sharedAtomBuffers,
                   const int numSamples) override
     {
+        const ScopedCpuLoad cpu (*node, numSamples);
         for (int i = totalChans; --i >= 0;)
             channels[i] = sharedBufferChans.getWritePointer (audioChannelsToUse.getUnchecked (i), 0);
         for (int i = totalCV; --i >= 0;)
@@ -662,7 +799,8 @@ GraphBuilder::GraphBuilder (GraphNode& graph_,
     : graph (graph_),
       orderedNodes (orderedNodes_),
       midi_MidiEvent (graph.symbols().map (LV2_MIDI__MidiEvent)),
-      totalLatency (0)
+      totalLatency (0),
+      maxBlockSize (jmax (4096, graph.getBlockSize()))
 {
     for (int i = 0; i < PortType::Unknown; ++i)
     {
@@ -759,6 +897,66 @@ int GraphBuilder::getInputLatency (const uint32 nodeID) const
     return maxLatency;
 }
 
+int GraphBuilder::getShortestInputLatency (const uint32 nodeID) const
+{
+    int minLatency = -1;
+
+    for (int i = graph.getNumConnections(); --i >= 0;)
+    {
+        const auto* const c = graph.getConnection (i);
+        if (c->destNode == nodeID)
+        {
+            const int latency = getNodeDelay (c->sourceNode);
+            minLatency = minLatency < 0 ? latency : jmin (minLatency, latency);
+        }
+    }
+
+    return jmax (0, minLatency);
+}
+
+bool GraphBuilder::isLivePath (const uint32 sourceNode, const uint32 destNode) const
+{
+    const auto* const src = graph.getNodeForId (sourceNode);
+    const auto* const dst = graph.getNodeForId (destNode);
+    return (src != nullptr && graph.isLiveNode (*src))
+           || (dst != nullptr && graph.isLiveNode (*dst));
+}
+
+int GraphBuilder::getDelayFor (const uint32 sourceNode, const uint32 destNode, const int maxLatency) const
+{
+    if (isLivePath (sourceNode, destNode))
+        return 0;
+    return jmax (0, maxLatency - getNodeDelay (sourceNode));
+}
+
+void GraphBuilder::addDelayOp (Array<void*>& renderingOps, PortType type, int bufIndex, int maxLatency, uint32 sourceNode, uint32 sourcePort, uint32 destNode, uint32 destPort)
+{
+    const int delay = getDelayFor (sourceNode, destNode, maxLatency);
+    LatencyCompensationOp* op = nullptr;
+    if (delay > 0)
+    {
+        if (type.isAudio() || type.isCv())
+            op = new DelayChannelOp (bufIndex, delay, maxBlockSize);
+        else if (type.isMidi())
+            op = new DelayMidiBufferOp (bufIndex, delay, maxBlockSize);
+    }
+
+    if (op != nullptr)
+        renderingOps.add (op);
+
+    LatencyCompensation lc;
+    lc.sourceNode = sourceNode;
+    lc.sourcePort = sourcePort;
+    lc.destNode = destNode;
+    lc.destPort = destPort;
+    lc.type = type;
+    lc.delaySamples = op != nullptr ? delay : 0;
+    lc.live = isLivePath (sourceNode, destNode);
+    lc.unalignedSamples = lc.live ? jmax (0, maxLatency - getNodeDelay (sourceNode)) : 0;
+    compensation.add (lc);
+    compensationOps.add (op);
+}
+
 void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                                               Array<void*>& renderingOps,
                                               const int ourRenderingIndex)
@@ -894,6 +1092,8 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
             }
 
             const bool bufNeededLater = isBufferNeededLater (ourRenderingIndex, port, srcNode, srcPort);
+            const bool canDelay = (portType.isAudio() || portType.isCv() || portType.isMidi()) && ! srcType.isControl();
+            const int delay = canDelay ? getDelayFor (srcNode, node->nodeId, maxLatency) : 0;
 
             if (portType == PortType::Control)
             {
@@ -912,6 +1112,7 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
             // clang-format off
             else if (srcType != portType || 
                      (bufNeededLater && (inputChan < (int) numOuts || 
+                                         delay > 0 ||
                                          portType == PortType::Midi || 
                                          portType == PortType::Atom)))
             // clang-format on
@@ -948,10 +1149,8 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                 bufIndex = newFreeBuffer;
             }
 
-            const int nodeDelay = getNodeDelay (srcNode);
-
-            if (nodeDelay < maxLatency)
-                renderingOps.add (new DelayChannelOp (bufIndex, maxLatency - nodeDelay));
+            if (canDelay)
+                addDelayOp (renderingOps, portType, bufIndex, maxLatency, srcNode, srcPort, node->nodeId, port);
         }
         else
         {
@@ -961,7 +1160,7 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
 
             for (int i = 0; i < sourceNodes.size(); ++i)
             {
-                if (sourceTypes.getUnchecked (i != portType))
+                if (sourceTypes.getUnchecked (i) != portType)
                     continue;
 
                 const int sourceBufIndex = getBufferContaining (sourceTypes.getUnchecked (i),
@@ -978,11 +1177,13 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                     reusableInputIndex = i;
                     bufIndex = sourceBufIndex;
 
-                    if (portType == PortType::Audio || portType == PortType::CV)
+                    if (canCompensate (sourceTypes.getUnchecked (i), portType))
                     {
-                        const int nodeDelay = getNodeDelay (sourceNodes.getUnchecked (i));
-                        if (nodeDelay < maxLatency)
-                            renderingOps.add (new DelayChannelOp (sourceBufIndex, maxLatency - nodeDelay));
+                        addDelayOp (renderingOps, portType, sourceBufIndex, maxLatency,
+                                    sourceNodes.getUnchecked (i),
+                                    sourcePorts.getUnchecked (i),
+                                    node->nodeId,
+                                    port);
                     }
 
                     break;
@@ -1039,11 +1240,13 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
 
                 reusableInputIndex = 0;
 
-                if (portType == PortType::Audio)
+                if (canCompensate (sourceTypes.getFirst(), portType))
                 {
-                    const int nodeDelay = getNodeDelay (sourceNodes.getFirst());
-                    if (nodeDelay < maxLatency)
-                        renderingOps.add (new DelayChannelOp (bufIndex, maxLatency - nodeDelay));
+                    addDelayOp (renderingOps, portType, bufIndex, maxLatency,
+                                sourceNodes.getFirst(),
+                                sourcePorts.getFirst(),
+                                node->nodeId,
+                                port);
                 }
             }
 
@@ -1056,30 +1259,26 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
                                                         sourcePorts.getUnchecked (j));
                     if (srcIndex >= 0)
                     {
-                        if (portType == PortType::Audio || portType == PortType::CV)
+                        if (canCompensate (sourceTypes.getUnchecked (j), portType))
                         {
-                            const int nodeDelay = getNodeDelay (sourceNodes.getUnchecked (j));
-
-                            if (nodeDelay < maxLatency)
+                            const int delay = getDelayFor (sourceNodes.getUnchecked (j), node->nodeId, maxLatency);
+                            if (delay > 0 && isBufferNeededLater (ourRenderingIndex, port, sourceNodes.getUnchecked (j), sourcePorts.getUnchecked (j)))
                             {
-                                if (! isBufferNeededLater (ourRenderingIndex, port, sourceNodes.getUnchecked (j), sourcePorts.getUnchecked (j)))
-                                {
-                                    renderingOps.add (new DelayChannelOp (srcIndex, maxLatency - nodeDelay));
-                                }
-                                else // buffer is reused elsewhere, can't be delayed
-                                {
-                                    const int bufferToDelay = getFreeBuffer (PortType::Audio);
+                                // buffer is reused elsewhere, delay a copy of it instead
+                                const int bufferToDelay = getFreeBuffer (portType);
+                                if (portType.isMidi())
+                                    renderingOps.add (new CopyMidiBufferOp (srcIndex, bufferToDelay));
+                                else
                                     renderingOps.add (new CopyChannelOp (srcIndex, bufferToDelay));
-                                    renderingOps.add (new DelayChannelOp (bufferToDelay, maxLatency - nodeDelay));
-                                    srcIndex = bufferToDelay;
-                                }
+                                srcIndex = bufferToDelay;
                             }
 
-                            renderingOps.add (new AddChannelOp (srcIndex, bufIndex));
-                        }
-                        else if (sourceTypes.getUnchecked (j).isMidi() && portType.isMidi())
-                        {
-                            renderingOps.add (new AddMidiBufferOp (srcIndex, bufIndex));
+                            addDelayOp (renderingOps, portType, srcIndex, maxLatency, sourceNodes.getUnchecked (j), sourcePorts.getUnchecked (j), node->nodeId, port);
+
+                            if (portType.isMidi())
+                                renderingOps.add (new AddMidiBufferOp (srcIndex, bufIndex));
+                            else
+                                renderingOps.add (new AddChannelOp (srcIndex, bufIndex));
                         }
                         else if (sourceTypes.getUnchecked (j).isAtom() && portType.isAtom())
                         {
@@ -1108,10 +1307,12 @@ void GraphBuilder::createRenderingOpsForNode (Processor* const node,
         }
     } /* foreach port */
 
-    setNodeDelay (node->nodeId, maxLatency + node->getLatencySamples());
+    // live nodes pass on their fastest input, that's the path someone is listening to.
+    const int inputLatency = graph.isLiveNode (*node) ? getShortestInputLatency (node->nodeId) : maxLatency;
+    setNodeDelay (node->nodeId, inputLatency + node->getLatencySamples());
 
     if (node->isAudioIONode() && node->getNumPorts (PortType::Audio, false) == 0)
-        totalLatency = maxLatency;
+        totalLatency = inputLatency;
 
     int totalChans = jmax (node->getNumPorts (PortType::Audio, true),
                            node->getNumPorts (PortType::Audio, false));
@@ -28,6 +28,49 @@ private:
     JUCE_LEAK_DETECTOR (GraphOp)
 };
 
+/** A rendering op which delays one buffer to keep parallel paths aligned.
+
+    The delay can be changed while rendering, up to the capacity the op was
+    created with, so latency changes don't always need a full rebuild.
+ */
+class LatencyCompensationOp : public GraphOp
+{
+public:
+    LatencyCompensationOp() = default;
+    virtual ~LatencyCompensationOp() = default;
+
+    /** Returns the largest delay this op can apply without reallocating. */
+    virtual int getMaxDelaySamples() const noexcept = 0;
+
+    /** Change the delay. Safe to call while the op is rendering. */
+    virtual void setDelaySamples (int newDelay) noexcept = 0;
+
+    /** Returns how many events were dropped because the delay line was
+        full. Safe to call while the op is rendering. */
+    virtual int getNumDroppedEvents() const noexcept { return 0; }
+};
+
+/** Describes the delay compensation applied to a single connection. */
+struct LatencyCompensation
+{
+    uint32 sourceNode = EL_INVALID_NODE;
+    uint32 sourcePort = EL_INVALID_PORT;
+    uint32 destNode = EL_INVALID_NODE;
+    uint32 destPort = EL_INVALID_PORT;
+    PortType type { PortType::Unknown };
+
+    /** Delay in samples added to this connection. */
+    int delaySamples = 0;
+
+    /** True if this connection is excluded from alignment by live mode. */
+    bool live = false;
+
+    /** For live connections, how many samples this signal arrives ahead of
+        the slowest input of the destination. Anything above zero means it
+        is no longer phase aligned with the other inputs. */
+    int unalignedSamples = 0;
+};
+
 /** Used to calculate the correct sequence of rendering ops needed, based on
     the best re-use of shared buffers at each stage. */
 class GraphBuilder
@@ -40,6 +83,14 @@ public:
     int buffersNeeded (PortType type);
     int getTotalLatencySamples() const { return totalLatency; }
 
+    /** Returns the compensation computed for every audio, CV, and MIDI
+        connection in the graph. */
+    const Array<LatencyCompensation>& getLatencyCompensation() const noexcept { return compensation; }
+
+    /** Returns the op applying each entry of getLatencyCompensation(), or
+        nullptr if that connection didn't need delaying. */
+    const Array<LatencyCompensationOp*>& getLatencyCompensationOps() const noexcept { return compensationOps; }
+
 private:
     //==============================================================================
     GraphNode& graph;
@@ -60,11 +111,21 @@ private:
     Array<uint32> nodeDelayIDs;
     Array<int> nodeDelays;
     int totalLatency;
+    const int maxBlockSize;
+
+    Array<LatencyCompensation> compensation;
+    Array<LatencyCompensationOp*> compensationOps;
 
     int getNodeDelay (const uint32 nodeID) const;
     void setNodeDelay (const uint32 nodeID, const int latency);
 
     int getInputLatency (const uint32 nodeID) const;
+    int getShortestInputLatency (const uint32 nodeID) const;
+
+    bool isLivePath (const uint32 sourceNode, const uint32 destNode) const;
+    int getDelayFor (const uint32 sourceNode, const uint32 destNode, const int maxLatency) const;
+    void addDelayOp (Array<void*>& renderingOps, PortType type, int bufIndex, int maxLatency,
+                     uint32 sourceNode, uint32 sourcePort, uint32 destNode, uint32 destPort);
 
     void createRenderingOpsForNode (Processor* const node, Array<void*>& renderingOps, const int ourRenderingIndex);
 
@@ -3,6 +3,7 @@
 
 #include <element/context.hpp>
 #include <element/plugins.hpp>
+#include <element/nodefactory.hpp>
 
 #include "engine/graphmanager.hpp"
 #include "nodes/audioprocessor.hpp"
@@ -11,6 +12,7 @@
 #include "nodes/midiprogrammap.hpp"
 #include "nodes/placeholder.hpp"
 #include "engine/rootgraph.hpp"
+#include "session/statecache.hpp"
 
 #include "utils.hpp"
 
@@ -145,6 +147,68 @@ private:
     }
 };
 
+//==============================================================================
+/** Threads used to create nodes and restore their state while a graph
+    model loads. Only nodes from thread safe providers go through here. */
+class NodeLoaderPool
+{
+public:
+    NodeLoaderPool()
+        : pool (jlimit (1, 8, SystemStats::getNumCpus() / 2)) {}
+
+    /** Call a function for each index in [0, num) on the pool and wait for
+        all of them to finish. */
+    void run (int num, std::function<void (int)> fn)
+    {
+        if (num <= 0)
+            return;
+
+        if (num == 1)
+        {
+            fn (0);
+            return;
+        }
+
+        OwnedArray<Job> jobs;
+        for (int i = 0; i < num; ++i)
+            pool.addJob (jobs.add (new Job (fn, i)), false);
+        for (auto* job : jobs)
+            pool.waitForJobToFinish (job, -1);
+    }
+
+private:
+    struct Job : public ThreadPoolJob
+    {
+        Job (const std::function<void (int)>& f, int i)
+            : ThreadPoolJob ("node loader"), fn (f), index (i) {}
+
+        JobStatus runJob() override
+        {
+            fn (index);
+            return jobHasFinished;
+        }
+
+        const std::function<void (int)>& fn;
+        const int index;
+    };
+
+    ThreadPool pool;
+};
+
+/** Same as the program and state part of Node::restorePluginState() */
+static void restoreProgramAndState (Processor& obj, int program, const var& data)
+{
+    if (obj.getNumPrograms() > 0 && isPositiveAndBelow (program, obj.getNumPrograms()))
+        obj.setCurrentProgram (program);
+
+    if (data.isVoid())
+        return;
+
+    const auto state = StateCache::decode (data);
+    if (state->getSize() > 0)
+        obj.setState (state->getData(), (int) state->getSize());
+}
+
 //==============================================================================
 class NodeModelUpdater : public ReferenceCountedObject
 {
@@ -163,6 +227,8 @@ public:
         portsChangedConnection.disconnect();
     }
 
+    GraphManager& getManager() const noexcept { return manager; }
+
 private:
     GraphManager& manager;
     ValueTree data;
@@ -614,14 +680,58 @@ void GraphManager::setNodeModel (const Node& node)
 
     graph.setProperty (tags::updater, new NodeModelUpdater (*this, graph, &processor), nullptr);
 
-    Array<ValueTree> failed;
+    // Nodes from thread safe providers are created and have their state
+    // restored on the loader pool, everything else on this thread in order.
+    struct PendingNode
+    {
+        Node node;
+        PluginDescription desc;
+        NodeProvider* provider = nullptr;
+        ProcessorPtr object;
+        bool restoreConcurrently = false;
+        int program = -1;
+        var state;
+    };
+
+    std::vector<PendingNode> pending;
+    Array<int> concurrent;
+    pending.reserve ((size_t) nodes.getNumChildren());
     for (int i = 0; i < nodes.getNumChildren(); ++i)
     {
-        Node node (nodes.getChild (i), false);
-        const PluginDescription desc (pluginManager.findDescriptionFor (node));
-        if (ProcessorPtr obj = createFilter (&desc, 0, 0, node.getNodeId()))
+        auto& entry = pending.emplace_back();
+        entry.node = Node (nodes.getChild (i), false);
+        entry.desc = pluginManager.findDescriptionFor (entry.node);
+        entry.provider = pluginManager.getNodeFactory().findThreadSafeProvider (entry.desc);
+        if (entry.provider != nullptr)
+            concurrent.add (i);
+    }
+
+    SharedResourcePointer<NodeLoaderPool> loader;
+    loader->run (concurrent.size(), [&] (int i) {
+        auto& entry = pending[(size_t) concurrent.getUnchecked (i)];
+        entry.object = entry.provider->create (entry.desc.fileOrIdentifier);
+    });
+
+    Array<ValueTree> failed;
+    for (auto& entry : pending)
+    {
+        Node& node = entry.node;
+        ProcessorPtr obj;
+        if (entry.provider != nullptr)
+            obj = entry.object != nullptr ? processor.addNode (entry.object.get(), node.getNodeId()) : nullptr;
+        else
+            obj = createFilter (&entry.desc, 0, 0, node.getNodeId());
+
+        if (obj != nullptr)
         {
-            setupNode (node.data(), obj);
+            entry.restoreConcurrently = entry.provider != nullptr && obj->getAudioProcessor() == nullptr;
+            if (entry.restoreConcurrently)
+            {
+                entry.program = node.getProperty (tags::program, -1);
+                entry.state = node.data().getProperty (tags::state);
+            }
+
+            setupNode (node.data(), obj, ! entry.restoreConcurrently);
             obj->setEnabled (node.isEnabled());
             node.setProperty (tags::enabled, obj->isEnabled());
         }
@@ -636,8 +746,27 @@ void GraphManager::setNodeModel (const Node& node)
             DBG ("[element] couldn't create node: " << node.getName());
             failed.add (node.data());
         }
+
+        entry.object = obj;
     }
 
+    concurrent.clearQuick();
+    for (int i = 0; i < (int) pending.size(); ++i)
+        if (pending[(size_t) i].restoreConcurrently)
+            concurrent.add (i);
+
+    loader->run (concurrent.size(), [&] (int i) {
+        const auto& entry = pending[(size_t) concurrent.getUnchecked (i)];
+        restoreProgramAndState (*entry.object, entry.program, entry.state);
+    });
+
+    // same order as Node::restorePluginState: program and state first, then
+    // bypass, gain and MIDI settings.
+    for (auto& entry : pending)
+        if (entry.restoreConcurrently)
+            entry.node.restoreProcessorSettings();
+    pending.clear();
+
     for (const auto& n : failed)
     {
         nodes.removeChild (n, nullptr);
@@ -648,10 +777,6 @@ void GraphManager::setNodeModel (const Node& node)
     // If you hit this, then failed nodes didn't get handled properly
     jassert (nodes.getNumChildren() == processor.getNumNodes());
 
-    // Cheap way to refresh engine-side nodes
-    processor.triggerAsyncUpdate();
-    processor.handleUpdateNowIfNeeded();
-
     for (int i = 0; i < arcs.getNumChildren(); ++i)
     {
         ValueTree arc (arcs.getChild (i));
@@ -701,6 +826,10 @@ void GraphManager::setNodeModel (const Node& node)
 
     IONodeEnforcer enforceIONodes (*this);
     processorArcsChanged();
+
+    // adding nodes and connections above only flagged the graph for an
+    // update, build the rendering sequence once now that everything is in.
+    processor.rebuild();
 }
 
 void GraphManager::savePluginStates()
@@ -731,8 +860,45 @@ void GraphManager::clear()
     changed();
 }
 
+void GraphManager::beginBatch()
+{
+    if (batchDepth++ == 0)
+        processor.beginBatch();
+}
+
+void GraphManager::endBatch()
+{
+    jassert (batchDepth > 0);
+    if (batchDepth <= 0 || --batchDepth > 0)
+        return;
+
+    if (arcsPending)
+    {
+        arcsPending = false;
+        processorArcsChanged();
+    }
+
+    processor.endBatch();
+}
+
+GraphManager* GraphManager::forModel (const Node& graph)
+{
+    if (! graph.isGraph())
+        return nullptr;
+    if (auto* updater = dynamic_cast<NodeModelUpdater*> (graph.data().getProperty (tags::updater).getObject()))
+        return &updater->getManager();
+    return nullptr;
+}
+
 void GraphManager::processorArcsChanged()
 {
+    // the arcs model is rebuilt from scratch, do it once per batch
+    if (batchDepth > 0)
+    {
+        arcsPending = true;
+        return;
+    }
+
     ValueTree newArcs = ValueTree (tags::arcs);
     for (int i = 0; i < processor.getNumConnections(); ++i)
         newArcs.addChild (Node::makeArc (*processor.getConnection (i)), -1, nullptr);
@@ -763,7 +929,7 @@ void GraphManager::processorArcsChanged()
     changed();
 }
 
-void GraphManager::setupNode (const ValueTree& data, ProcessorPtr obj)
+void GraphManager::setupNode (const ValueTree& data, ProcessorPtr obj, bool restoreState)
 {
     jassert (obj && data.hasType (types::Node));
     Node node (data, false);
@@ -837,7 +1003,10 @@ void GraphManager::setupNode (const ValueTree& data, ProcessorPtr obj)
         resetPorts = true;
     }
 
-    node.restorePluginState();
+    // when not restoring here, the caller restores program, state and
+    // settings later.  Only nodes with fixed ports are restored that way.
+    if (restoreState)
+        node.restorePluginState();
     node.resetPorts();
     if (node.isA ("Element", EL_NODE_ID_MIDI_INPUT_DEVICE) || node.isA ("Element", EL_NODE_ID_MIDI_OUTPUT_DEVICE))
     {
@@ -92,11 +92,39 @@ public:
 
     inline bool isLoaded() const { return loaded; }
 
+    /** Group many changes, e.g. from a script building a graph.
+
+        While a batch is open the arcs model isn't rebuilt for every new
+        connection and the graph's rendering sequence isn't rebuilt at all.
+        Both happen once when the outermost batch ends.  Nodes are still
+        added to the model as they're created.
+     */
+    void beginBatch();
+    void endBatch();
+
+    /** Keeps a batch open for the current scope. */
+    class ScopedBatch
+    {
+    public:
+        explicit ScopedBatch (GraphManager& m) : manager (m) { manager.beginBatch(); }
+        ~ScopedBatch() { manager.endBatch(); }
+
+    private:
+        GraphManager& manager;
+        JUCE_DECLARE_NON_COPYABLE (ScopedBatch)
+    };
+
+    /** Returns the manager controlling a graph model, or nullptr if the
+        graph isn't loaded in the engine. */
+    static GraphManager* forModel (const Node& graph);
+
 private:
     PluginManager& pluginManager;
     GraphNode& processor;
     ValueTree graph, arcs, nodes;
     bool loaded = false;
+    int batchDepth = 0;
+    bool arcsPending = false;
 
     uint32 lastUID;
 
@@ -109,7 +137,7 @@ private:
     Processor* createFilter (const PluginDescription* desc, double x = 0.0f, double y = 0.0f, uint32 nodeId = 0);
     Processor* createPlaceholder (const Node& node);
 
-    void setupNode (const ValueTree& data, ProcessorPtr object);
+    void setupNode (const ValueTree& data, ProcessorPtr object, bool restoreState = true);
 
     void processorArcsChanged();
 
@@ -1,6 +1,8 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <unordered_map>
+
 #include <element/audioengine.hpp>
 #include <element/midipipe.hpp>
 #include <element/node.hpp>
@@ -34,7 +36,8 @@ GraphNode::GraphNode (Context& c)
       renderingBuffers (1, 1),
       currentAudioInputBuffer (nullptr),
       currentAudioOutputBuffer (1, 1),
-      currentMidiInputBuffer (nullptr)
+      currentMidiInputBuffer (nullptr),
+      latencyUpdater (*this)
 {
     for (int i = 0; i < IONode::numDeviceTypes; ++i)
         ioNodes[i] = EL_INVALID_PORT;
@@ -44,6 +47,7 @@ GraphNode::GraphNode (Context& c)
 GraphNode::~GraphNode()
 {
     renderingSequenceChanged.disconnect_all_slots();
+    latencyChanged.disconnect_all_slots();
     clearRenderingSequence();
     clear();
 }
@@ -373,6 +377,10 @@ void GraphNode::clearRenderingSequence()
         renderingOps.swapWith (oldOps);
     }
 
+    renderingOrder.clear();
+    latencyCompensation.clearQuick();
+    latencyCompensationOps.clearQuick();
+
     deleteRenderOpArray (oldOps);
 }
 
@@ -398,7 +406,12 @@ bool GraphNode::isAnInputTo (const uint32 possibleInputId,
 
 void GraphNode::buildRenderingSequence()
 {
+    ++numRebuilds;
     Array<void*> newRenderingOps;
+    ReferenceCountedArray<Processor> newRenderingOrder;
+    Array<LatencyCompensation> newCompensation;
+    Array<LatencyCompensationOp*> newCompensationOps;
+    const int lastLatency = getLatencySamples();
     int numRenderingBuffersNeeded = 2;
     int numMidiBuffersNeeded = 1;
     int numAtomBuffersNeeded = 1;
@@ -425,18 +438,27 @@ void GraphNode::buildRenderingSequence()
             }
         }
 
+        for (auto* ptr : orderedNodes)
+            newRenderingOrder.add (static_cast<Processor*> (ptr));
+
         GraphBuilder builder (*this, orderedNodes, newRenderingOps);
+        newCompensation = builder.getLatencyCompensation();
+        newCompensationOps = builder.getLatencyCompensationOps();
         numRenderingBuffersNeeded = builder.buffersNeeded (PortType::Audio);
         numMidiBuffersNeeded = builder.buffersNeeded (PortType::Midi);
         numAtomBuffersNeeded = builder.buffersNeeded (PortType::Atom);
-        setLatencySamples (builder.getTotalLatencySamples());
+
+        // When oversampled, nodes inside this graph report latency at the
+        // higher rate. Parents expect it in samples of their own rate.
+        const int osFactor = jmax (1, getOversamplingFactor());
+        setLatencySamples ((builder.getTotalLatencySamples() + osFactor - 1) / osFactor);
     }
 
     {
         // swap over to the new rendering sequence..
         {
             const ScopedLock sl (getPropertyLock());
-            renderingBuffers.setSize (numRenderingBuffersNeeded, 4096);
+            renderingBuffers.setSize (numRenderingBuffersNeeded, jmax (4096, getBlockSize()));
             renderingBuffers.clear();
             for (auto ab : atomBuffers)
                 ab->clear();
@@ -456,10 +478,158 @@ void GraphNode::buildRenderingSequence()
         renderingOps.swapWith (newRenderingOps);
     }
 
+    renderingOrder.swapWith (newRenderingOrder);
+    latencyCompensation.swapWith (newCompensation);
+    latencyCompensationOps.swapWith (newCompensationOps);
+
     // delete the old ones..
     deleteRenderOpArray (newRenderingOps);
 
     renderingSequenceChanged();
+
+    logLatencyWarnings();
+
+    if (lastLatency != getLatencySamples())
+        if (auto* const parentGraph = getParentGraph())
+            parentGraph->triggerLatencyUpdate();
+}
+
+StringArray GraphNode::getLatencyWarnings() const
+{
+    StringArray warnings;
+
+    for (const auto& lc : latencyCompensation)
+    {
+        if (! lc.live || lc.unalignedSamples <= 0 || lc.type.isMidi())
+            continue;
+
+        auto* const src = getNodeForId (lc.sourceNode);
+        auto* const dst = getNodeForId (lc.destNode);
+        if (src == nullptr || dst == nullptr)
+            continue;
+
+        warnings.add (src->getName() + " -> " + dst->getName() + ": live path is "
+                      + String (lc.unalignedSamples) + " samples ahead of other inputs, expect phase issues");
+    }
+
+    return warnings;
+}
+
+void GraphNode::logLatencyWarnings()
+{
+    // rebuilds happen often, only log what wasn't reported last time.
+    auto warnings = getLatencyWarnings();
+    if (warnings == loggedLatencyWarnings)
+        return;
+
+    for (const auto& warning : warnings)
+        if (! loggedLatencyWarnings.contains (warning))
+            Logger::writeToLog ("[element] " + warning);
+
+    loggedLatencyWarnings.swapWith (warnings);
+}
+
+int GraphNode::getNumDroppedMidiEvents() const
+{
+    int numDropped = 0;
+    for (const auto* const op : latencyCompensationOps)
+        if (op != nullptr)
+            numDropped += op->getNumDroppedEvents();
+    return numDropped;
+}
+
+bool GraphNode::isLiveNode (const Processor& node) const
+{
+    if (node.isLiveMode())
+        return true;
+
+    for (const Processor* graph = this; graph != nullptr; graph = graph->getParentGraph())
+        if (graph->isLiveMode())
+            return true;
+
+    return false;
+}
+
+void GraphNode::triggerLatencyUpdate()
+{
+    latencyUpdater.triggerAsyncUpdate();
+}
+
+void GraphNode::LatencyUpdater::handleAsyncUpdate()
+{
+    // a pending rebuild will recalculate everything anyway.
+    if (graph.isUpdatePending())
+        return;
+
+    if (! graph.updateLatencyCompensation())
+        graph.rebuild();
+}
+
+bool GraphNode::updateLatencyCompensation()
+{
+    // Same propagation the GraphBuilder does, without touching buffers.
+    std::unordered_map<uint32, int> inputLatency, nodeDelay;
+    int totalLatency = 0;
+
+    for (auto* const node : renderingOrder)
+    {
+        int maxLatency = 0, minLatency = -1;
+        for (const auto* c : connections)
+        {
+            if (c->destNode == node->nodeId)
+            {
+                const int latency = nodeDelay[c->sourceNode];
+                maxLatency = jmax (maxLatency, latency);
+                minLatency = minLatency < 0 ? latency : jmin (minLatency, latency);
+            }
+        }
+
+        const int shortestLatency = isLiveNode (*node) ? jmax (0, minLatency) : maxLatency;
+        inputLatency[node->nodeId] = maxLatency;
+        nodeDelay[node->nodeId] = shortestLatency + node->getLatencySamples();
+
+        if (node->isAudioOutputNode() && node->getNumPorts (PortType::Audio, true) > 0)
+            totalLatency = shortestLatency;
+    }
+
+    Array<int> delays;
+    delays.ensureStorageAllocated (latencyCompensation.size());
+
+    for (int i = 0; i < latencyCompensation.size(); ++i)
+    {
+        const auto& lc = latencyCompensation.getReference (i);
+        const int delay = lc.live ? 0 : jmax (0, inputLatency[lc.destNode] - nodeDelay[lc.sourceNode]);
+        auto* const op = latencyCompensationOps.getUnchecked (i);
+
+        if (delay > 0 && (op == nullptr || delay > op->getMaxDelaySamples()))
+            return false; // needs a new or bigger delay line.
+
+        delays.add (delay);
+    }
+
+    for (int i = 0; i < latencyCompensation.size(); ++i)
+    {
+        if (auto* const op = latencyCompensationOps.getUnchecked (i))
+            op->setDelaySamples (delays.getUnchecked (i));
+
+        auto& lc = latencyCompensation.getReference (i);
+        lc.delaySamples = delays.getUnchecked (i);
+        if (lc.live)
+            lc.unalignedSamples = jmax (0, inputLatency[lc.destNode] - nodeDelay[lc.sourceNode]);
+    }
+
+    const int lastLatency = getLatencySamples();
+    const int osFactor = jmax (1, getOversamplingFactor());
+    setLatencySamples ((totalLatency + osFactor - 1) / osFactor);
+
+    latencyChanged();
+    logLatencyWarnings();
+
+    if (lastLatency != getLatencySamples())
+        if (auto* const parentGraph = getParentGraph())
+            parentGraph->triggerLatencyUpdate();
+
+    return true;
 }
 
 void GraphNode::getOrderedNodes (ReferenceCountedArray<Processor>& orderedNodes)
@@ -480,9 +650,29 @@ void GraphNode::getOrderedNodes (ReferenceCountedArray<Processor>& orderedNodes)
 
 void GraphNode::handleAsyncUpdate()
 {
+    if (batchDepth > 0)
+    {
+        rebuildPending = true;
+        return;
+    }
+
     buildRenderingSequence();
 }
 
+void GraphNode::endBatch()
+{
+    jassert (batchDepth > 0);
+    if (batchDepth <= 0 || --batchDepth > 0)
+        return;
+
+    if (rebuildPending || isUpdatePending())
+    {
+        rebuildPending = false;
+        cancelPendingUpdate();
+        buildRenderingSequence();
+    }
+}
+
 void GraphNode::prepareToRender (double sampleRate, int estimatedSamplesPerBlock)
 {
     if (prepared())
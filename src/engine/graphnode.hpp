@@ -5,6 +5,7 @@
 
 #include "ElementApp.h"
 #include <element/processor.hpp>
+#include "engine/graphbuilder.hpp"
 #include "engine/velocitycurve.hpp"
 #include <element/arc.hpp>
 #include <element/signals.hpp>
@@ -20,6 +21,9 @@ class GraphNode : public Processor,
 public:
     Signal<void()> renderingSequenceChanged;
 
+    /** Triggered when latency compensation was updated without a rebuild. */
+    Signal<void()> latencyChanged;
+
     GraphNode() = delete;
     /** Creates an empty graph. */
     GraphNode (Context&);
@@ -189,6 +193,48 @@ public:
     /** Rebuild rendering ops immediately. */
     void rebuild() noexcept;
 
+    /** Hold off rebuilding the rendering sequence while making many changes.
+        Calls nest. When the outermost batch ends the sequence is rebuilt
+        once, if anything asked for it in the meantime.
+     */
+    void beginBatch() noexcept { ++batchDepth; }
+    void endBatch();
+
+    /** Returns true while a batch is open. */
+    bool isBatching() const noexcept { return batchDepth > 0; }
+
+    /** Returns how many times the rendering sequence has been built. */
+    int getNumRebuilds() const noexcept { return numRebuilds; }
+
+    //==========================================================================
+    /** Returns the delay compensation applied to each audio, CV, and MIDI
+        connection. Call this on the message thread.
+     */
+    Array<LatencyCompensation> getLatencyCompensation() const { return latencyCompensation; }
+
+    /** Returns a message for each live mode connection which mixes with a
+        slower signal, and so is out of phase with it.
+     */
+    StringArray getLatencyWarnings() const;
+
+    /** Returns how many MIDI events latency compensation dropped because a
+        delay line was full, since the rendering sequence was last built.
+     */
+    int getNumDroppedMidiEvents() const;
+
+    /** Returns true if paths through the node are excluded from latency
+        alignment, because it or this graph (or a parent) is in live mode.
+     */
+    bool isLiveNode (const Processor& node) const;
+
+    /** Recalculate latency compensation after a node's latency changed.
+
+        Existing delay lines are adjusted in place when they can absorb the
+        change, otherwise the rendering sequence is rebuilt. This can be
+        called from any thread.
+     */
+    void triggerLatencyUpdate();
+
 protected:
     //==========================================================================
     virtual void preRenderNodes() {}
@@ -233,9 +279,28 @@ private:
     std::atomic<AudioPlayHead*> playhead { nullptr };
 
     bool customPortsSet = false;
+    int batchDepth = 0;
+    int numRebuilds = 0;
+    bool rebuildPending = false;
     PortList userPorts;
 
     CriticalSection seqLock;
+
+    ReferenceCountedArray<Processor> renderingOrder;
+    Array<LatencyCompensation> latencyCompensation;
+    Array<LatencyCompensationOp*> latencyCompensationOps;
+    StringArray loggedLatencyWarnings;
+
+    struct LatencyUpdater : public AsyncUpdater
+    {
+        LatencyUpdater (GraphNode& g) : graph (g) {}
+        ~LatencyUpdater() { cancelPendingUpdate(); }
+        void handleAsyncUpdate() override;
+        GraphNode& graph;
+    } latencyUpdater;
+
+    bool updateLatencyCompensation();
+    void logLatencyWarnings();
     friend class ScriptNode; // workaround so parameter connections work when params change.
     void handleAsyncUpdate() override;
     void clearRenderingSequence();
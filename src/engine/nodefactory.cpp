@@ -288,6 +288,20 @@ Processor* NodeFactory::instantiate (const String& identifier)
     return node;
 }
 
+NodeProvider* NodeFactory::findThreadSafeProvider (const PluginDescription& desc) const
+{
+    // Element IDs are spread over several providers, some of which go
+    // through juce::AudioPluginFormat and need the message thread.
+    if (desc.pluginFormatName == EL_NODE_FORMAT_NAME)
+        return nullptr;
+
+    for (auto* const f : impl->providers)
+        if (f->format() == desc.pluginFormatName && f->isThreadSafe())
+            return f;
+
+    return nullptr;
+}
+
 Processor* NodeFactory::wrap (AudioProcessor* processor)
 {
     jassert (processor);
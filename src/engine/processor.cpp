@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL3-or-later
 
 #include <iomanip>
+#include <map>
 
 #include <element/audioengine.hpp>
 #include <element/midipipe.hpp>
@@ -10,6 +11,7 @@
 
 #include "ElementApp.h"
 
+#include "session/statecache.hpp"
 #include "nodes/audioprocessor.hpp"
 #include "nodes/mididevice.hpp"
 #include "nodes/placeholder.hpp"
@@ -68,6 +70,8 @@ void Processor::clearParameters()
     for (const auto* param : parameters)
         jassert (param->getReferenceCount() >= 1);
 #endif
+    for (auto* param : parameters)
+        param->removeListener (&stateTracker);
     parameters.clear();
 }
 
@@ -207,6 +211,19 @@ void Processor::setOutputRMS (int chan, float val)
         outRMS.getUnchecked (chan)->set (val);
 }
 
+void Processor::updateCpuLoad (int64 elapsedTicks, int numSamples) noexcept
+{
+    static const double ticksPerSecond = (double) Time::getHighResolutionTicksPerSecond();
+    if (sampleRate <= 0.0 || numSamples <= 0)
+        return;
+
+    const auto load = (float) ((double) elapsedTicks * sampleRate / (ticksPerSecond * numSamples));
+    const auto smoothed = cpuLoad.get();
+    cpuLoad = smoothed + 0.1f * (load - smoothed);
+    if (load > peakCpuLoad.get())
+        peakCpuLoad = load;
+}
+
 bool Processor::isSuspended() const
 {
     return bypassed.get() == 1;
@@ -425,7 +442,7 @@ File Processor::getMidiProgramFile (int program) const
     std::stringstream stream;
     stream << uids.toStdString() << "_" << std::setfill ('0') << std::setw (3) << program << ".eln";
     String fileName = stream.str();
-    const File file (DataPath::defaultGlobalMidiProgramsDir().getChildFile (fileName));
+    const File file (getGlobalMidiProgramsDirectory().getChildFile (fileName));
     if (! file.getParentDirectory().exists())
         file.getParentDirectory().createDirectory();
     return file;
@@ -456,6 +473,7 @@ void Processor::removeMidiProgram (int program, bool global)
         const auto file = getMidiProgramFile (program);
         if (file.existsAsFile())
             file.deleteFile();
+        detail::globalMidiPrograms().remove (file);
     }
     else
     {
@@ -480,9 +498,139 @@ Processor::MidiProgram* Processor::getMidiProgram (int program) const
     return ret;
 }
 
+namespace detail {
+
+/** Decoded global MIDI programs keyed by program file, shared by all nodes
+    so one node writing or deleting a program is seen by the others. */
+class GlobalMidiPrograms
+{
+public:
+    using State = std::shared_ptr<const MemoryBlock>;
+
+    /** Returns the cached state for a file, reading it when not cached. */
+    State get (const File& file)
+    {
+        const auto key = file.getFullPathName();
+        {
+            const ScopedLock sl (lock);
+            auto iter = programs.find (key);
+            if (iter != programs.end())
+                return iter->second;
+        }
+
+        auto state = read (file);
+        const ScopedLock sl (lock);
+        return programs.emplace (key, state).first->second;
+    }
+
+    /** Read a file into the cache unless it is already there. */
+    void preload (const File& file, bool exists)
+    {
+        const auto key = file.getFullPathName();
+        {
+            const ScopedLock sl (lock);
+            if (programs.find (key) != programs.end())
+                return;
+        }
+
+        auto state = exists ? read (file) : std::make_shared<const MemoryBlock>();
+        const ScopedLock sl (lock);
+        programs.emplace (key, state);
+    }
+
+    void remove (const File& file)
+    {
+        const ScopedLock sl (lock);
+        programs.erase (file.getFullPathName());
+    }
+
+    File getDirectory()
+    {
+        const ScopedLock sl (lock);
+        return directory != File() ? directory : DataPath::defaultGlobalMidiProgramsDir();
+    }
+
+    void setDirectory (const File& newDirectory)
+    {
+        const ScopedLock sl (lock);
+        directory = newDirectory;
+    }
+
+private:
+    CriticalSection lock;
+    std::map<String, State> programs;
+    File directory;
+
+    static State read (const File& file)
+    {
+        if (file.existsAsFile())
+        {
+            const auto data = Node::parse (file).getProperty (tags::state).toString().trim();
+            if (data.isNotEmpty())
+                return StateCache::decode (data);
+        }
+        return std::make_shared<const MemoryBlock>();
+    }
+};
+
+static GlobalMidiPrograms& globalMidiPrograms()
+{
+    static GlobalMidiPrograms programs;
+    return programs;
+}
+
+} // namespace detail
+
+File Processor::getGlobalMidiProgramsDirectory()
+{
+    return detail::globalMidiPrograms().getDirectory();
+}
+
+void Processor::setGlobalMidiProgramsDirectory (const File& directory)
+{
+    detail::globalMidiPrograms().setDirectory (directory);
+}
+
+void Processor::preloadMidiPrograms()
+{
+    const auto firstFile = getMidiProgramFile (0);
+    if (firstFile == File())
+        return;
+
+    // list the directory once instead of probing all 128 program files.
+    Array<File> existing;
+    const auto prefix = firstFile.getFileName().upToLastOccurrenceOf ("_", true, false);
+    for (const auto& entry : RangedDirectoryIterator (firstFile.getParentDirectory(), false, prefix + "*.eln"))
+        existing.add (entry.getFile());
+
+    auto& programs = detail::globalMidiPrograms();
+    for (int program = 0; program < 128; ++program)
+    {
+        const auto file = getMidiProgramFile (program);
+        programs.preload (file, existing.contains (file));
+    }
+}
+
+void Processor::clearMidiProgramCache (int program)
+{
+    auto& programs = detail::globalMidiPrograms();
+    if (program >= 0)
+    {
+        programs.remove (getMidiProgramFile (program));
+        return;
+    }
+
+    for (int i = 0; i < 128; ++i)
+        programs.remove (getMidiProgramFile (i));
+}
+
+std::shared_ptr<const MemoryBlock> Processor::getGlobalMidiProgramState (int program)
+{
+    return detail::globalMidiPrograms().get (getMidiProgramFile (program));
+}
+
 void Processor::MidiProgramLoader::handleAsyncUpdate()
 {
-    const File programFile = node.getMidiProgramFile();
     const bool globalPrograms = node.useGlobalMidiPrograms();
     const auto requestedProgram = node.getMidiProgram();
 #if 0
@@ -495,25 +643,17 @@ void Processor::MidiProgramLoader::handleAsyncUpdate()
 
     if (globalPrograms)
     {
-        if (programFile.existsAsFile())
+        const auto state = node.getGlobalMidiProgramState (requestedProgram);
+        if (state->getSize() > 0)
         {
-            const auto programData = Node::parse (programFile);
-            auto data = programData.getProperty (tags::state).toString().trim();
-            if (data.isNotEmpty())
-            {
-                MemoryBlock state;
-                state.fromBase64Encoding (data);
-                if (state.getSize() > 0)
-                {
-                    node.lastMidiProgram.set (requestedProgram);
-                    node.setState (state.getData(), (int) state.getSize());
-                    DBG ("[element] loaded program: " << requestedProgram);
-                }
-            }
+            node.lastMidiProgram.set (requestedProgram);
+            node.setState (state->getData(), (int) state->getSize());
+            node.markStateChanged();
+            DBG ("[element] loaded program: " << requestedProgram);
         }
         else
         {
-            DBG ("[element] Program file doesn't exist: " << node.getMidiProgramFile().getFileName());
+            DBG ("[element] Program has no data: " << requestedProgram);
         }
     }
     else
@@ -522,6 +662,7 @@ void Processor::MidiProgramLoader::handleAsyncUpdate()
         {
             node.setState (program->state.getData(),
                            static_cast<int> (program->state.getSize()));
+            node.markStateChanged();
         }
         else
         {
@@ -599,10 +740,9 @@ void Processor::setMidiProgramsState (const String& state)
     midiPrograms.clearQuick (true);
     if (state.isEmpty())
         return;
-    MemoryBlock mb;
-    mb.fromBase64Encoding (state);
-    const ValueTree tree = (mb.getSize() > 0)
-                               ? ValueTree::readFromGZIPData (mb.getData(), mb.getSize())
+    const auto mb = StateCache::decode (state);
+    const ValueTree tree = (mb->getSize() > 0)
+                               ? ValueTree::readFromGZIPData (mb->getData(), mb->getSize())
                                : ValueTree();
 
     for (int i = 0; i < tree.getNumChildren(); ++i)
@@ -615,7 +755,7 @@ void Processor::setMidiProgramsState (const String& state)
         const auto state = data.getProperty (tags::state).toString().trim();
         if (state.isNotEmpty() && isPositiveAndBelow (program->program, 128))
         {
-            program->state.fromBase64Encoding (state);
+            program->state = *StateCache::decode (state);
             midiPrograms.add (program.release());
         }
     }
@@ -663,7 +803,11 @@ void Processor::setPorts (const PortList& newPorts)
     } sorter;
 
     newParams.sort (sorter, true);
+    for (auto* param : parameters)
+        param->removeListener (&stateTracker);
     parameters.swapWith (newParams);
+    for (auto* param : parameters)
+        param->addListener (&stateTracker);
     newParamsOut.sort (sorter, true);
     parametersOut.swapWith (newParamsOut);
 }
@@ -717,6 +861,11 @@ dsp::Oversampling<float>* Processor::getOversamplingProcessor()
 
 void Processor::setOversamplingFactor (int osFactor)
 {
+    // Root graphs are rendered directly by the engine and have no
+    // ProcessBufferOp to resample around them.
+    if (isRootGraph())
+        return;
+
     const auto newOsPow = (int) log2f ((float) osFactor);
 
     {
@@ -769,6 +918,18 @@ void Processor::setDelayCompensation (double delayMs)
     delayCompMillis = delayMs;
     jassert (sampleRate > 0.0);
     delayCompSamples = roundToInt (delayCompMillis * 0.001 * sampleRate);
+    if (auto* g = getParentGraph())
+        g->triggerLatencyUpdate();
+}
+
+//==============================================================================
+void Processor::setLiveMode (bool live)
+{
+    if (isLiveMode() == live)
+        return;
+    liveMode.set (live ? 1 : 0);
+    if (auto* g = getParentGraph())
+        g->triggerAsyncUpdate();
 }
 
 double Processor::getDelayCompensation() const { return delayCompMillis; }
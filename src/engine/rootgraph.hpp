@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "engine/graphnode.hpp"
 #include "engine/ionode.hpp"
 #include <element/devices.hpp>
@@ -67,6 +69,17 @@ public:
         midiProgram = program;
     }
 
+    /** Put the graph on standby.
+
+        Standby graphs stay prepared in the engine but are not rendered and
+        can't be selected by MIDI program changes. Preloaded set list
+        sessions use this so they can be swapped in without a rebuild.
+     */
+    inline void setStandby (bool shouldBeOnStandby) noexcept { standby.store (shouldBeOnStandby); }
+
+    /** Returns true if this graph is on standby. */
+    inline bool isStandby() const noexcept { return standby.load (std::memory_order_relaxed); }
+
     /** Returns the index used for rendering in the audio engine.
 
         If the return value is less than 0, it means the graph is not attached.
@@ -82,6 +95,7 @@ private:
     int midiProgram = -1;
     int engineIndex = -1;
     RenderMode renderMode = Parallel;
+    std::atomic<bool> standby { false };
 };
 
 } // namespace element
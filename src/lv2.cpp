@@ -1169,8 +1169,15 @@ public:
     LV2Processor* instantiate (const String& uri)
     {
         LV2Processor* proc = nullptr;
+        LV2Module* module = nullptr;
+        {
+            // only creating the module needs the world, the module takes
+            // the lock itself for the lilv parts of instantiate.
+            const ScopedLock sl (world->getLock());
+            module = world->createModule (uri);
+        }
 
-        if (LV2Module* module = world->createModule (uri))
+        if (module != nullptr)
         {
             Result res (module->instantiate (44100.0));
             if (res.wasOk())
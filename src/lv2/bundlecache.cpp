@@ -0,0 +1,198 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <element/datapath.hpp>
+
+#include "lv2/bundlecache.hpp"
+
+using namespace juce;
+
+#define EL_LV2_CACHE_VERSION 2
+
+namespace element {
+namespace detail {
+static StringArray getDefaultLV2Path()
+{
+    const auto home = File::getSpecialLocation (File::userHomeDirectory);
+    StringArray path;
+#if JUCE_WINDOWS
+    path.add (File::getSpecialLocation (File::userApplicationDataDirectory).getChildFile ("LV2").getFullPathName());
+    path.add (File::getSpecialLocation (File::globalApplicationsDirectory).getChildFile ("Common Files/LV2").getFullPathName());
+#elif JUCE_MAC
+    path.add (home.getChildFile (".lv2").getFullPathName());
+    path.add (home.getChildFile ("Library/Audio/Plug-Ins/LV2").getFullPathName());
+    path.add ("/Library/Audio/Plug-Ins/LV2");
+    path.add ("/usr/local/lib/lv2");
+    path.add ("/usr/lib/lv2");
+#else
+    path.add (home.getChildFile (".lv2").getFullPathName());
+    path.add ("/usr/local/lib/lv2");
+    path.add ("/usr/lib/lv2");
+#endif
+    return path;
+}
+} // namespace detail
+
+BundleCache::BundleCache (const File& f)
+    : file (f) {}
+
+BundleCache::~BundleCache() {}
+
+File BundleCache::getDefaultFile()
+{
+    return DataPath::applicationDataDir().getChildFile ("lv2cache.xml");
+}
+
+bool BundleCache::restore()
+{
+    bundles.clear();
+    plugins.clear();
+
+    auto xml = XmlDocument::parse (file);
+    if (xml == nullptr || ! xml->hasTagName ("lv2cache")
+        || xml->getIntAttribute ("version") != EL_LV2_CACHE_VERSION)
+        return false;
+
+    for (auto* const b : xml->getChildWithTagNameIterator ("bundle"))
+    {
+        auto& bundle = reset (b->getStringAttribute ("path"),
+                              b->getStringAttribute ("modified").getLargeIntValue());
+        for (auto* const p : b->getChildWithTagNameIterator ("plugin"))
+        {
+            addPlugin (bundle, { p->getStringAttribute ("uri"),
+                                 p->getStringAttribute ("name"),
+                                 p->getBoolAttribute ("supported") });
+        }
+    }
+
+    return true;
+}
+
+bool BundleCache::save() const
+{
+    XmlElement xml ("lv2cache");
+    xml.setAttribute ("version", EL_LV2_CACHE_VERSION);
+
+    for (const auto& bundle : bundles)
+    {
+        auto* const b = xml.createNewChildElement ("bundle");
+        b->setAttribute ("path", bundle->path);
+        b->setAttribute ("modified", String (bundle->modified));
+        for (const auto& plugin : bundle->plugins)
+        {
+            auto* const p = b->createNewChildElement ("plugin");
+            p->setAttribute ("uri", plugin.uri);
+            p->setAttribute ("name", plugin.name);
+            p->setAttribute ("supported", plugin.supported);
+        }
+    }
+
+    file.getParentDirectory().createDirectory();
+    return xml.writeTo (file);
+}
+
+BundleCache::Bundle* BundleCache::getBundle (const String& path) const
+{
+    for (const auto& bundle : bundles)
+        if (bundle->path == path)
+            return bundle.get();
+    return nullptr;
+}
+
+BundleCache::Bundle* BundleCache::getBundleForPlugin (const String& uri) const
+{
+    auto iter = plugins.find (uri);
+    return iter != plugins.end() ? iter->second : nullptr;
+}
+
+const BundleCache::Plugin* BundleCache::getPlugin (const String& uri) const
+{
+    if (auto* bundle = getBundleForPlugin (uri))
+        for (const auto& plugin : bundle->plugins)
+            if (plugin.uri == uri)
+                return &plugin;
+    return nullptr;
+}
+
+BundleCache::Bundle& BundleCache::reset (const String& path, int64 modified)
+{
+    auto* bundle = getBundle (path);
+    if (bundle == nullptr)
+    {
+        bundles.push_back (std::make_unique<Bundle>());
+        bundle = bundles.back().get();
+        bundle->path = path;
+    }
+
+    for (const auto& plugin : bundle->plugins)
+        plugins.erase (plugin.uri);
+
+    bundle->plugins.clear();
+    bundle->modified = modified;
+    bundle->loaded = false;
+    return *bundle;
+}
+
+void BundleCache::addPlugin (Bundle& bundle, const Plugin& plugin)
+{
+    bundle.plugins.push_back (plugin);
+    plugins[plugin.uri] = &bundle;
+}
+
+void BundleCache::retain (const StringArray& paths)
+{
+    for (auto iter = bundles.begin(); iter != bundles.end();)
+    {
+        if (paths.contains ((*iter)->path))
+        {
+            ++iter;
+            continue;
+        }
+
+        for (const auto& plugin : (*iter)->plugins)
+            plugins.erase (plugin.uri);
+        iter = bundles.erase (iter);
+    }
+}
+
+Array<File> BundleCache::findBundles()
+{
+    StringArray path;
+    const auto envPath = SystemStats::getEnvironmentVariable ("LV2_PATH", {});
+#if JUCE_WINDOWS
+    path.addTokens (envPath, ";", {});
+#else
+    path.addTokens (envPath, ":", {});
+#endif
+    path.trim();
+    path.removeEmptyStrings();
+    if (path.isEmpty())
+        path = detail::getDefaultLV2Path();
+    path.removeDuplicates (false);
+
+    Array<File> found;
+    for (const auto& dir : path)
+    {
+        for (const auto& entry : RangedDirectoryIterator (File (dir), false, "*", File::findDirectories))
+        {
+            const auto bundle = entry.getFile();
+            if (bundle.getChildFile ("manifest.ttl").existsAsFile())
+                found.add (bundle);
+        }
+    }
+
+    return found;
+}
+
+int64 BundleCache::getModificationTime (const File& bundle)
+{
+    // the directory changes when files are added or removed, the turtle
+    // files when a bundle is updated in place.  Plugin data usually lives
+    // in its own .ttl next to the manifest, so every one of them counts.
+    auto modified = bundle.getLastModificationTime().toMilliseconds();
+    for (const auto& entry : RangedDirectoryIterator (bundle, true, "*.ttl", File::findFiles))
+        modified = jmax (modified, entry.getModificationTime().toMilliseconds());
+    return modified;
+}
+
+} // namespace element
@@ -0,0 +1,92 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+/** On-disk record of the plugins found in each LV2 bundle.
+
+    Bundles are keyed by path and modification time. An unchanged bundle
+    can be skipped at startup and loaded only when one of its plugins is
+    actually requested.
+ */
+class BundleCache
+{
+public:
+    struct Plugin
+    {
+        juce::String uri;
+        juce::String name;
+        bool supported = false;
+    };
+
+    struct Bundle
+    {
+        juce::String path;
+        juce::int64 modified = 0;
+        bool loaded = false;
+        std::vector<Plugin> plugins;
+    };
+
+    explicit BundleCache (const juce::File& file);
+    ~BundleCache();
+
+    /** Read the cache file, returns false if it was missing or invalid. */
+    bool restore();
+
+    /** Write the cache file. */
+    bool save() const;
+
+    /** Returns the bundle for a path or nullptr. */
+    Bundle* getBundle (const juce::String& path) const;
+
+    /** Returns the bundle containing a plugin or nullptr. */
+    Bundle* getBundleForPlugin (const juce::String& uri) const;
+
+    /** Returns a cached plugin entry or nullptr. */
+    const Plugin* getPlugin (const juce::String& uri) const;
+
+    /** Forget a bundle's plugins and start a new entry for it. */
+    Bundle& reset (const juce::String& path, juce::int64 modified);
+
+    /** Add a plugin to a bundle entry. */
+    void addPlugin (Bundle& bundle, const Plugin& plugin);
+
+    /** Remove bundles whose paths are not in the list. */
+    void retain (const juce::StringArray& paths);
+
+    /** Call a function for every bundle. */
+    template <typename Fn>
+    void forEach (Fn&& fn) const
+    {
+        for (const auto& b : bundles)
+            fn (*b);
+    }
+
+    /** Returns the LV2 bundle directories found in LV2_PATH or the
+        platform's default locations. */
+    static juce::Array<juce::File> findBundles();
+
+    /** Returns the time used to detect changes to a bundle: the latest of
+        the directory's and every .ttl file's modification time. */
+    static juce::int64 getModificationTime (const juce::File& bundle);
+
+    /** Returns the default cache file. */
+    static juce::File getDefaultFile();
+
+private:
+    juce::File file;
+    std::vector<std::unique_ptr<Bundle>> bundles;
+    std::map<juce::String, Bundle*> plugins;
+
+    JUCE_DECLARE_NON_COPYABLE (BundleCache)
+};
+
+} // namespace element
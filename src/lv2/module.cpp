@@ -204,6 +204,34 @@ public:
         }
     }
 
+    /** Connect a port only if its location changed since the last call (realtime) */
+    inline void connect (uint32 port, void* data)
+    {
+        if (connected[port] == data)
+            return;
+        lilv_instance_connect_port (owner.instance, port, data);
+        connected[port] = data;
+    }
+
+    /** Connect every port to its current buffer and reset the cache */
+    void connectAll()
+    {
+        for (int i = 0; i < buffers.size(); ++i)
+        {
+            lilv_instance_connect_port (owner.instance, (uint32) i, buffers.getUnchecked (i)->getPortData());
+            connected[i] = buffers.getUnchecked (i)->getPortData();
+        }
+    }
+
+    /** Flag a control port for change detection after the next run (realtime) */
+    inline void markDirty (int port)
+    {
+        if (dirty[port])
+            return;
+        dirty[port] = true;
+        dirtyPorts.add (port);
+    }
+
     static const void* getPortValue (const char* port_symbol, void* user_data, uint32_t* size, uint32_t* type)
     {
         LV2Module::Private* priv = static_cast<LV2Module::Private*> (user_data);
@@ -279,10 +307,22 @@ private:
     HeapBlock<float> mins, maxes, defaults, current;
     OwnedArray<PortBuffer> buffers;
 
+    HeapBlock<void*> connected; ///< Last location given to each port
+    Array<int> controlOutputs, sequenceOutputs;
+    HeapBlock<bool> dirty;
+    Array<int> dirtyPorts; ///< Control inputs written by the UI this cycle
+    std::atomic<bool> notifying { true }; ///< False when nothing listens to port events
+    std::atomic<bool> controlValuesPending { false }; ///< State was restored off the message thread
+
     std::vector<LV2PatchInfo> patchParams;
     uint32_t atomControlInIndex { EL_INVALID_PORT };
     uint32_t atomControlOutIndex { EL_INVALID_PORT };
 
+    // queried once in init, these don't change for a plugin
+    String classLabel;
+    bool instrument = false;
+    uint32_t midiPorts[2] { EL_INVALID_PORT, EL_INVALID_PORT }; ///< output, input
+
     // UI -> Plugin
     lvtk::Messages<lvtk::MessageHeader, lvtk::RealtimeReadTrait> eventsIn;
     // Plugin -> UI
@@ -319,6 +359,9 @@ void LV2Module::init()
     priv->maxes.allocate (numPorts, true);
     priv->defaults.allocate (numPorts, true);
     priv->current.allocate (numPorts, true);
+    priv->connected.allocate (numPorts, true);
+    priv->dirty.allocate (numPorts, true);
+    priv->dirtyPorts.ensureStorageAllocated ((int) numPorts);
 
     lilv_plugin_get_port_ranges_float (plugin, priv->mins, priv->maxes, priv->defaults);
 
@@ -387,6 +430,11 @@ void LV2Module::init()
         if (type == PortType::Control)
             buf->setValue (priv->defaults[p]);
 
+        if (type == PortType::Control && ! isInput)
+            priv->controlOutputs.add ((int) p);
+        else if (type == PortType::Atom && ! isInput)
+            priv->sequenceOutputs.add ((int) p);
+
         if (type == PortType::Atom && isInput)
         {
             if (lilv_port_supports_event (plugin, port, timeNode))
@@ -423,8 +471,26 @@ void LV2Module::init()
         lilv_node_free (node);
     }
 
+    // plugin class
+    if (const LilvPluginClass* klass = lilv_plugin_get_class (plugin))
+    {
+        if (const LilvNode* node = lilv_plugin_class_get_label (klass))
+            priv->classLabel = CharPointer_UTF8 (lilv_node_as_string (node));
+
+        auto curi = lilv_plugin_class_get_uri (klass);
+        auto lv2_InstrumentPlugin = world.makeURI (LV2_CORE__InstrumentPlugin);
+        auto lv2_GeneratorPlugin = world.makeURI (LV2_CORE__GeneratorPlugin);
+        // clang-format off
+        priv->instrument = lilv_node_equals (curi, lv2_InstrumentPlugin) || 
+            lilv_node_equals (curi, lv2_GeneratorPlugin);
+        // clang-format on
+    }
+
     priv->patchParams = detail::getPatchWritables (*this, world, plugin);
 
+    priv->midiPorts[1] = detail::findMidiPort (world, plugin, true);
+    priv->midiPorts[0] = detail::findMidiPort (world, plugin, false);
+
     priv->atomControlInIndex = getAtomControlIndex();
     if (priv->atomControlInIndex == EL_INVALID_PORT)
         priv->atomControlInIndex = getMidiPort (true);
@@ -444,17 +510,29 @@ void LV2Module::loadDefaultState()
         return;
 
     auto* const map = (LV2_URID_Map*) world.getFeatures().getFeature (LV2_URID__map)->getFeature()->data;
-    if (auto* uriNode = lilv_new_uri (world.getWorld(), priv->uri.toRawUTF8()))
+    LilvState* state = nullptr;
+    {
+        const ScopedLock sl (world.getLock());
+        if (auto* uriNode = lilv_new_uri (world.getWorld(), priv->uri.toRawUTF8()))
+        {
+            state = lilv_state_new_from_world (world.getWorld(), map, uriNode);
+            lilv_node_free (uriNode);
+        }
+    }
+
+    if (state != nullptr)
     {
-        if (auto* state = lilv_state_new_from_world (world.getWorld(), map, uriNode))
+        const LV2_Feature* const features[] = { nullptr };
+        lilv_state_restore (state, instance, Private::setPortValue, priv.get(), LV2_STATE_IS_POD, features);
         {
-            const LV2_Feature* const features[] = { nullptr };
-            lilv_state_restore (state, instance, Private::setPortValue, priv.get(), LV2_STATE_IS_POD, features);
+            const ScopedLock sl (world.getLock());
             lilv_state_free (state);
-            priv->sendControlValues();
         }
 
-        lilv_node_free (uriNode);
+        if (MessageManager::getInstance()->isThisTheMessageThread())
+            priv->sendControlValues();
+        else
+            priv->controlValuesPending.store (true);
     }
 }
 
@@ -491,12 +569,28 @@ void LV2Module::setStateString (const String& stateStr)
     auto* const map = (LV2_URID_Map*) world.getFeatures().getFeature (LV2_URID__map)->getFeature()->data;
     auto* const unmap = (LV2_URID_Unmap*) world.getFeatures().getFeature (LV2_URID__unmap)->getFeature()->data;
     lvtk::ignore (unmap);
-    if (auto* state = lilv_state_new_from_string (world.getWorld(), map, stateStr.toRawUTF8()))
+
+    LilvState* state = nullptr;
+    {
+        const ScopedLock sl (world.getLock());
+        state = lilv_state_new_from_string (world.getWorld(), map, stateStr.toRawUTF8());
+    }
+
+    if (state != nullptr)
     {
         const LV2_Feature* const features[] = { nullptr };
         lilv_state_restore (state, instance, Private::setPortValue, priv.get(), LV2_STATE_IS_POD, features);
-        lilv_state_free (state);
-        priv->sendControlValues();
+        {
+            const ScopedLock sl (world.getLock());
+            lilv_state_free (state);
+        }
+
+        // graphs restore plugin state concurrently while loading, listeners
+        // expect port events on the message thread.
+        if (MessageManager::getInstance()->isThisTheMessageThread())
+            priv->sendControlValues();
+        else
+            priv->controlValuesPending.store (true);
     }
 }
 
@@ -506,25 +600,40 @@ Result LV2Module::instantiate (double samplerate)
     jassert (instance == nullptr);
     currentSampleRate = samplerate;
 
-    features.clearQuick();
-    world.getFeatures (features);
-
-    // check for a worker interface
-    LilvNodes* nodes = lilv_plugin_get_extension_data (plugin);
-    LILV_FOREACH (nodes, iter, nodes)
+    // the lilv world isn't thread safe, but the plugin's own instantiate is
+    // where the time goes.  The lilv queries hold the world's lock, the
+    // instantiate itself only the lock for lilv's library list.
     {
-        const LilvNode* node = lilv_nodes_get (nodes, iter);
-        if (lilv_node_equals (node, world.work_interface))
+        const ScopedLock sl (world.getLock());
+        features.clearQuick();
+        world.getFeatures (features);
+
+        // check for a worker interface
+        LilvNodes* nodes = lilv_plugin_get_extension_data (plugin);
+        LILV_FOREACH (nodes, iter, nodes)
         {
-            worker = std::make_unique<WorkerFeature> (world.getWorkThread(), 1);
-            features.add (worker->getFeature());
+            const LilvNode* node = lilv_nodes_get (nodes, iter);
+            if (lilv_node_equals (node, world.work_interface))
+            {
+                worker = std::make_unique<WorkerFeature> (world.getWorkerPool(), 1);
+                features.add (worker->getFeature());
+            }
         }
+        lilv_nodes_free (nodes);
+        nodes = nullptr;
+
+        // loads the plugin's data if it wasn't already, so instantiating
+        // below only reads it.
+        lilv_plugin_get_library_uri (plugin);
+        lilv_plugin_get_bundle_uri (plugin);
     }
-    lilv_nodes_free (nodes);
-    nodes = nullptr;
 
     features.add (nullptr);
-    instance = lilv_plugin_instantiate (plugin, samplerate, features.getRawDataPointer());
+    {
+        const ScopedLock sl (world.getInstanceLock());
+        instance = lilv_plugin_instantiate (plugin, samplerate, features.getRawDataPointer());
+    }
+
     if (instance == nullptr)
     {
         features.clearQuick();
@@ -546,6 +655,7 @@ Result LV2Module::instantiate (double samplerate)
         worker = nullptr;
     }
 
+    priv->connectAll();
     loadDefaultState();
     startTimerHz (60);
     return Result::ok();
@@ -591,6 +701,8 @@ void LV2Module::freeInstance()
         worker = nullptr;
         auto* oldInstance = instance;
         instance = nullptr;
+
+        const ScopedLock sl (world.getInstanceLock());
         lilv_instance_free (oldInstance);
     }
 }
@@ -624,41 +736,21 @@ void LV2Module::connectChannel (const PortType type, const int32 channel, void*
 
 void LV2Module::connectPort (uint32 port, void* data)
 {
-    lilv_instance_connect_port (instance, port, data);
+    priv->connect (port, data);
 }
 
 String LV2Module::getURI() const { return priv->uri; }
 String LV2Module::getName() const { return priv->name; }
 String LV2Module::getAuthorName() const { return priv->author; }
 
-bool LV2Module::isInstrument() const noexcept
-{
-    if (auto c = lilv_plugin_get_class (plugin))
-    {
-        auto curi = lilv_plugin_class_get_uri (c);
-        auto lv2_InstrumentPlugin = world.makeURI (LV2_CORE__InstrumentPlugin);
-        auto lv2_GeneratorPlugin = world.makeURI (LV2_CORE__GeneratorPlugin);
-        // clang-format off
-        return lilv_node_equals (curi, lv2_InstrumentPlugin) || 
-            lilv_node_equals (curi, lv2_GeneratorPlugin);
-        // clang-format on
-    }
-
-    return false;
-}
+bool LV2Module::isInstrument() const noexcept { return priv->instrument; }
 
 const ChannelConfig& LV2Module::getChannelConfig() const
 {
     return priv->channels;
 }
 
-String LV2Module::getClassLabel() const
-{
-    if (const LilvPluginClass* klass = lilv_plugin_get_class (plugin))
-        if (const LilvNode* node = lilv_plugin_class_get_label (klass))
-            return CharPointer_UTF8 (lilv_node_as_string (node));
-    return String();
-}
+String LV2Module::getClassLabel() const { return priv->classLabel; }
 
 const void* LV2Module::getExtensionData (const String& uri) const
 {
@@ -719,7 +811,7 @@ uint32 LV2Module::getAtomControlIndex() const noexcept
 
 uint32 LV2Module::getMidiPort (bool input) const
 {
-    return detail::findMidiPort (world, plugin, input);
+    return priv->midiPorts[input ? 1 : 0];
 }
 
 const LV2Patches& LV2Module::getPatches() const noexcept { return priv->patchParams; }
@@ -978,6 +1070,11 @@ bool LV2Module::isPortOutput (uint32 index) const
 
 void LV2Module::timerCallback()
 {
+    priv->notifying.store (priv->ui != nullptr || onPortNotify != nullptr, std::memory_order_relaxed);
+
+    if (priv->controlValuesPending.exchange (false))
+        priv->sendControlValues();
+
     priv->eventsOut.read_all ([this] (lvtk::MessageHeader header, uint32_t size, const void* data) {
         if (header.protocol == 0 || header.protocol == priv->atom_eventTransfer)
         {
@@ -1021,49 +1118,34 @@ void LV2Module::timerCallback()
 
 void LV2Module::referBuffers (RenderContext& rc)
 {
+    auto refer = [this] (PortType type, int channel, bool isInput, void* location) {
+        const auto port = priv->channels.getPort (type, channel, isInput);
+        auto* const buffer = priv->buffers.getUnchecked ((int) port);
+        buffer->referTo (location);
+        priv->connect (port, buffer->getPortData());
+    };
+
     // Audio
     for (int c = 0; c < priv->channels.getNumAudioInputs(); ++c)
-        priv->buffers.getUnchecked ((int) priv->channels.getPort (
-                                        PortType::Audio, c, true))
-            ->referTo (rc.audio.getWritePointer (c));
-
+        refer (PortType::Audio, c, true, rc.audio.getWritePointer (c));
     for (int c = 0; c < priv->channels.getNumAudioOutputs(); ++c)
-        priv->buffers.getUnchecked ((int) priv->channels.getPort (
-                                        PortType::Audio, c, false))
-            ->referTo (rc.audio.getWritePointer (c));
+        refer (PortType::Audio, c, false, rc.audio.getWritePointer (c));
 
     // CV
     for (int c = 0; c < priv->channels.getNumCVInputs(); ++c)
-        priv->buffers.getUnchecked ((int) priv->channels.getPort (
-                                        PortType::CV, c, true))
-            ->referTo (rc.cv.getWritePointer (c));
-
+        refer (PortType::CV, c, true, rc.cv.getWritePointer (c));
     for (int c = 0; c < priv->channels.getNumCVOutputs(); ++c)
-        priv->buffers.getUnchecked ((int) priv->channels.getPort (
-                                        PortType::CV, c, false))
-            ->referTo (rc.cv.getWritePointer (c));
+        refer (PortType::CV, c, false, rc.cv.getWritePointer (c));
 
     // Atom
     for (int c = 0; c < std::min (rc.atom.size(), priv->channels.getNumAtomInputs()); ++c)
-        priv->buffers.getUnchecked ((int) priv->channels.getPort (
-                                        PortType::Atom, c, true))
-            ->referTo (rc.atom.writeBuffer (c)->data());
-
-    // for (int c = 0; c < std::min (rc.atom.size(), priv->channels.getNumAtomOutputs()); ++c)
-    //     priv->buffers.getUnchecked ((int) priv->channels.getPort (
-    //                                     PortType::Atom, c, false))
-    //         ->referTo (nullptr);
-
-    for (int i = priv->buffers.size(); --i >= 0;)
-    {
-        auto buffer = priv->buffers.getUnchecked (i);
-        if (buffer->isSequence() && ! buffer->isInput())
-            buffer->reset();
-        else if (buffer->isControl())
-            priv->current[i] = buffer->getValue();
+        refer (PortType::Atom, c, true, rc.atom.writeBuffer (c)->data());
 
-        lilv_instance_connect_port (instance, static_cast<uint32_t> (i), buffer->getPortData());
-    }
+    // Control and sequence outputs keep their own storage, so they stay connected.
+    for (const auto port : priv->sequenceOutputs)
+        priv->buffers.getUnchecked (port)->reset();
+    for (const auto port : priv->controlOutputs)
+        priv->current[port] = priv->buffers.getUnchecked (port)->getValue();
 }
 
 void LV2Module::processEvents()
@@ -1076,6 +1158,12 @@ void LV2Module::processEvents()
             if (auto* buffer = index < priv->buffers.size() ? priv->buffers.getUnchecked (index) : nullptr)
             {
                 const auto value = juce::readUnaligned<float> (data);
+                if (buffer->isControl())
+                {
+                    if (! priv->dirty[index])
+                        priv->current[index] = buffer->getValue();
+                    priv->markDirty (index);
+                }
                 if (buffer->getValue() != value)
                     buffer->setValue (value);
             }
@@ -1113,16 +1201,30 @@ void LV2Module::run (uint32 nframes)
     if (worker)
         worker->endRun();
 
-    for (int i = priv->buffers.size(); --i >= 0;)
+    auto notify = [this] (int port) {
+        auto* const buffer = priv->buffers.getUnchecked (port);
+        if (priv->current[port] == buffer->getValue())
+            return;
+        priv->current[port] = buffer->getValue();
+        lvtk::MessageHeader header = { static_cast<uint32_t> (port), 0 };
+        priv->eventsOut.push_message (header, sizeof (float), &priv->current[port]);
+    };
+
+    const bool notifying = priv->notifying.load (std::memory_order_relaxed);
+
+    for (const auto port : priv->dirtyPorts)
     {
-        auto buffer = priv->buffers.getUnchecked (i);
-        if (buffer->isControl() && priv->current[i] != buffer->getValue())
-        {
-            priv->current[i] = buffer->getValue();
-            lvtk::MessageHeader header = { static_cast<uint32_t> (i), 0 };
-            priv->eventsOut.push_message (header, sizeof (float), &priv->current[i]);
-        }
+        priv->dirty[port] = false;
+        if (notifying)
+            notify (port);
     }
+    priv->dirtyPorts.clearQuick();
+
+    if (! notifying)
+        return;
+
+    for (const auto port : priv->controlOutputs)
+        notify (port);
 
     if (priv->atomControlOutIndex != EL_INVALID_PORT)
     {
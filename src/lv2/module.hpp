@@ -278,6 +278,7 @@ public:
     void run (uint32 nframes);
 
     /** Connect a port to a data location (realtime)
+        The plugin is only called if the location differs from the last one.
         @param port The port index to connect
         @param data A pointer to the port buffer that should be used
       */
@@ -290,7 +291,8 @@ public:
     void connectChannel (const PortType type, const int32 channel, void* data, const bool isInput);
 
     /** Connect an audio buffer setup for in place processing (realtime)
-        
+        Only ports whose location changed since the last block are reconnected.
+
         @param rc The rendering connext to refer to.
     */
     void referBuffers (RenderContext& rc);
@@ -17,160 +17,239 @@ using namespace juce;
 
 namespace element {
 
-WorkThread::WorkThread (const String& name, uint32_t bufsize, Thread::Priority priority)
-    : Thread (name)
+class WorkerPool::Runner : public Thread
 {
-    nextWorkId = 0;
-    bufferSize = (uint32_t) nextPowerOfTwo (bufsize);
-    requests = std::make_unique<RingBuffer> (bufferSize);
-    startThread (priority);
+public:
+    Runner (WorkerPool& p, const String& name)
+        : Thread (name), pool (p)
+    {
+        ready.ensureStorageAllocated (32);
+    }
+
+    ~Runner()
+    {
+        signalThreadShouldExit();
+        wakeup.signal();
+        stopThread (500);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (auto* worker = pool.claimNext (*this))
+            {
+                busy = true;
+                pool.process (*worker, *this);
+                busy = false;
+                continue;
+            }
+
+            wakeup.wait (-1);
+        }
+
+        buffer.free();
+    }
+
+    WorkerPool& pool;
+    WaitableEvent wakeup;
+    SpinLock readyLock;
+    Array<WorkerBase*> ready;
+    std::atomic<bool> busy { false };
+
+    HeapBlock<uint8> buffer;
+    uint32_t bufferSize = 0;
+};
+
+//==============================================================================
+WorkerPool::WorkerPool (const String& name, int numThreads, uint32_t bufsize, Thread::Priority priority)
+{
+    bufferSize = (uint32_t) nextPowerOfTwo ((int) bufsize);
+    numThreads = jmax (1, numThreads);
+    for (int i = 0; i < numThreads; ++i)
+        threads.add (new Runner (*this, name + " " + String (i + 1)));
+    for (auto* thread : threads)
+        thread->startThread (priority);
 }
 
-WorkThread::~WorkThread()
+WorkerPool::~WorkerPool()
 {
-    doExit = true;
-    signalThreadShouldExit();
-    notify();
-    waitForThreadToExit (100);
-    requests = nullptr;
+    jassert (numWorkers == 0);
+    threads.clear();
 }
 
-WorkerBase* WorkThread::getWorker (uint32_t workerId) const
+int WorkerPool::getDefaultNumThreads()
 {
-    if (workerId == 0)
-        return nullptr;
+    return jlimit (1, 8, SystemStats::getNumCpus() / 2);
+}
 
-    for (int i = 0; i < workers.size(); ++i)
-        if (workers.getUnchecked (i)->workId == workerId)
-            return workers.getUnchecked (i);
+void WorkerPool::addWorker (WorkerBase* worker)
+{
+    ScopedLock sl (lock);
+    worker->requests = std::make_unique<RingBuffer> ((int32) bufferSize);
+    worker->home = nextHome;
+    nextHome = (nextHome + 1) % threads.size();
+    ++numWorkers;
+
+    // a worker is only ever in one ready list, so this many slots
+    // means enqueue never allocates.
+    for (auto* thread : threads)
+    {
+        const SpinLock::ScopedLockType rl (thread->readyLock);
+        thread->ready.ensureStorageAllocated (numWorkers);
+    }
 
-    return nullptr;
+    WORKER_LOG ("registered worker on thread " + String (worker->home + 1));
 }
 
-void WorkThread::addWorker (WorkerBase* worker)
+void WorkerPool::removeWorker (WorkerBase* worker)
 {
-    worker->workId = ++nextWorkId;
-    WORKER_LOG (getThreadName() + " registering worker: " + String (worker->workId));
-    workers.addIfNotAlreadyThere (worker);
+    {
+        ScopedLock sl (lock);
+        --numWorkers;
+    }
+
+    for (auto* thread : threads)
+    {
+        const SpinLock::ScopedLockType rl (thread->readyLock);
+        thread->ready.removeFirstMatchingValue (worker);
+    }
+
+    // wait for a thread that already claimed it.
+    while (worker->isWorking())
+        Thread::sleep (1);
+
+    worker->queued = false;
+    WORKER_LOG ("removed worker");
 }
 
-void WorkThread::removeWorker (WorkerBase* worker)
+bool WorkerPool::scheduleWork (WorkerBase* worker, uint32_t size, const void* data)
 {
-    WORKER_LOG (getThreadName() + " removing worker: " + String (worker->workId));
-    workers.removeFirstMatchingValue (worker);
-    worker->workId = 0;
+    jassert (size > 0 && worker && worker->requests != nullptr);
+    auto& requests = *worker->requests;
+    if (! requests.canWrite (getRequiredSpace (size)))
+        return false;
+
+    if (requests.write (&size, sizeof (size)) < sizeof (size))
+        return false;
+
+    if (requests.write (data, size) < size)
+        return false;
+
+    if (! worker->queued.exchange (true))
+        enqueue (*worker);
+
+    return true;
 }
 
-void WorkThread::run()
+void WorkerPool::enqueue (WorkerBase& worker)
 {
-    HeapBlock<uint8> buffer;
-    int32 readBufferSize = 0;
+    auto* const home = threads.getUnchecked (worker.home);
 
-    while (true)
     {
-        this->wait (-1);
-
-        if (doExit || threadShouldExit())
-            break;
-
-        while (! validateMessage (*requests))
-            Thread::sleep (6);
+        const SpinLock::ScopedLockType rl (home->readyLock);
+        home->ready.add (&worker);
+    }
 
-        if (doExit || threadShouldExit())
-            break;
+    wake (*home);
+}
 
-        uint32_t size = 0;
-        if (requests->read (&size, sizeof (size)) < sizeof (size))
-        {
-            WORKER_LOG ("error reading request: message size");
-            continue;
-        }
+void WorkerPool::wake (Runner& home)
+{
+    home.wakeup.signal();
 
-        uint32_t workId;
-        if (requests->read (&workId, sizeof (workId)) < sizeof (workId))
+    // if the home thread is stuck on a long job, wake someone to steal this.
+    if (home.busy)
+    {
+        for (auto* thread : threads)
         {
-            WORKER_LOG ("error reading request: worker id");
-            continue;
+            if (! thread->busy)
+            {
+                thread->wakeup.signal();
+                break;
+            }
         }
+    }
+}
 
-        if (workId == 0)
-            continue;
+WorkerBase* WorkerPool::claimNext (Runner& thread)
+{
+    const int start = threads.indexOf (&thread);
 
-        if (size > static_cast<uint32_t> (readBufferSize))
-        {
-            readBufferSize = nextPowerOfTwo (size);
-            buffer.realloc (readBufferSize);
-        }
+    for (int i = 0; i < threads.size(); ++i)
+    {
+        auto* const victim = threads.getUnchecked ((start + i) % threads.size());
+        const SpinLock::ScopedLockType rl (victim->readyLock);
 
-        if (requests->read (buffer.getData(), size) < size)
+        for (int j = 0; j < victim->ready.size(); ++j)
         {
-            WORKER_LOG ("error reading request: message body");
-            continue;
-        }
+            auto* const worker = victim->ready.getUnchecked (j);
 
-        {
-            if (WorkerBase* const worker = getWorker (workId))
+            // skip workers still finishing up on another thread.
+            if (worker->flag.setWorking (true))
             {
-                while (! worker->flag.setWorking (true))
-                {
-                }
-                worker->processRequest (size, buffer.getData());
-                while (! worker->flag.setWorking (false))
-                {
-                }
+                victim->ready.remove (j);
+                return worker;
             }
         }
-
-        if (threadShouldExit() || doExit)
-            break;
     }
 
-    buffer.free();
+    return nullptr;
 }
 
-bool WorkThread::scheduleWork (WorkerBase* worker, uint32_t size, const void* data)
+void WorkerPool::process (WorkerBase& worker, Runner& thread)
 {
-    jassert (size > 0 && worker && worker->workId != 0);
-    if (! requests->canWrite (getRequiredSpace (size)))
-        return false;
+    auto& requests = *worker.requests;
 
-    if (requests->write (&size, sizeof (size)) < sizeof (uint32_t))
-        return false;
+    for (;;)
+    {
+        while (WorkerBase::validateMessage (requests))
+        {
+            uint32_t size = 0;
+            requests.read (&size, sizeof (size));
 
-    if (requests->write (&worker->workId, sizeof (worker->workId)) < sizeof (worker->workId))
-        return false;
+            if (size > thread.bufferSize)
+            {
+                thread.bufferSize = (uint32_t) nextPowerOfTwo ((int) size);
+                thread.buffer.realloc (thread.bufferSize);
+            }
 
-    if (requests->write (data, size) < size)
-        return false;
+            if (requests.read (thread.buffer.getData(), size) < size)
+            {
+                WORKER_LOG ("error reading request: message body");
+                break;
+            }
 
-    notify();
-    return true;
-}
+            worker.processRequest (size, thread.buffer.getData());
+        }
 
-bool WorkThread::validateMessage (RingBuffer& ring)
-{
-    uint32_t size = 0;
-    ring.peak (&size, sizeof (size));
-    return ring.canRead (getRequiredSpace (size));
+        // anything written after this point queues the worker again.
+        worker.queued = false;
+        if (! WorkerBase::validateMessage (requests) || worker.queued.exchange (true))
+            break;
+    }
+
+    worker.flag.setWorking (false);
+
+    // it was queued again while we finished, make sure someone picks it up.
+    if (worker.queued)
+        wake (*threads.getUnchecked (worker.home));
 }
 
-WorkerBase::WorkerBase (WorkThread& thread, uint32_t bufsize)
-    : owner (thread)
+//==============================================================================
+WorkerBase::WorkerBase (WorkerPool& pool, uint32_t bufsize)
+    : owner (pool)
 {
     bufsize = juce::nextPowerOfTwo (bufsize);
     responses = std::make_unique<RingBuffer> (bufsize);
     response.calloc (bufsize);
-    thread.addWorker (this);
+    pool.addWorker (this);
 }
 
 WorkerBase::~WorkerBase()
 {
-    while (flag.isWorking())
-    {
-        Thread::sleep (100);
-    }
-
     owner.removeWorker (this);
+    requests = nullptr;
     responses = nullptr;
     response.free();
 }
@@ -216,6 +295,8 @@ bool WorkerBase::validateMessage (RingBuffer& ring)
 {
     // the worker only validates message size
     uint32_t size = 0;
+    if (ring.getReadSpace() < sizeof (size))
+        return false;
     ring.peak (&size, sizeof (size));
     return ring.canRead (size + sizeof (size));
 }
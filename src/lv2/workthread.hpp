@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 #include <element/juce/core.hpp>
@@ -13,17 +14,28 @@ namespace element {
 
 class WorkerBase;
 
-/** A worker thread
+/** A pool of worker threads
     Capable of scheduling non-realtime work from a realtime context.
+
+    Every worker has its own request queue, written by the realtime thread
+    and read by whichever pool thread picks the worker up. Workers are given
+    a home thread, and idle threads steal queued workers from busy ones, so
+    one slow request doesn't hold up every other plugin.
  */
-class WorkThread : public juce::Thread
+class WorkerPool
 {
 public:
     using Priority = juce::Thread::Priority;
-    WorkThread (const juce::String& name, uint32_t bufsize, Priority priority = Priority::normal);
-    ~WorkThread();
+    WorkerPool (const juce::String& name, int numThreads, uint32_t bufsize, Priority priority = Priority::normal);
+    ~WorkerPool();
+
+    /** Returns the number of threads in the pool. */
+    int getNumThreads() const noexcept { return threads.size(); }
 
-    inline static uint32_t getRequiredSpace (uint32_t msgSize) { return msgSize + (2 * sizeof (uint32_t)); }
+    /** Returns a thread count suited to this machine. */
+    static int getDefaultNumThreads();
+
+    inline static uint32_t getRequiredSpace (uint32_t msgSize) { return msgSize + sizeof (uint32_t); }
 
 protected:
     friend class WorkerBase;
@@ -39,21 +51,24 @@ protected:
     bool scheduleWork (WorkerBase* worker, uint32_t size, const void* data);
 
 private:
+    class Runner;
+    juce::OwnedArray<Runner> threads;
     uint32_t bufferSize;
+    juce::CriticalSection lock;
+    int numWorkers = 0;
+    int nextHome = 0;
 
-    WorkerBase* getWorker (uint32_t workerId) const;
-    juce::Array<WorkerBase*, juce::CriticalSection> workers;
-
-    uint32_t nextWorkId;
-    bool doExit = false;
+    /** @internal Queue a worker on its home thread (realtime thread) */
+    void enqueue (WorkerBase& worker);
 
-    std::unique_ptr<RingBuffer> requests; ///< requests to process
+    /** @internal Wake a worker's home thread, and an idle one if home is busy */
+    void wake (Runner& home);
 
-    /** @internal Validate a ringbuffer for message completeness */
-    bool validateMessage (RingBuffer& ring);
+    /** @internal Claim a queued worker, stealing from other threads if needed */
+    WorkerBase* claimNext (Runner& thread);
 
-    /** @internal The work thread function */
-    void run();
+    /** @internal Run all complete requests of a claimed worker */
+    void process (WorkerBase& worker, Runner& thread);
 };
 
 /** A flag that indicates whether work is happening or not */
@@ -66,16 +81,16 @@ public:
 private:
     juce::Atomic<int32> flag;
     inline bool setWorking (bool status) { return flag.compareAndSetBool (status ? 1 : 0, status ? 0 : 1); }
-    friend class WorkThread;
+    friend class WorkerPool;
 };
 
 class WorkerBase
 {
 public:
     /** Create a new Worker
-        @param thread The WorkThread to use when scheduling
+        @param pool The WorkerPool to use when scheduling
         @param bufsize Size to use for internal response buffers */
-    WorkerBase (WorkThread& thread, uint32_t bufsize);
+    WorkerBase (WorkerPool& pool, uint32_t bufsize);
     virtual ~WorkerBase();
 
     /** Returns true if the worker is currently working */
@@ -107,16 +122,18 @@ protected:
     virtual void processResponse (uint32_t size, const void* data) = 0;
 
 private:
-    WorkThread& owner;
-    uint32_t workId; ///< The thread assigned id for this worker
+    WorkerPool& owner;
+    int home = 0; ///< The pool thread this worker is queued on
     WorkFlag flag; ///< A flag for when work is being processed
+    std::atomic<bool> queued { false }; ///< True while waiting in a ready list
 
+    std::unique_ptr<RingBuffer> requests; ///< requests from the realtime thread
     std::unique_ptr<RingBuffer> responses; ///< responses from work
     juce::HeapBlock<uint8_t> response; ///< buffer to write a response
 
-    bool validateMessage (RingBuffer& ring);
+    static bool validateMessage (RingBuffer& ring);
 
-    friend class WorkThread;
+    friend class WorkerPool;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerBase)
 };
 
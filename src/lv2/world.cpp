@@ -11,14 +11,19 @@
 #include <lvtk/ext/bufsize.hpp>
 #include <lvtk/ext/state.hpp>
 
+#include "lv2/bundlecache.hpp"
 #include "lv2/lv2features.hpp"
 #include "lv2/module.hpp"
 #include "lv2/workerfeature.hpp"
 #include "lv2/world.hpp"
 #include "lv2/logfeature.hpp"
 
+#ifndef EL_LV2_USE_CACHE
+#define EL_LV2_USE_CACHE 1
+#endif
+
 #ifndef EL_LV2_NUM_WORKERS
-#define EL_LV2_NUM_WORKERS 1
+#define EL_LV2_NUM_WORKERS 0 // 0 = size to the machine
 #endif
 
 namespace element {
@@ -157,7 +162,6 @@ World::World (SymbolMap& s)
 
     lilv_world_set_option (world, LILV_OPTION_DYN_MANIFEST, trueNode);
 
-    lilv_world_load_all (world);
 #if JLV2_SUIL_INIT
     suil_init (nullptr, nullptr, SUIL_ARG_NONE);
 #endif
@@ -167,18 +171,109 @@ World::World (SymbolMap& s)
                           LV2ModuleUI::portUnsubscribe);
     suil_host_set_touch_func (suil, LV2ModuleUI::touch);
 
-    currentThread = 0;
-    numThreads = EL_LV2_NUM_WORKERS;
-    for (int i = 0; i < numThreads; ++i)
-    {
-        threads.add (new WorkThread ("lv2_worker_" + String (i + 1), EL_LV2_RING_BUFFER_SIZE));
-    }
+    const int numWorkers = EL_LV2_NUM_WORKERS > 0 ? EL_LV2_NUM_WORKERS
+                                                  : WorkerPool::getDefaultNumThreads();
+    workers = std::make_unique<WorkerPool> ("LV2 Worker", numWorkers, EL_LV2_RING_BUFFER_SIZE);
 
     addFeature (new GenericFeature (*symbolMap.mapFeature()), false);
     addFeature (new GenericFeature (*symbolMap.unmapFeature()), false);
     addFeature (new LogFeature(), false);
     addFeature (new OptionsFeature (symbolMap), false);
     addFeature (new BoundedBlockLengthFeature(), true);
+
+    // plugin support depends on the features above
+    loadBundles();
+}
+
+void World::loadBundles()
+{
+#if EL_LV2_USE_CACHE
+    const ScopedLock sl (lock);
+    cache = std::make_unique<BundleCache> (BundleCache::getDefaultFile());
+    cache->restore();
+
+    StringArray paths;
+    Array<BundleCache::Bundle*> scanned;
+
+    for (const auto& dir : BundleCache::findBundles())
+    {
+        const auto path = dir.getFullPathName();
+        const auto modified = BundleCache::getModificationTime (dir);
+        paths.add (path);
+
+        auto* bundle = cache->getBundle (path);
+        if (bundle != nullptr && bundle->modified == modified)
+        {
+            // plugin bundles wait until a plugin is requested. everything
+            // else (specs, presets, extensions) is needed up front.
+            if (! bundle->plugins.empty())
+                continue;
+        }
+        else
+        {
+            bundle = &cache->reset (path, modified);
+            scanned.add (bundle);
+        }
+
+        loadBundle (*bundle);
+    }
+
+    cache->retain (paths);
+    lilv_world_load_specifications (world);
+    lilv_world_load_plugin_classes (world);
+
+    if (scanned.isEmpty())
+        return;
+
+    const LilvPlugins* plugins (lilv_world_get_all_plugins (world));
+    LILV_FOREACH (plugins, iter, plugins)
+    {
+        const LilvPlugin* plugin = lilv_plugins_get (plugins, iter);
+        auto* bundlePath = lilv_file_uri_parse (lilv_node_as_uri (lilv_plugin_get_bundle_uri (plugin)), nullptr);
+        auto* bundle = cache->getBundle (File (CharPointer_UTF8 (bundlePath)).getFullPathName());
+        lilv_free (bundlePath);
+
+        if (bundle == nullptr || ! scanned.contains (bundle))
+            continue;
+
+        BundleCache::Plugin info;
+        info.uri = String::fromUTF8 (lilv_node_as_uri (lilv_plugin_get_uri (plugin)));
+        if (auto* nameNode = lilv_plugin_get_name (plugin))
+        {
+            info.name = String::fromUTF8 (lilv_node_as_string (nameNode));
+            lilv_node_free (nameNode);
+        }
+        info.supported = isPluginSupported (plugin);
+        cache->addPlugin (*bundle, info);
+    }
+
+    DBG ("[element] lv2: scanned " << scanned.size() << " changed bundles");
+    cache->save();
+#else
+    lilv_world_load_all (world);
+#endif
+}
+
+void World::loadBundle (BundleCache::Bundle& bundle) const
+{
+    if (bundle.loaded)
+        return;
+    // lilv wants a directory uri with a trailing slash
+    auto* uri = lilv_new_file_uri (world, nullptr, (bundle.path + File::getSeparatorString()).toRawUTF8());
+    lilv_world_load_bundle (world, uri);
+    lilv_node_free (uri);
+    bundle.loaded = true;
+}
+
+const BundleCache::Plugin* World::getCachedPlugin (const String& uri) const
+{
+    if (cache == nullptr)
+        return nullptr;
+    const ScopedLock sl (lock);
+    if (auto* bundle = cache->getBundleForPlugin (uri))
+        if (! bundle->loaded)
+            return cache->getPlugin (uri);
+    return nullptr;
 }
 
 World::~World()
@@ -256,6 +351,14 @@ void World::fillPluginDescription (const String& uri, PluginDescription& desc) c
 
 const LilvPlugin* World::getPlugin (const String& uri) const
 {
+    if (cache != nullptr)
+    {
+        // load the plugin's bundle the first time it's referenced
+        const ScopedLock sl (lock);
+        if (auto* bundle = cache->getBundleForPlugin (uri))
+            loadBundle (*bundle);
+    }
+
     LilvNode* p (lilv_new_uri (world, uri.toUTF8()));
     const LilvPlugin* plugin = lilv_plugins_get_by_uri (getAllPlugins(), p);
     lilv_node_free (p);
@@ -265,6 +368,9 @@ const LilvPlugin* World::getPlugin (const String& uri) const
 
 String World::getPluginName (const String& uri) const
 {
+    if (auto* cached = getCachedPlugin (uri))
+        return cached->name;
+
     auto* uriNode = lilv_new_uri (world, uri.toRawUTF8());
     const auto* plugin = lilv_plugins_get_by_uri (
         lilv_world_get_all_plugins (world), uriNode);
@@ -293,6 +399,19 @@ void World::getSupportedPlugins (StringArray& list) const
         if (isPluginSupported (uri))
             list.add (uri);
     }
+
+    if (cache == nullptr)
+        return;
+
+    // plugins in bundles which haven't been loaded yet
+    const ScopedLock sl (lock);
+    cache->forEach ([&list] (const BundleCache::Bundle& bundle) {
+        if (bundle.loaded)
+            return;
+        for (const auto& plugin : bundle.plugins)
+            if (plugin.supported)
+                list.addIfNotAlreadyThere (plugin.uri);
+    });
 }
 
 const LilvPlugins* World::getAllPlugins() const
@@ -300,18 +419,14 @@ const LilvPlugins* World::getAllPlugins() const
     return lilv_world_get_all_plugins (world);
 }
 
-WorkThread& World::getWorkThread()
+WorkerPool& World::getWorkerPool()
 {
-    while (threads.size() < numThreads)
-    {
-        threads.add (new WorkThread ("LV2 Worker " + String (threads.size()), EL_LV2_RING_BUFFER_SIZE));
-    }
-
-    const int threadIndex = currentThread;
-    if (++currentThread >= numThreads)
-        currentThread = 0;
+    return *workers;
+}
 
-    return *threads.getUnchecked (threadIndex);
+int32 World::getNumWorkThreads() const
+{
+    return workers != nullptr ? workers->getNumThreads() : 0;
 }
 
 bool World::isFeatureSupported (const String& featureURI) const
@@ -335,6 +450,8 @@ bool World::isPluginAvailable (const String& uri)
 
 bool World::isPluginSupported (const String& uri) const
 {
+    if (auto* cached = getCachedPlugin (uri))
+        return cached->supported;
     if (const LilvPlugin* plugin = getPlugin (uri))
         return isPluginSupported (plugin);
     return false;
@@ -9,6 +9,7 @@
 
 #include <element/symbolmap.hpp>
 
+#include "lv2/bundlecache.hpp"
 #include "lv2/lv2features.hpp"
 
 #ifndef ELEMENT_PREFIX
@@ -19,10 +20,14 @@
 namespace element {
 
 class LV2Module;
-class WorkThread;
+class WorkerPool;
 
 /** Slim wrapper around LilvWorld.  Publishes commonly used LilvNodes and
     manages heavy weight features (like LV2 Worker)
+
+    Bundles which haven't changed since the last run are not parsed at
+    startup. They are loaded the first time one of their plugins is
+    requested. @see BundleCache
  */
 class World
 {
@@ -107,11 +112,20 @@ public:
         to a plugin instance */
     inline void getFeatures (Array<const LV2_Feature*>& feats) const { features.getFeatures (feats); }
 
-    /** Get a worker thread */
-    WorkThread& getWorkThread();
+    /** Get the worker pool shared by all plugins */
+    WorkerPool& getWorkerPool();
 
     /** Returns the total number of available worker threads */
-    inline int32 getNumWorkThreads() const { return numThreads; }
+    int32 getNumWorkThreads() const;
+
+    /** Lock to hold while using lilv from a thread other than the message
+        thread. The lilv world itself is not thread safe. */
+    const CriticalSection& getLock() const noexcept { return lock; }
+
+    /** Lock to hold around lilv_plugin_instantiate and lilv_instance_free.
+        They share lilv's list of open libraries, so they're serialised,
+        but queries under getLock() don't wait for a plugin to load. */
+    const CriticalSection& getInstanceLock() const noexcept { return instanceLock; }
 
     /** Returns a plugin's name by URI, or empty if not found */
     String getPluginName (const String& uri) const;
@@ -145,9 +159,14 @@ private:
     SymbolMap& symbolMap;
     LV2FeatureArray features;
 
-    // a simple rotating thread pool
-    int currentThread, numThreads;
-    OwnedArray<WorkThread> threads;
+    std::unique_ptr<WorkerPool> workers;
+
+    std::unique_ptr<BundleCache> cache;
+    CriticalSection lock, instanceLock;
+
+    void loadBundles();
+    void loadBundle (BundleCache::Bundle& bundle) const;
+    const BundleCache::Plugin* getCachedPlugin (const String& uri) const;
 };
 
 } // namespace element
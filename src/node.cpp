@@ -7,6 +7,7 @@
 #include <element/script.hpp>
 
 #include "engine/graphmanager.hpp"
+#include "session/statecache.hpp"
 #include "scopedflag.hpp"
 
 namespace element {
@@ -340,6 +341,8 @@ ValueTree Node::parse (const File& file)
             data.removeChild (nodeData, 0);
 
         Node::sanitizeProperties (nodeData);
+        // presets and default nodes are often loaded many times over.
+        StateCache::internStates (nodeData);
         return nodeData;
     }
 
@@ -792,26 +795,22 @@ void Node::restorePluginState()
             if (shouldSetProgram)
                 proc->setCurrentProgram (wantedProgram);
 
-            auto data = getProperty (tags::state).toString().trim();
-            if (data.isNotEmpty())
+            if (objectData.hasProperty (tags::state))
             {
-                MemoryBlock state;
-                state.fromBase64Encoding (data);
-                if (state.getSize() > 0)
+                const auto state = StateCache::decode (objectData.getProperty (tags::state));
+                if (state->getSize() > 0)
                 {
-                    proc->setStateInformation (state.getData(), (int) state.getSize());
+                    proc->setStateInformation (state->getData(), (int) state->getSize());
                 }
             }
 
-            data = getProperty (tags::programState).toString().trim();
-            if (shouldSetProgram && data.isNotEmpty())
+            if (shouldSetProgram && objectData.hasProperty (tags::programState))
             {
-                MemoryBlock state;
-                state.fromBase64Encoding (data);
-                if (state.getSize() > 0)
+                const auto state = StateCache::decode (objectData.getProperty (tags::programState));
+                if (state->getSize() > 0)
                 {
-                    proc->setCurrentProgramStateInformation (state.getData(),
-                                                             (int) state.getSize());
+                    proc->setCurrentProgramStateInformation (state->getData(),
+                                                             (int) state->getSize());
                 }
             }
         }
@@ -822,74 +821,157 @@ void Node::restorePluginState()
             if (shouldSetProgram)
                 obj->setCurrentProgram (wantedProgram);
 
-            auto data = getProperty (tags::state).toString().trim();
-            if (data.isNotEmpty())
+            if (objectData.hasProperty (tags::state))
             {
-                MemoryBlock state;
-                state.fromBase64Encoding (data);
-                if (state.getSize() > 0)
-                    obj->setState (state.getData(), (int) state.getSize());
+                const auto state = StateCache::decode (objectData.getProperty (tags::state));
+                if (state->getSize() > 0)
+                    obj->setState (state->getData(), (int) state->getSize());
             }
         }
 
-        if (hasProperty (tags::bypass))
-        {
-            obj->suspendProcessing (isBypassed());
-        }
+        restoreProcessorSettings();
+    }
 
-        if (hasProperty (tags::gain))
-        {
-            obj->setGain (getProperty ("gain"));
-        }
+    // this was originally here to help reduce memory usage
+    // need another way to free this property without disturbing
+    // the normal flow of the app.
+    const bool clearStateProperty = false;
+    if (clearStateProperty)
+        objectData.removeProperty (tags::state, 0);
 
-        if (hasProperty ("inputGain"))
-        {
-            obj->setInputGain (getProperty ("inputGain"));
-        }
+    for (int i = 0; i < getNumNodes(); ++i)
+        getNode (i).restorePluginState();
+}
 
-        if (hasProperty (tags::keyStart) && hasProperty (tags::keyEnd))
-        {
-            Range<int> range (getProperty (tags::keyStart, 0),
-                              getProperty (tags::keyEnd, 127));
-            obj->setKeyRange (range);
-        }
+void Node::restoreProcessorSettings()
+{
+    if (! isValid())
+        return;
 
-        if (hasProperty (tags::midiChannels))
-        {
-            const MidiChannels channels (getMidiChannels());
-            obj->setMidiChannels (channels.get());
-        }
+    ProcessorPtr obj = getObject();
+    if (obj == nullptr)
+        return;
 
-        if (hasProperty (tags::midiProgram))
-        {
-            obj->setMidiProgram ((int) getProperty (tags::midiProgram, -1));
-        }
+    if (hasProperty (tags::bypass))
+    {
+        obj->suspendProcessing (isBypassed());
+    }
 
-        if (hasProperty (tags::midiProgramsEnabled))
-            obj->setMidiProgramsEnabled ((bool) getProperty (tags::midiProgramsEnabled, true));
-        obj->setUseGlobalMidiPrograms ((bool) getProperty (tags::globalMidiPrograms, obj->useGlobalMidiPrograms()));
-        if (hasProperty (tags::midiProgramsState))
-            obj->setMidiProgramsState (getProperty (tags::midiProgramsState).toString().trim());
+    if (hasProperty (tags::gain))
+    {
+        obj->setGain (getProperty ("gain"));
+    }
 
-        obj->setMuted ((bool) getProperty (tags::mute, obj->isMuted()));
-        obj->setMuteInput ((bool) getProperty ("muteInput", obj->isMutingInputs()));
+    if (hasProperty ("inputGain"))
+    {
+        obj->setInputGain (getProperty ("inputGain"));
+    }
 
-        if (hasProperty (tags::transpose))
-            obj->setTransposeOffset (getProperty (tags::transpose));
+    if (hasProperty (tags::keyStart) && hasProperty (tags::keyEnd))
+    {
+        Range<int> range (getProperty (tags::keyStart, 0),
+                          getProperty (tags::keyEnd, 127));
+        obj->setKeyRange (range);
+    }
 
-        obj->setOversamplingFactor (jmax (1, (int) getProperty (tags::oversamplingFactor, 1)));
-        obj->setDelayCompensation (getProperty (tags::delayCompensation, 0.0));
+    if (hasProperty (tags::midiChannels))
+    {
+        const MidiChannels channels (getMidiChannels());
+        obj->setMidiChannels (channels.get());
     }
 
-    // this was originally here to help reduce memory usage
-    // need another way to free this property without disturbing
-    // the normal flow of the app.
-    const bool clearStateProperty = false;
-    if (clearStateProperty)
-        objectData.removeProperty (tags::state, 0);
+    if (hasProperty (tags::midiProgram))
+    {
+        obj->setMidiProgram ((int) getProperty (tags::midiProgram, -1));
+    }
 
-    for (int i = 0; i < getNumNodes(); ++i)
-        getNode (i).restorePluginState();
+    if (hasProperty (tags::midiProgramsEnabled))
+        obj->setMidiProgramsEnabled ((bool) getProperty (tags::midiProgramsEnabled, true));
+    obj->setUseGlobalMidiPrograms ((bool) getProperty (tags::globalMidiPrograms, obj->useGlobalMidiPrograms()));
+    if (hasProperty (tags::midiProgramsState))
+        obj->setMidiProgramsState (getProperty (tags::midiProgramsState).toString().trim());
+    if (obj->areMidiProgramsEnabled() && obj->useGlobalMidiPrograms())
+        obj->preloadMidiPrograms();
+
+    obj->setMuted ((bool) getProperty (tags::mute, obj->isMuted()));
+    obj->setMuteInput ((bool) getProperty ("muteInput", obj->isMutingInputs()));
+
+    if (hasProperty (tags::transpose))
+        obj->setTransposeOffset (getProperty (tags::transpose));
+
+    obj->setOversamplingFactor (jmax (1, (int) getProperty (tags::oversamplingFactor, 1)));
+    obj->setDelayCompensation (getProperty (tags::delayCompensation, 0.0));
+    obj->setLiveMode ((bool) getProperty (tags::liveMode, false));
+}
+
+bool Node::getPluginState (MemoryBlock& state, MemoryBlock& programState) const
+{
+    ProcessorPtr obj = getObject();
+    if (! isValid() || obj == nullptr || ! obj->isPrepared)
+        return false;
+
+    if (auto* proc = obj->getAudioProcessor())
+    {
+        proc->getStateInformation (state);
+        proc->getCurrentProgramStateInformation (programState);
+    }
+    else
+    {
+        obj->getState (state);
+    }
+
+    return true;
+}
+
+void Node::saveProcessorSettings (ValueTree target) const
+{
+    ProcessorPtr obj = getObject();
+    if (! isValid() || obj == nullptr || ! obj->isPrepared)
+        return;
+
+    if (auto* proc = obj->getAudioProcessor())
+    {
+        target.setProperty (tags::bypass, proc->isSuspended(), nullptr);
+        target.setProperty (tags::program, proc->getCurrentProgram(), nullptr);
+
+        const auto layout = proc->getBusesLayout();
+        auto buses = target.getOrCreateChildWithName (tags::buses, nullptr);
+        buses.removeAllChildren (nullptr);
+
+        auto channelSetToData = [] (const AudioChannelSet& acs) -> ValueTree {
+            ValueTree bus (types::AudioChannelSet);
+            bus.setProperty (tags::arrangement, acs.getSpeakerArrangementAsString(), nullptr);
+            return bus;
+        };
+
+        auto bins = buses.getOrCreateChildWithName (tags::inputs, nullptr);
+        for (int i = 0; i < layout.inputBuses.size(); ++i)
+        {
+            auto data = channelSetToData (layout.inputBuses.getReference (i));
+            if (data.isValid())
+                bins.addChild (data, -1, nullptr);
+        }
+
+        auto bouts = buses.getOrCreateChildWithName (tags::outputs, nullptr);
+        for (int i = 0; i < layout.outputBuses.size(); ++i)
+        {
+            auto data = channelSetToData (layout.outputBuses.getReference (i));
+            if (data.isValid())
+                bouts.addChild (data, -1, nullptr);
+        }
+    }
+
+    target.setProperty (tags::midiProgram, obj->getMidiProgram(), nullptr);
+    target.setProperty (tags::globalMidiPrograms, obj->useGlobalMidiPrograms(), nullptr);
+    target.setProperty (tags::midiProgramsEnabled, obj->areMidiProgramsEnabled(), nullptr);
+    target.setProperty (tags::mute, obj->isMuted(), nullptr);
+    target.setProperty ("muteInput", obj->isMutingInputs(), nullptr);
+    String mps;
+    obj->getMidiProgramsState (mps);
+    target.setProperty (tags::midiProgramsState, mps, nullptr);
+    target.setProperty (tags::oversamplingFactor, obj->getOversamplingFactor(), nullptr);
+    target.setProperty (tags::delayCompensation, obj->getDelayCompensation(), nullptr);
+    target.setProperty (tags::liveMode, obj->isLiveMode(), nullptr);
 }
 
 void Node::savePluginState()
@@ -922,35 +1004,6 @@ void Node::savePluginState()
             {
                 objectData.setProperty (tags::programState, state.toBase64Encoding(), 0);
             }
-
-            setProperty (tags::bypass, proc->isSuspended());
-            setProperty (tags::program, proc->getCurrentProgram());
-
-            const auto layout = proc->getBusesLayout();
-            auto buses = objectData.getOrCreateChildWithName (tags::buses, nullptr);
-            buses.removeAllChildren (nullptr);
-
-            auto channelSetToData = [] (const AudioChannelSet& acs) -> ValueTree {
-                ValueTree bus (types::AudioChannelSet);
-                bus.setProperty (tags::arrangement, acs.getSpeakerArrangementAsString(), nullptr);
-                return bus;
-            };
-
-            auto bins = buses.getOrCreateChildWithName (tags::inputs, nullptr);
-            for (int i = 0; i < layout.inputBuses.size(); ++i)
-            {
-                auto data = channelSetToData (layout.inputBuses.getReference (i));
-                if (data.isValid())
-                    bins.addChild (data, -1, nullptr);
-            }
-
-            auto bouts = buses.getOrCreateChildWithName (tags::outputs, nullptr);
-            for (int i = 0; i < layout.outputBuses.size(); ++i)
-            {
-                auto data = channelSetToData (layout.outputBuses.getReference (i));
-                if (data.isValid())
-                    bouts.addChild (data, -1, nullptr);
-            }
         }
         else
         {
@@ -959,16 +1012,7 @@ void Node::savePluginState()
                 objectData.setProperty (tags::state, state.toBase64Encoding(), nullptr);
         }
 
-        setProperty (tags::midiProgram, obj->getMidiProgram());
-        setProperty (tags::globalMidiPrograms, obj->useGlobalMidiPrograms());
-        setProperty (tags::midiProgramsEnabled, obj->areMidiProgramsEnabled());
-        setProperty (tags::mute, obj->isMuted());
-        setProperty ("muteInput", obj->isMutingInputs());
-        String mps;
-        obj->getMidiProgramsState (mps);
-        setProperty (tags::midiProgramsState, mps);
-        setProperty (tags::oversamplingFactor, obj->getOversamplingFactor());
-        setProperty (tags::delayCompensation, obj->getDelayCompensation());
+        saveProcessorSettings (objectData);
     }
 
     for (int i = 0; i < getNumNodes(); ++i)
@@ -1338,12 +1382,12 @@ void NodeObjectSync::valueTreePropertyChanged (ValueTree& tree, const Identifier
     }
     else if (property == tags::delayCompensation)
     {
+        // the parent graph retunes its delay lines when this changes.
         obj->setDelayCompensation (tree.getProperty (property, obj->getDelayCompensation()));
-        if (auto* const g = obj->getParentGraph())
-        {
-            g->cancelPendingUpdate();
-            g->triggerAsyncUpdate();
-        }
+    }
+    else if (property == tags::liveMode)
+    {
+        obj->setLiveMode ((bool) tree.getProperty (property, obj->isLiveMode()));
     }
 }
 
@@ -49,6 +49,11 @@ public:
         addAndMakeVisible (startStopContinueToggle);
         startStopContinueToggle.setButtonText ("Respond to MIDI start/stop/continue");
 
+        addAndMakeVisible (streamMode);
+        streamMode.addItem ("Stream from disk", 1 + AudioFilePlayerNode::Streaming);
+        streamMode.addItem ("Preload into RAM", 1 + AudioFilePlayerNode::Preload);
+        streamMode.addItem ("Memory mapped", 1 + AudioFilePlayerNode::MemoryMapped);
+
         addAndMakeVisible (position);
         position.setSliderStyle (Slider::LinearBar);
         position.setRange (0.0, 1.0, 0.001);
@@ -62,7 +67,7 @@ public:
         stabilizeComponents();
         bindHandlers();
 
-        setSize (360, 144);
+        setSize (360, 166);
         startTimer (1001);
     }
 
@@ -126,6 +131,7 @@ public:
 
         startStopContinueToggle.setToggleState (processor.respondsToStartStopContinue(),
                                                 dontSendNotification);
+        streamMode.setSelectedId (1 + processor.getStreamMode(), dontSendNotification);
     }
 
     void fileComboBoxChanged (FileComboBox*) override
@@ -154,6 +160,8 @@ public:
         position.setBounds (r.removeFromTop (18));
         r.removeFromTop (4);
         startStopContinueToggle.setBounds (r.removeFromTop (18));
+        r.removeFromTop (4);
+        streamMode.setBounds (r.removeFromTop (18));
     }
 
     void paint (Graphics& g) override
@@ -205,6 +213,7 @@ private:
     TextButton loopButton;
     IconButton watchButton;
     ToggleButton startStopContinueToggle;
+    ComboBox streamMode;
     Atomic<int> startStopContinue { 0 };
     SignalConnection stateRestoredConnection;
 
@@ -269,6 +278,12 @@ private:
             return Util::minutesToString (posInMinutes);
         };
 
+        streamMode.onChange = [this]() {
+            processor.setStreamMode (static_cast<AudioFilePlayerNode::StreamMode> (
+                streamMode.getSelectedId() - 1));
+            stabilizeComponents();
+        };
+
         startStopContinueToggle.onClick = [this]() {
             processor.setRespondToStartStopContinue (
                 startStopContinueToggle.getToggleState() ? 1 : 0);
@@ -287,6 +302,7 @@ private:
         position.textFromValueFunction = nullptr;
         volume.onValueChange = nullptr;
         startStopContinueToggle.onClick = nullptr;
+        streamMode.onChange = nullptr;
         processor.getPlayer().removeChangeListener (this);
         chooser->removeListener (this);
         watchButton.onClick = nullptr;
@@ -352,43 +368,123 @@ void AudioFilePlayerNode::fillInPluginDescription (PluginDescription& desc) cons
 void AudioFilePlayerNode::clearPlayer()
 {
     player.setSource (nullptr);
+    source = nullptr;
+    stream = nullptr;
+    memory = nullptr;
+    preloaded.setSize (0, 0);
     if (reader)
         reader = nullptr;
+    sourceSampleRate = 0.0;
+    activeMode = Streaming;
     *playing = player.isPlaying();
 }
 
+void AudioFilePlayerNode::setStreamMode (StreamMode newMode)
+{
+    if (newMode == streamMode)
+        return;
+    streamMode = newMode;
+
+    if (audioFile.existsAsFile())
+    {
+        const auto file = audioFile;
+        const auto pos = player.getCurrentPosition();
+        const bool wasRunning = player.isPlaying();
+        loadFile (file);
+        player.setPosition (pos);
+        *playing = wasRunning;
+    }
+}
+
 void AudioFilePlayerNode::openFile (const File& file)
 {
     if (file == audioFile)
         return;
-    if (auto* newReader = formats.createReaderFor (file))
+    loadFile (file);
+}
+
+bool AudioFilePlayerNode::loadFile (const File& file)
+{
+    std::unique_ptr<AudioFormatReader> newReader;
+    StreamMode mode = streamMode;
+
+    if (mode == MemoryMapped)
     {
-        clearPlayer();
-        reader.reset (new AudioFormatReaderSource (newReader, true));
-        audioFile = file;
-        player.setSource (reader.get(), 1024 * 8, &thread, newReader->sampleRate, 2);
+        std::unique_ptr<MemoryMappedAudioFormatReader> mapped;
+        if (auto* format = formats.findFormatForFileExtension (file.getFileExtension()))
+            mapped.reset (format->createMemoryMappedReader (file));
 
-        ScopedLock sl (getCallbackLock());
-        reader->setLooping (*looping);
-        player.setLooping (*looping);
+        if (mapped != nullptr && mapped->mapEntireFile())
+        {
+            // fault the pages in now so playback never touches the disk.
+            for (int64 i = 0; i < mapped->lengthInSamples; i += 512)
+                mapped->touchSample (i);
+            newReader = std::move (mapped);
+        }
+        else
+        {
+            mode = Streaming;
+        }
     }
+
+    if (newReader == nullptr)
+        newReader.reset (formats.createReaderFor (file));
+    if (newReader == nullptr)
+        return false;
+
+    clearPlayer();
+
+    if (mode == Preload
+        && (double) newReader->lengthInSamples > maxPreloadSeconds * newReader->sampleRate)
+    {
+        Logger::writeToLog ("[element] file too long to preload, streaming instead: " + file.getFileName());
+        mode = Streaming;
+    }
+
+    sourceSampleRate = newReader->sampleRate;
+
+    if (mode == Preload)
+    {
+        preloaded.setSize (2, (int) newReader->lengthInSamples);
+        newReader->read (&preloaded, 0, (int) newReader->lengthInSamples, 0, true, true);
+        memory.reset (new MemoryAudioSource (preloaded, false, *looping));
+        source = memory.get();
+    }
+    else
+    {
+        reader.reset (new AudioFormatReaderSource (newReader.release(), true));
+
+        if (mode == MemoryMapped)
+        {
+            source = reader.get();
+        }
+        else
+        {
+            stream.reset (new DiskStream (*streaming, reader.get(), false, 2));
+            source = stream.get();
+        }
+    }
+
+    audioFile = file;
+    activeMode = mode;
+    player.setSource (source, 0, nullptr, sourceSampleRate, 2);
+
+    ScopedLock sl (getCallbackLock());
+    source->setLooping (*looping);
+    player.setLooping (*looping);
+    return true;
 }
 
 void AudioFilePlayerNode::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
 {
-    thread.startThread();
     formats.registerBasicFormats();
     player.prepareToPlay (maximumExpectedSamplesPerBlock, sampleRate);
 
-    if (reader)
+    if (source != nullptr)
     {
-        double readerSampleRate = sampleRate;
-        if (auto* fmtReader = reader->getAudioFormatReader())
-            readerSampleRate = fmtReader->sampleRate;
-
-        reader->setLooping (*looping);
+        source->setLooping (*looping);
         player.setLooping (*looping);
-        player.setSource (reader.get(), 1024 * 8, &thread, readerSampleRate, 2);
+        player.setSource (source, 0, nullptr, sourceSampleRate > 0.0 ? sourceSampleRate : sampleRate, 2);
         player.setPosition (jmax (0.0, lastTransportPos));
         if (wasPlaying)
             player.start();
@@ -408,7 +504,6 @@ void AudioFilePlayerNode::releaseResources()
     player.releaseResources();
     player.setSource (nullptr);
     formats.clearFormats();
-    thread.stopThread (14);
 }
 
 void AudioFilePlayerNode::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
@@ -521,7 +616,8 @@ void AudioFilePlayerNode::getStateInformation (juce::MemoryBlock& destData)
         .setProperty ("playing", (bool) *playing, nullptr)
         .setProperty ("slave", (bool) *slave, nullptr)
         .setProperty ("loop", (bool) *looping, nullptr)
-        .setProperty ("midiStartStopContinue", midiStartStopContinue.get() == 1, nullptr);
+        .setProperty ("midiStartStopContinue", midiStartStopContinue.get() == 1, nullptr)
+        .setProperty ("streamMode", (int) streamMode, nullptr);
 
     if (watchDir.exists())
         state.setProperty ("watchDir", watchDir.getFullPathName(), nullptr);
@@ -535,8 +631,20 @@ void AudioFilePlayerNode::setStateInformation (const void* data, int sizeInBytes
     const auto state = ValueTree::readFromData (data, (size_t) sizeInBytes);
     if (state.isValid())
     {
-        if (File::isAbsolutePath (state["audioFile"].toString()))
+        const auto mode = static_cast<StreamMode> (jlimit ((int) Streaming, (int) MemoryMapped,
+                                                           (int) state.getProperty ("streamMode", (int) Streaming)));
+        if (File::isAbsolutePath (state["audioFile"].toString())
+            && File (state["audioFile"].toString()) != audioFile)
+        {
+            // set the mode first so the file is only read once.
+            streamMode = mode;
             openFile (File (state["audioFile"].toString()));
+        }
+        else
+        {
+            setStreamMode (mode);
+        }
+
         *playing = (bool) state.getProperty ("playing", false);
         *slave = (bool) state.getProperty ("slave", false);
         *looping = (bool) state.getProperty ("loop", true);
@@ -576,10 +684,10 @@ void AudioFilePlayerNode::parameterValueChanged (int parameter, float newValue)
         break;
 
         case Looping: {
-            if (reader != nullptr)
+            if (source != nullptr)
             {
                 player.setLooping (*looping);
-                reader->setLooping (*looping);
+                source->setLooping (*looping);
             }
         }
         break;
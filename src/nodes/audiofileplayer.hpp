@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "engine/diskstreaming.hpp"
 #include "nodes/baseprocessor.hpp"
 #include <element/signals.hpp>
 
@@ -20,6 +21,17 @@ public:
         Volume,
         Looping
     };
+    /** How the audio file is read during playback. */
+    enum StreamMode
+    {
+        /** Read from disk ahead of playback on a shared thread. */
+        Streaming = 0,
+        /** Decode the whole file into memory when it's opened. */
+        Preload,
+        /** Map the file into memory (WAV and AIFF only). */
+        MemoryMapped
+    };
+
     enum MidiPlayState
     {
         None = 0,
@@ -45,6 +57,18 @@ public:
     bool isLooping() const;
 
     void openFile (const File& file);
+
+    /** Change how the file is read. Reopens the current file if needed. */
+    void setStreamMode (StreamMode newMode);
+    StreamMode getStreamMode() const noexcept { return streamMode; }
+
+    /** Returns how the open file is actually read.  This differs from the
+        requested mode when the file can't be mapped or is too long to preload.
+     */
+    StreamMode getActiveStreamMode() const noexcept { return activeMode; }
+
+    /** Files longer than this are streamed even when preloading is requested. */
+    static constexpr double maxPreloadSeconds = 30.0;
     const File& getAudioFile() const { return audioFile; }
     String getWildcard() const { return formats.getWildcardForAllFormats(); }
 
@@ -102,6 +126,9 @@ public:
 
     AudioTransportSource& getPlayer() { return player; }
 
+    /** Returns the number of blocks the disk stream couldn't deliver in time. */
+    int getNumUnderruns() const { return stream != nullptr ? stream->getNumUnderruns() : 0; }
+
     Signal<void()> restoredState;
 
 protected:
@@ -139,8 +166,15 @@ protected:
 #endif
 
 private:
-    TimeSliceThread thread { "MediaPlayer" };
+    SharedResourcePointer<DiskStreamingPool> streaming;
     std::unique_ptr<AudioFormatReaderSource> reader;
+    std::unique_ptr<DiskStream> stream;
+    AudioBuffer<float> preloaded;
+    std::unique_ptr<MemoryAudioSource> memory;
+    PositionableAudioSource* source = nullptr;
+    double sourceSampleRate = 0.0;
+    StreamMode streamMode = Streaming;
+    StreamMode activeMode = Streaming;
     AudioFormatManager formats;
     AudioTransportSource player;
 
@@ -159,6 +193,7 @@ private:
     File watchDir;
 
     void clearPlayer();
+    bool loadFile (const File& file);
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFilePlayerNode)
 };
 
@@ -148,11 +148,14 @@ void AudioProcessorNode::releaseResources()
 
 void AudioProcessorNode::audioProcessorChanged (AudioProcessor*, const ChangeDetails& details)
 {
+    if (details.nonParameterStateChanged || details.programChanged)
+        markStateChanged();
+
     if (details.latencyChanged)
     {
         setLatencySamples (proc->getLatencySamples());
         if (auto g = getParentGraph())
-            g->triggerAsyncUpdate();
+            g->triggerLatencyUpdate();
     }
 }
 
@@ -194,6 +194,7 @@ void MediaPlayerProcessor::fillInPluginDescription (PluginDescription& desc) con
 void MediaPlayerProcessor::clearPlayer()
 {
     player.setSource (nullptr);
+    stream = nullptr;
     if (reader)
         reader = nullptr;
     *playing = player.isPlaying();
@@ -207,8 +208,9 @@ void MediaPlayerProcessor::openFile (const File& file)
     {
         clearPlayer();
         reader.reset (new AudioFormatReaderSource (newReader, true));
+        stream.reset (new DiskStream (*streaming, reader.get(), false, 2));
         audioFile = file;
-        player.setSource (reader.get(), 1024 * 8, &thread, getSampleRate(), 2);
+        player.setSource (stream.get(), 0, nullptr, getSampleRate(), 2);
         ScopedLock sl (getCallbackLock());
         player.setLooping (true);
         reader->setLooping (true);
@@ -217,7 +219,6 @@ void MediaPlayerProcessor::openFile (const File& file)
 
 void MediaPlayerProcessor::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
 {
-    thread.startThread();
     formats.registerBasicFormats();
     player.prepareToPlay (maximumExpectedSamplesPerBlock, sampleRate);
     player.setLooping (true);
@@ -230,7 +231,6 @@ void MediaPlayerProcessor::releaseResources()
     player.stop();
     player.releaseResources();
     formats.clearFormats();
-    thread.stopThread (14);
 }
 
 void MediaPlayerProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
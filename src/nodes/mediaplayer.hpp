@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "engine/diskstreaming.hpp"
 #include "nodes/baseprocessor.hpp"
 
 namespace element {
@@ -70,6 +71,9 @@ public:
 
     AudioTransportSource& getPlayer() { return player; }
 
+    /** Returns the number of blocks the disk stream couldn't deliver in time. */
+    int getNumUnderruns() const { return stream != nullptr ? stream->getNumUnderruns() : 0; }
+
 protected:
     bool isBusesLayoutSupported (const BusesLayout&) const override;
 
@@ -105,8 +109,9 @@ protected:
 #endif
 
 private:
-    TimeSliceThread thread { "MediaPlayer" };
+    SharedResourcePointer<DiskStreamingPool> streaming;
     std::unique_ptr<AudioFormatReaderSource> reader;
+    std::unique_ptr<DiskStream> stream;
     AudioFormatManager formats;
     AudioTransportSource player;
 
@@ -38,48 +38,179 @@ require ('el.MidiPipe')
 namespace element {
 
 //=============================================================================
-ScriptNode::ScriptNode() noexcept
-    : Processor (0)
+struct ScriptNode::Instance
 {
-    setName ("Script");
-    Lua::initializeState (lua);
-
-    lua.set_function ("print", [this] (sol::variadic_args va) {
-        auto& e = lua;
-        String msg;
-        for (auto v : va)
-        {
-            if (sol::type::string == v.get_type())
+    Instance()
+        : lua (sol::default_at_panic, LuaArena::allocate, &arena)
+    {
+        Lua::initializeState (lua);
+        // garbage is collected in steps after each processed block instead.
+        lua.stop_gc();
+
+        lua.set_function ("print", [this] (sol::variadic_args va) {
+            auto& e = lua;
+            String msg;
+            for (auto v : va)
             {
-                msg << v.as<const char*>() << " ";
-                continue;
+                if (sol::type::string == v.get_type())
+                {
+                    msg << v.as<const char*>() << " ";
+                    continue;
+                }
+
+                sol::function ts = e["tostring"];
+                if (ts.valid())
+                {
+                    sol::object str = ts ((sol::object) v);
+                    if (str.valid())
+                        if (const char* sstr = str.as<const char*>())
+                            msg << sstr << "  ";
+                }
             }
 
-            sol::function ts = e["tostring"];
-            if (ts.valid())
+            if (msg.isNotEmpty())
             {
-                sol::object str = ts ((sol::object) v);
-                if (str.valid())
-                    if (const char* sstr = str.as<const char*>())
-                        msg << sstr << "  ";
+                if (MessageManager::getInstance()->isThisTheMessageThread())
+                {
+                    Logger::writeToLog (msg);
+                }
+                else
+                {
+                    MessageManagerLock ml;
+                    Logger::writeToLog (msg);
+                }
             }
+        });
+    }
+
+    ~Instance()
+    {
+        if (script != nullptr)
+        {
+            script->release();
+            script->cleanup();
         }
+        script.reset();
+    }
+
+    bool isPrepared (double rate, int block) const noexcept
+    {
+        return preparedRate == rate && preparedBlock == block;
+    }
+
+    void prepare (double rate, int block)
+    {
+        script->prepare (rate, block);
+        const auto& ports = script->getPorts();
+        fadeBuffer.setSize (jmax (1, ports.size (PortType::Audio, true), ports.size (PortType::Audio, false)),
+                            block,
+                            false,
+                            true,
+                            true);
+        fadeMidi.ensureSize (2048);
+        arena.reserve (LuaArena::defaultPoolSize);
+        preparedRate = rate;
+        preparedBlock = block;
+    }
+
+    LuaArena arena;
+    sol::state lua;
+    std::unique_ptr<DSPScript> script;
 
-        if (msg.isNotEmpty())
+    // used when this instance is being faded out.
+    AudioSampleBuffer fadeBuffer;
+    MidiBuffer fadeMidi;
+    double preparedRate = 0.0;
+    int preparedBlock = 0;
+};
+
+//=============================================================================
+struct ScriptNode::Compiler : public ThreadPool
+{
+    Compiler() : ThreadPool (1) {}
+};
+
+class ScriptNode::CompileJob : public ThreadPoolJob
+{
+public:
+    CompileJob (ScriptNode& n, const String& c, std::function<void (Result)> f)
+        : ThreadPoolJob ("compile script"), node (n), code (c), callback (std::move (f)) {}
+
+    JobStatus runJob() override
+    {
+        auto result = Result::ok();
+        auto* instance = node.compile (code, result).release();
+        MessageManager::callAsync ([alive = node.alive, owner = &node, instance, result, f = callback]() {
+            std::unique_ptr<Instance> compiled (instance);
+            if (! *alive)
+                return;
+            if (compiled != nullptr)
+                owner->install (std::move (compiled));
+            if (f)
+                f (result);
+        });
+        return jobHasFinished;
+    }
+
+    ScriptNode& node;
+
+private:
+    String code;
+    std::function<void (Result)> callback;
+};
+
+//=============================================================================
+class ScriptNode::Updater : public AsyncUpdater
+{
+public:
+    explicit Updater (ScriptNode& n) : node (n) {}
+
+    void handleAsyncUpdate() override
+    {
+        for (auto& slot : node.retired)
+            delete slot.exchange (nullptr, std::memory_order_acquire);
+
+        auto* instance = node.active.load (std::memory_order_acquire);
+        if (! node.failureReported.load() || instance == nullptr)
+            return;
+        if (instance->script->getFailure() == DSPScript::Failure::none || reported == instance)
+            return;
+
+        reported = instance;
+        String msg;
+        switch (instance->script->getFailure())
         {
-            if (MessageManager::getInstance()->isThisTheMessageThread())
-            {
-                Logger::writeToLog (msg);
-            }
-            else
-            {
-                MessageManagerLock ml;
-                Logger::writeToLog (msg);
-            }
+            case DSPScript::Failure::outOfMemory:
+                msg << "out of memory (" << String ((int) (instance->arena.getCapacity() / 1024)) << " KB)";
+                break;
+            case DSPScript::Failure::overBudget:
+                msg << "exceeded its CPU budget and was bypassed";
+                break;
+            default:
+                msg << "runtime error";
+                break;
         }
-    });
 
-    script.reset (new DSPScript (lua.create_table()));
+        Logger::writeToLog ("[element] script stopped: " + msg);
+        node.errorMessage = "Script stopped: " + msg;
+        node.sendChangeMessage();
+    }
+
+private:
+    ScriptNode& node;
+    Instance* reported = nullptr;
+};
+
+//=============================================================================
+ScriptNode::ScriptNode() noexcept
+    : Processor (0),
+      alive (std::make_shared<bool> (true))
+{
+    setName ("Script");
+    for (auto& slot : retired)
+        slot.store (nullptr);
+    updater = std::make_unique<Updater> (*this);
+
     dspCode.replaceAllContent (String::fromUTF8 (
         scripts::amp_lua, scripts::amp_luaSize));
     loadScript (dspCode.getAllContent());
@@ -90,11 +221,43 @@ ScriptNode::ScriptNode() noexcept
 
 ScriptNode::~ScriptNode()
 {
-    script.reset();
+    struct OwnJobs : public ThreadPool::JobSelector
+    {
+        explicit OwnJobs (ScriptNode& n) : node (n) {}
+        bool isJobSuitable (ThreadPoolJob* job) override
+        {
+            auto* compile = dynamic_cast<CompileJob*> (job);
+            return compile != nullptr && &compile->node == &node;
+        }
+        ScriptNode& node;
+    } ownJobs (*this);
+
+    *alive = false;
+    compiler->removeAllJobs (true, -1, &ownJobs);
+
+    updater->cancelPendingUpdate();
+    updater.reset();
+
+    delete pending.exchange (nullptr);
+    if (fading != nullptr)
+        delete fading;
+    for (auto& slot : retired)
+        delete slot.exchange (nullptr);
+    delete active.exchange (nullptr);
+}
+
+DSPScript* ScriptNode::getLatestScript() const noexcept
+{
+    if (auto* instance = pending.load (std::memory_order_acquire))
+        return instance->script.get();
+    if (auto* instance = active.load (std::memory_order_acquire))
+        return instance->script.get();
+    return nullptr;
 }
 
 void ScriptNode::refreshPorts()
 {
+    auto* script = getLatestScript();
     if (script == nullptr)
         return;
     PortList newPorts;
@@ -107,53 +270,141 @@ void ScriptNode::refreshPorts()
 void ScriptNode::setPlayHead (juce::AudioPlayHead* playhead)
 {
     Processor::setPlayHead (playhead);
-    if (script)
-        script->setPlayHead (playhead);
+    if (auto* instance = active.load())
+        instance->script->setPlayHead (playhead);
 }
 
 ParameterPtr ScriptNode::getParameter (const PortDescription& port)
 {
     jassert (port.type == PortType::Control);
+    auto* script = getLatestScript();
     return script ? script->getParameterObject (port.channel, port.input) : nullptr;
 }
 
-Result ScriptNode::loadScript (const String& newCode)
+std::unique_ptr<ScriptNode::Instance> ScriptNode::compile (const String& newCode, Result& result)
 {
-    auto result = DSPScript::validate (newCode);
+    result = DSPScript::validate (newCode);
     if (result.failed())
-        return result;
+        return nullptr;
 
-    ScriptLoader loader (lua);
+    auto instance = std::make_unique<Instance>();
+    ScriptLoader loader (instance->lua);
     loader.load (newCode);
     if (loader.hasError())
-        return Result::fail (loader.getErrorMessage());
+    {
+        result = Result::fail (loader.getErrorMessage());
+        return nullptr;
+    }
 
     auto dsp = loader();
     if (! dsp.valid() || dsp.get_type() != sol::type::table)
-        return Result::fail ("Could not instantiate script");
+    {
+        result = Result::fail ("Could not instantiate script");
+        return nullptr;
+    }
 
-    auto newScript = std::make_unique<DSPScript> (dsp);
+    instance->script = std::make_unique<DSPScript> (dsp);
+    instance->script->setPlayHead (getPlayHead());
 
-    if (true)
+    double rate = 0.0;
+    int block = 0;
     {
-        newScript->setPlayHead (getPlayHead());
+        ScopedLock sl (lock);
+        instance->script->setBudget (instructionBudget, timeBudget);
         if (prepared)
-            newScript->prepare (sampleRate, blockSize);
-        triggerPortReset();
+        {
+            rate = sampleRate;
+            block = blockSize;
+        }
+    }
+
+    if (rate > 0.0)
+        instance->prepare (rate, block);
+
+    instance->lua.collect_garbage();
+    instance->arena.reserve (LuaArena::defaultPoolSize);
+    result = Result::ok();
+    return instance;
+}
+
+void ScriptNode::install (std::unique_ptr<Instance> instance)
+{
+    {
         ScopedLock sl (lock);
-        if (script != nullptr)
-            newScript->copyParameterValues (*script);
-        script.swap (newScript);
+        if (prepared && ! instance->isPrepared (sampleRate, blockSize))
+            instance->prepare (sampleRate, blockSize);
+
+        if (! prepared)
+        {
+            // not rendering, so swap right away.
+            std::unique_ptr<Instance> previous (active.exchange (nullptr));
+            if (previous != nullptr)
+                instance->script->copyParameterValues (*previous->script);
+            delete pending.exchange (nullptr);
+            active.store (instance.release());
+            failureReported = false;
+        }
+        else
+        {
+            // a pending script the audio thread didn't take yet is replaced.
+            delete pending.exchange (instance.release(), std::memory_order_acq_rel);
+        }
     }
 
-    if (newScript != nullptr)
+    if (errorMessage.isNotEmpty())
     {
-        newScript->release();
-        newScript->cleanup();
-        newScript.reset();
+        errorMessage.clear();
+        sendChangeMessage();
     }
 
-    return Result::ok();
+    triggerPortReset();
+}
+
+Result ScriptNode::loadScript (const String& newCode)
+{
+    auto result = Result::ok();
+    if (auto instance = compile (newCode, result))
+        install (std::move (instance));
+    return result;
+}
+
+void ScriptNode::loadScriptAsync (const String& newCode, std::function<void (Result)> callback)
+{
+    compiler->addJob (new CompileJob (*this, newCode, std::move (callback)), true);
+}
+
+void ScriptNode::setCrossfadeTime (double seconds)
+{
+    ScopedLock sl (lock);
+    crossfadeTime = jmax (0.0, seconds);
+    if (prepared)
+        fadeLength.store (roundToInt (crossfadeTime * sampleRate));
+}
+
+void ScriptNode::setBudget (int instructions, double blockFraction)
+{
+    ScopedLock sl (lock);
+    instructionBudget = instructions;
+    timeBudget = blockFraction;
+    for (auto* instance : { active.load(), pending.load() })
+        if (instance != nullptr)
+            instance->script->setBudget (instructionBudget, timeBudget);
+}
+
+void ScriptNode::retire (Instance* instance) noexcept
+{
+    for (auto& slot : retired)
+    {
+        Instance* expected = nullptr;
+        if (slot.compare_exchange_strong (expected, instance, std::memory_order_release))
+        {
+            updater->triggerAsyncUpdate();
+            return;
+        }
+    }
+
+    // render() only swaps when a slot is free.
+    jassertfalse;
 }
 
 void ScriptNode::getPluginDescription (PluginDescription& desc) const
@@ -175,9 +426,15 @@ void ScriptNode::prepareToRender (double rate, int block)
 {
     if (prepared)
         return;
+
+    ScopedLock sl (lock);
     sampleRate = rate;
     blockSize = block;
-    script->prepare (sampleRate, blockSize);
+    if (auto* instance = active.load())
+        instance->prepare (sampleRate, blockSize);
+    if (auto* instance = pending.load())
+        instance->prepare (sampleRate, blockSize);
+    fadeLength.store (roundToInt (crossfadeTime * sampleRate));
     prepared = true;
 }
 
@@ -185,14 +442,141 @@ void ScriptNode::releaseResources()
 {
     if (! prepared)
         return;
+
+    ScopedLock sl (lock);
     prepared = false;
-    script->release();
+
+    if (fading != nullptr)
+    {
+        delete fading;
+        fading = nullptr;
+    }
+
+    if (auto* next = pending.exchange (nullptr))
+    {
+        std::unique_ptr<Instance> previous (active.exchange (next));
+        if (previous != nullptr)
+            next->script->copyParameterValues (*previous->script);
+    }
+
+    if (auto* instance = active.load())
+    {
+        instance->script->release();
+        instance->preparedRate = 0.0;
+    }
+}
+
+static bool haveSamePorts (const PortList& a, const PortList& b) noexcept
+{
+    if (a.size() != b.size())
+        return false;
+    for (int i = 0; i < a.size(); ++i)
+    {
+        const auto* pa = a.getPorts().getUnchecked (i);
+        const auto* pb = b.getPorts().getUnchecked (i);
+        if (pa->type != pb->type || pa->input != pb->input || pa->channel != pb->channel || pa->symbol != pb->symbol)
+            return false;
+    }
+    return true;
 }
 
 void ScriptNode::render (RenderContext& rc)
 {
-    ScopedLock sl (lock);
-    script->process (rc.audio, rc.midi);
+    // the message thread holds this while it reads a live script's state.
+    // Pass the block through rather than wait for it.
+    const SpinLock::ScopedTryLockType sl (stateLock);
+    if (! sl.isLocked())
+        return;
+
+    auto* instance = active.load (std::memory_order_acquire);
+
+    // take a newly compiled script if one is waiting and the old one can be
+    // handed off. Nothing here allocates, frees or waits.
+    auto* next = pending.load (std::memory_order_acquire);
+    if (next != nullptr && fading == nullptr)
+    {
+        bool canRetire = false;
+        for (auto& slot : retired)
+            canRetire |= slot.load (std::memory_order_relaxed) == nullptr;
+
+        if (canRetire && pending.compare_exchange_strong (next, nullptr, std::memory_order_acq_rel))
+        {
+            next->script->setPlayHead (getPlayHead());
+            if (instance != nullptr)
+            {
+                next->script->copyParameterValues (*instance->script);
+                const bool crossfade = fadeLength.load() > 0
+                                       && instance->script->isValid()
+                                       && haveSamePorts (instance->script->getPorts(), next->script->getPorts())
+                                       && instance->fadeBuffer.getNumChannels() >= rc.audio.getNumChannels()
+                                       && instance->fadeBuffer.getNumSamples() >= rc.audio.getNumSamples();
+                if (crossfade)
+                {
+                    fading = instance;
+                    fadePosition = 0;
+                }
+                else
+                {
+                    retire (instance);
+                }
+            }
+
+            active.store (next, std::memory_order_release);
+            instance = next;
+            failureReported = false;
+        }
+    }
+
+    if (instance == nullptr)
+        return;
+
+    const int numChannels = rc.audio.getNumChannels();
+    const int numSamples = rc.audio.getNumSamples();
+
+    if (fading != nullptr && numSamples <= fading->fadeBuffer.getNumSamples())
+    {
+        for (int c = 0; c < numChannels; ++c)
+            fading->fadeBuffer.copyFrom (c, 0, rc.audio, c, 0, numSamples);
+    }
+    else if (fading != nullptr)
+    {
+        retire (fading);
+        fading = nullptr;
+    }
+
+    instance->script->process (rc.audio, rc.midi);
+
+    if (fading != nullptr)
+    {
+        AudioSampleBuffer old (fading->fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        MidiPipe noMidi (fading->fadeMidi);
+        fading->script->process (old, noMidi);
+        fading->fadeMidi.clear();
+
+        const int length = jmax (1, fadeLength.load());
+        const float startGain = (float) fadePosition / (float) length;
+        fadePosition = jmin (length, fadePosition + numSamples);
+        const float endGain = (float) fadePosition / (float) length;
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            rc.audio.applyGainRamp (c, 0, numSamples, startGain, endGain);
+            rc.audio.addFromWithRamp (c, 0, old.getReadPointer (c), numSamples, 1.f - startGain, 1.f - endGain);
+        }
+
+        if (fadePosition >= length)
+        {
+            retire (fading);
+            fading = nullptr;
+        }
+    }
+
+    if (! failureReported.load (std::memory_order_relaxed)
+        && instance->script->getFailure() != DSPScript::Failure::none)
+    {
+        failureReported = true;
+        updater->triggerAsyncUpdate();
+    }
 }
 
 void ScriptNode::setState (const void* data, int size)
@@ -203,17 +587,19 @@ void ScriptNode::setState (const void* data, int size)
         dspCode.replaceAllContent (state["dspCode"].toString());
         edCode.replaceAllContent (state["editorCode"].toString());
 
-        auto result = loadScript (dspCode.getAllContent());
-
-        if (result.wasOk())
+        auto result = Result::ok();
+        if (auto instance = compile (dspCode.getAllContent(), result))
         {
+            // restore before the audio thread can see it.
             if (state.hasProperty ("data"))
             {
                 const var& data = state.getProperty ("data");
                 if (data.isBinaryData())
                     if (auto* block = data.getBinaryData())
-                        script->restore (block->getData(), block->getSize());
+                        instance->script->restore (block->getData(), block->getSize());
             }
+
+            install (std::move (instance));
         }
 
         sendChangeMessage();
@@ -227,7 +613,12 @@ void ScriptNode::getState (MemoryBlock& out)
         .setProperty ("editorCode", edCode.getAllContent(), nullptr);
 
     MemoryBlock block;
-    script->save (block);
+    {
+        // save() runs Lua in the script's state, keep render() out of it.
+        const SpinLock::ScopedLockType sl (stateLock);
+        if (auto* script = getLatestScript())
+            script->save (block);
+    }
     if (block.getSize() > 0)
         state.setProperty ("data", block, nullptr);
     block.reset();
@@ -241,7 +632,7 @@ void ScriptNode::getState (MemoryBlock& out)
 
 void ScriptNode::setParameter (int index, float value)
 {
-    ScopedLock sl (lock);
+    ignoreUnused (index, value);
 }
 
 //==============================================================================
@@ -6,11 +6,10 @@
 #include "nodes/baseprocessor.hpp"
 #include <element/processor.hpp>
 #include "sol/sol.hpp"
+#include "scripting/dspscript.hpp"
 
 namespace element {
 
-class DSPScript;
-
 class ScriptNode : public Processor,
                    public ChangeBroadcaster
 {
@@ -29,8 +28,24 @@ public:
     void setState (const void* data, int size) override;
     void getState (MemoryBlock& block) override;
 
+    /** Compile a script and swap it in.  Compiling happens on the calling
+        thread, the audio thread picks the new script up without locking. */
     Result loadScript (const String&);
 
+    /** Compile a script on a background thread then swap it in.  The
+        callback is called on the message thread with the compile result. */
+    void loadScriptAsync (const String&, std::function<void (Result)> callback = nullptr);
+
+    /** Set how long the old and new script crossfade after a swap.  Zero
+        swaps instantly.  Only used when both scripts have the same ports. */
+    void setCrossfadeTime (double seconds);
+
+    /** Set the per-block budget of scripts, see DSPScript::setBudget. */
+    void setBudget (int instructions, double blockFraction);
+
+    /** Returns why the running script stopped, or an empty string. */
+    const String& getErrorMessage() const noexcept { return errorMessage; }
+
     CodeDocument& getCodeDocument (bool forEditor = false) { return forEditor ? edCode : dspCode; }
 
     /** Set a parameter value by index
@@ -55,18 +70,50 @@ protected:
     ParameterPtr getParameter (const PortDescription& port) override;
 
 private:
+    /** A compiled script with its own Lua state. */
+    struct Instance;
+    class Updater;
+    class CompileJob;
+    struct Compiler;
+
     CriticalSection lock;
-    sol::state lua;
     CodeDocument dspCode, edCode;
-    std::unique_ptr<DSPScript> script;
     ParameterArray inParams, outParams;
     StringArray printMessages;
+    std::unique_ptr<Updater> updater;
+    SharedResourcePointer<Compiler> compiler;
+    std::shared_ptr<bool> alive;
+
+    // owned by the audio thread while prepared, swapped in from pending.
+    std::atomic<Instance*> active { nullptr };
+    std::atomic<Instance*> pending { nullptr };
+    // replaced instances wait here for the message thread to delete them.
+    enum
+    {
+        numRetiredSlots = 4
+    };
+    std::atomic<Instance*> retired[numRetiredSlots];
+    Instance* fading = nullptr;
+    int fadePosition = 0;
+    std::atomic<int> fadeLength { 0 };
+    double crossfadeTime = 0.02;
+    int instructionBudget = DSPScript::defaultInstructionBudget;
+    double timeBudget = 1.0;
+    String errorMessage;
+    std::atomic<bool> failureReported { false };
+    // held by render() and by anything that calls into a live script.
+    SpinLock stateLock;
 
     int _program = 0;
 
     int blockSize = 512;
     double sampleRate = 44100.0;
     bool prepared = false;
+
+    std::unique_ptr<Instance> compile (const String& code, Result& result);
+    void install (std::unique_ptr<Instance>);
+    void retire (Instance*) noexcept;
+    DSPScript* getLatestScript() const noexcept;
 };
 
 } // namespace element
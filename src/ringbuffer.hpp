@@ -42,7 +42,9 @@ public:
 
     inline uint32 read (void* dest, uint32 size, bool advance = true)
     {
-        buffer = block.getData();
+        // locals so a reader and writer on different threads don't clobber each other.
+        Vec vec1, vec2;
+        auto* const buffer = block.getData();
         fifo.prepareToRead (size, vec1.index, vec1.size, vec2.index, vec2.size);
 
         if (vec1.size > 0)
@@ -70,7 +72,8 @@ public:
 
     inline uint32 write (const void* src, uint32 bytes)
     {
-        buffer = block.getData();
+        Vec vec1, vec2;
+        auto* const buffer = block.getData();
         fifo.prepareToWrite (bytes, vec1.index, vec1.size, vec2.index, vec2.size);
 
         if (vec1.size > 0)
@@ -102,10 +105,8 @@ private:
         int32 index;
     };
 
-    Vec vec1, vec2;
     juce::AbstractFifo fifo;
     juce::HeapBlock<uint8> block;
-    uint8* buffer;
 };
 
 } // namespace element
@@ -6,6 +6,7 @@
 #include <element/tags.hpp>
 
 #include "scripting/bindings.hpp"
+#include "scripting/luastatepool.hpp"
 #include "sol/sol.hpp"
 
 namespace element {
@@ -107,8 +108,7 @@ ScriptInfo ScriptInfo::read (lua_State* L, const String& buffer)
 
 ScriptInfo ScriptInfo::read (const String& buffer)
 {
-    sol::state lua;
-    element::Lua::initializeState (lua);
+    auto lua = LuaStatePool::acquire();
     return read (lua, buffer);
 }
 
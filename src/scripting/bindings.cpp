@@ -1,6 +1,7 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <cstring>
 #include <memory>
 
 #include <element/services.hpp>
@@ -15,6 +16,7 @@
 #include <element/ui/commands.hpp>
 
 #include "ui/systemtray.hpp"
+#include "scripting/bytecode.hpp"
 #include "scripting/scriptmanager.hpp"
 #include "session/presetmanager.hpp"
 #include "datapath.hpp"
@@ -34,8 +36,11 @@ extern int luaopen_el_audio (lua_State* L);
 extern int luaopen_el_bytes (lua_State*);
 extern int luaopen_el_midi (lua_State*);
 extern int luaopen_el_round (lua_State*);
+extern int luaopen_el_dsp (lua_State*);
+extern int luaopen_el_stats (lua_State*);
 extern int luaopen_el_AudioBuffer32 (lua_State*);
 extern int luaopen_el_AudioBuffer64 (lua_State*);
+extern int luaopen_el_Vector (lua_State*);
 extern int luaopen_el_Bounds (lua_State*);
 extern int luaopen_el_TextButton (lua_State*);
 extern int luaopen_el_Widget (lua_State*);
@@ -225,12 +230,14 @@ static String getLuaCPath()
 }
 
 //==============================================================================
-#define DEFINE_LUA_TXT_LOADER(pkgname)                                                                        \
-    static int load_el_##pkgname (lua_State* L)                                                               \
-    {                                                                                                         \
-        sol::state_view view (L);                                                                             \
-        sol::stack::push (L, view.script (LuaLib::pkgname##_lua, (String ("el.") + #pkgname).toStdString())); \
-        return 1;                                                                                             \
+#define DEFINE_LUA_TXT_LOADER(pkgname)                                                           \
+    static int load_el_##pkgname (lua_State* L)                                                  \
+    {                                                                                            \
+        const char* source = LuaLib::pkgname##_lua;                                              \
+        if (LuaBytecode::load (L, source, std::strlen (source), "=el." #pkgname) != LUA_OK)      \
+            return lua_error (L);                                                                \
+        lua_call (L, 0, 1);                                                                      \
+        return 1;                                                                                \
     }
 
 DEFINE_LUA_TXT_LOADER (AudioBuffer)
@@ -310,6 +317,18 @@ static int searchInternalModules (lua_State* L)
     {
         sol::stack::push (L, luaopen_el_round);
     }
+    else if (mod == "el.dsp")
+    {
+        sol::stack::push (L, luaopen_el_dsp);
+    }
+    else if (mod == "el.stats")
+    {
+        sol::stack::push (L, luaopen_el_stats);
+    }
+    else if (mod == "el.Vector")
+    {
+        sol::stack::push (L, luaopen_el_Vector);
+    }
     else if (mod == "el.AudioBuffer32" || mod == "kv.AudioBuffer32")
     {
         sol::stack::push (L, luaopen_el_AudioBuffer32);
@@ -0,0 +1,271 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include <element/datapath.hpp>
+#include <juce_cryptography/juce_cryptography.h>
+
+#include "scripting/bytecode.hpp"
+
+namespace element {
+namespace detail {
+
+#if defined(LUA_VERSION_RELEASE_NUM)
+static constexpr juce::uint32 bytecodeVersion = LUA_VERSION_RELEASE_NUM;
+#else
+static constexpr juce::uint32 bytecodeVersion = LUA_VERSION_NUM;
+#endif
+
+/** Compiled files start with this, the Lua version, the source hash, the
+    source size and a SHA-256 digest of the chunk name and source. */
+static constexpr char bytecodeMagic[4] = { 'E', 'L', 'B', 'C' };
+static constexpr size_t digestSize = 32;
+static constexpr size_t bytecodeHeaderSize = sizeof (bytecodeMagic) + sizeof (juce::uint32) + 2 * sizeof (juce::uint64) + digestSize;
+
+/** A compiled chunk and what it was compiled from, so a hash collision
+    can't hand out the wrong code. */
+struct CachedChunk
+{
+    std::string name;
+    std::string source;
+    std::string code;
+
+    bool matches (const char* src, size_t size, const char* chunkname) const noexcept
+    {
+        return source.size() == size && std::memcmp (source.data(), src, size) == 0 && name == chunkname;
+    }
+};
+
+struct BytecodeCache
+{
+    juce::CriticalSection lock;
+    std::unordered_map<juce::uint64, CachedChunk> chunks;
+    juce::File directory { DataPath::applicationCacheDir().getChildFile ("Bytecode") };
+};
+
+static BytecodeCache& bytecodeCache()
+{
+    static BytecodeCache cache;
+    return cache;
+}
+
+static juce::uint64 hashChunk (const char* source, size_t size, const char* chunkname)
+{
+    // 64-bit FNV-1a over the name, a separator and the source
+    juce::uint64 hash = 14695981039346656037ull;
+    for (const char* c = chunkname; *c != 0; ++c)
+        hash = (hash ^ (juce::uint8) *c) * 1099511628211ull;
+    hash = (hash ^ 0u) * 1099511628211ull;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ (juce::uint8) source[i]) * 1099511628211ull;
+    return hash;
+}
+
+/** A digest strong enough that a file with a matching one can be taken to
+    be compiled from this source. */
+static juce::MemoryBlock digestChunk (const char* source, size_t size, const char* chunkname)
+{
+    std::string data (chunkname);
+    data.push_back (0);
+    data.append (source, size);
+    return juce::SHA256 (data.data(), data.size()).getRawData();
+}
+
+static int writeChunk (lua_State*, const void* data, size_t size, void* ud)
+{
+    static_cast<std::string*> (ud)->append (static_cast<const char*> (data), size);
+    return 0;
+}
+
+static juce::File getCacheFile (const juce::File& dir, juce::uint64 key)
+{
+    return dir.getChildFile (juce::String::toHexString ((juce::int64) key) + "-"
+                             + juce::String (bytecodeVersion) + ".luac");
+}
+
+/** Returns the bytecode in a compiled file if it was made from this source. */
+static bool readCompiled (const juce::File& file, juce::uint64 key, size_t sourceSize,
+                          const juce::MemoryBlock& digest, std::string& code)
+{
+    if (! file.existsAsFile())
+        return false;
+
+    juce::MemoryBlock data;
+    if (! file.loadFileAsData (data) || data.getSize() <= bytecodeHeaderSize)
+        return false;
+
+    juce::MemoryInputStream in (data, false);
+    char magic[sizeof (bytecodeMagic)];
+    in.read (magic, sizeof (magic));
+    const auto version = (juce::uint32) in.readInt();
+    const auto hash = (juce::uint64) in.readInt64();
+    const auto size = (juce::uint64) in.readInt64();
+    if (std::memcmp (magic, bytecodeMagic, sizeof (magic)) != 0 || version != bytecodeVersion
+        || hash != key || size != (juce::uint64) sourceSize)
+        return false;
+
+    // the hash and size only rule files out cheaply, this decides.
+    if (digest.getSize() != digestSize
+        || std::memcmp (static_cast<const char*> (data.getData()) + bytecodeHeaderSize - digestSize,
+                        digest.getData(), digestSize) != 0)
+        return false;
+
+    code.assign (static_cast<const char*> (data.getData()) + bytecodeHeaderSize,
+                 data.getSize() - bytecodeHeaderSize);
+    return true;
+}
+
+static bool writeCompiled (const juce::File& file, juce::uint64 key, size_t sourceSize,
+                           const juce::MemoryBlock& digest, const std::string& code)
+{
+    if (digest.getSize() != digestSize)
+        return false;
+
+    if (! file.getParentDirectory().createDirectory())
+        return false;
+
+    juce::TemporaryFile tempFile (file);
+    if (auto out = tempFile.getFile().createOutputStream())
+    {
+        out->write (bytecodeMagic, sizeof (bytecodeMagic));
+        out->writeInt ((int) bytecodeVersion);
+        out->writeInt64 ((juce::int64) key);
+        out->writeInt64 ((juce::int64) sourceSize);
+        out->write (digest.getData(), digestSize);
+        out->write (code.data(), code.size());
+
+        const bool ok = out->getStatus().wasOk();
+        out.reset();
+        return ok && tempFile.overwriteTargetFileWithTemporary();
+    }
+
+    return false;
+}
+
+/** Delete the least recently used files until the cache fits. */
+static void trimDirectory (const juce::File& dir, juce::int64 maxBytes)
+{
+    auto files = dir.findChildFiles (juce::File::findFiles, false, "*.luac");
+    juce::int64 total = 0;
+    for (const auto& file : files)
+        total += file.getSize();
+    if (total <= maxBytes)
+        return;
+
+    std::sort (files.begin(), files.end(), [] (const juce::File& a, const juce::File& b) {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (const auto& file : files)
+    {
+        if (total <= maxBytes)
+            break;
+        total -= file.getSize();
+        file.deleteFile();
+    }
+}
+
+} // namespace detail
+
+int LuaBytecode::load (lua_State* L, const char* source, size_t size, const char* chunkname)
+{
+    auto& cache = detail::bytecodeCache();
+    const auto key = detail::hashChunk (source, size, chunkname);
+    juce::File directory;
+
+    {
+        const juce::ScopedLock sl (cache.lock);
+        directory = cache.directory;
+        auto it = cache.chunks.find (key);
+        if (it != cache.chunks.end() && it->second.matches (source, size, chunkname))
+        {
+            const auto& code = it->second.code;
+            const auto status = luaL_loadbufferx (L, code.data(), code.size(), chunkname, "b");
+            if (status == LUA_OK)
+                return status;
+            lua_pop (L, 1);
+            cache.chunks.erase (it);
+        }
+    }
+
+    const auto compiled = directory != juce::File() ? detail::getCacheFile (directory, key) : juce::File();
+    const auto digest = compiled != juce::File() ? detail::digestChunk (source, size, chunkname) : juce::MemoryBlock();
+    if (compiled != juce::File())
+    {
+        std::string code;
+        if (detail::readCompiled (compiled, key, size, digest, code))
+        {
+            if (luaL_loadbufferx (L, code.data(), code.size(), chunkname, "b") == LUA_OK)
+            {
+                // recently used files are the last to be trimmed.
+                compiled.setLastModificationTime (juce::Time::getCurrentTime());
+
+                const juce::ScopedLock sl (cache.lock);
+                if ((int) cache.chunks.size() >= maxEntries)
+                    cache.chunks.clear();
+                cache.chunks[key] = { chunkname, std::string (source, size), std::move (code) };
+                return LUA_OK;
+            }
+
+            lua_pop (L, 1);
+        }
+    }
+
+    const auto status = luaL_loadbufferx (L, source, size, chunkname, "t");
+    if (status != LUA_OK)
+        return status;
+
+    // keep debug info so errors still report line numbers
+    std::string code;
+    if (lua_dump (L, detail::writeChunk, &code, 0) == 0 && ! code.empty())
+    {
+        if (compiled != juce::File())
+        {
+            if (detail::writeCompiled (compiled, key, size, digest, code))
+                detail::trimDirectory (directory, maxDiskBytes);
+            else
+                std::clog << "[element] could not write " << compiled.getFullPathName() << std::endl;
+        }
+
+        const juce::ScopedLock sl (cache.lock);
+        if ((int) cache.chunks.size() >= maxEntries)
+            cache.chunks.clear();
+        cache.chunks[key] = { chunkname, std::string (source, size), std::move (code) };
+    }
+
+    return status;
+}
+
+int LuaBytecode::getNumEntries()
+{
+    auto& cache = detail::bytecodeCache();
+    const juce::ScopedLock sl (cache.lock);
+    return (int) cache.chunks.size();
+}
+
+void LuaBytecode::clear()
+{
+    auto& cache = detail::bytecodeCache();
+    const juce::ScopedLock sl (cache.lock);
+    cache.chunks.clear();
+}
+
+juce::File LuaBytecode::getCacheDirectory()
+{
+    auto& cache = detail::bytecodeCache();
+    const juce::ScopedLock sl (cache.lock);
+    return cache.directory;
+}
+
+void LuaBytecode::setCacheDirectory (const juce::File& directory)
+{
+    auto& cache = detail::bytecodeCache();
+    const juce::ScopedLock sl (cache.lock);
+    cache.directory = directory;
+}
+
+} // namespace element
@@ -0,0 +1,59 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <cstddef>
+
+#include <element/juce/core.hpp>
+
+#include "sol/sol.hpp"
+
+namespace element {
+
+/** Compiled Lua chunks shared by every state in the process.
+
+    The first load of a chunk compiles it and keeps the dumped bytecode,
+    later loads of the same source and chunk name skip the parser.  Chunks
+    are keyed by a hash of both and keep a copy of the source, which is
+    compared before cached code is used.  Editing a script simply adds a
+    new entry.
+
+    Compiled chunks are also written to the application cache directory,
+    named by the hash and the Lua version, so they survive restarts.  A file
+    is used only if its header has the same Lua version, hash, source size
+    and SHA-256 digest of the chunk name and source.  The least recently used files are deleted once the directory
+    grows past maxDiskBytes.  Lua doesn't verify bytecode, so compiled files
+    are trusted like the scripts they were made from.
+ */
+class LuaBytecode
+{
+public:
+    /** Load a chunk like luaL_loadbufferx.  On success the function is
+        pushed and LUA_OK returned, otherwise the error message is pushed
+        and the Lua status returned. */
+    static int load (lua_State* L, const char* source, size_t size, const char* chunkname);
+
+    /** Returns the number of cached chunks in memory. */
+    static int getNumEntries();
+
+    /** Forget all cached chunks in memory.  Files on disk are kept. */
+    static void clear();
+
+    /** Returns the directory compiled chunks are written to. */
+    static juce::File getCacheDirectory();
+
+    /** Change the cache directory. An invalid file disables the disk cache. */
+    static void setCacheDirectory (const juce::File& directory);
+
+    /** The memory cache is cleared when it grows past this many chunks. */
+    static constexpr int maxEntries = 512;
+
+    /** Compiled files on disk are trimmed to this many bytes. */
+    static constexpr juce::int64 maxDiskBytes = 32 * 1024 * 1024;
+
+private:
+    LuaBytecode() = delete;
+};
+
+} // namespace element
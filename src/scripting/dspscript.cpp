@@ -11,6 +11,18 @@
 using namespace element;
 namespace element {
 
+/** Kilobytes of garbage collection work done after each processed block. */
+static constexpr int gcStepSize = 4;
+
+/** Instructions between budget checks while a script processes. */
+static constexpr int budgetCheckInterval = 1000;
+
+/** Raised from the budget hook. Pushing it doesn't allocate. */
+static char overBudgetTag;
+
+/** The script processing on this thread, for the budget hook. */
+static thread_local DSPScript* processingScript = nullptr;
+
 //==============================================================================
 struct DSPScriptPosition
 {
@@ -304,6 +316,7 @@ DSPScript::DSPScript (sol::table tbl)
     {
         L = DSP.lua_state();
         ok = L != nullptr;
+        arena = LuaArena::fromState (L);
     }
 
     if (ok)
@@ -383,6 +396,9 @@ DSPScript::DSPScript (sol::table tbl)
     {
         addAudioMidiPorts();
         addParameterPorts();
+
+        // grow the pipe now so swapping buffers in process() never allocates
+        (*midi)->setSize (jmax (4, ports.size (PortType::Midi, true), ports.size (PortType::Midi, false)));
     }
 
     if (ok)
@@ -536,18 +552,63 @@ void DSPScript::process (AudioSampleBuffer& a, MidiPipe& m)
                             if (playhead != nullptr)
                                 (*position)->update (playhead->getPosition());
 
-                            try
+                            const auto start = Time::getHighResolutionTicks();
+                            const double blockTicks = ticksPerSample * a.getNumSamples();
+                            const int maxInstructions = instructionBudget.load (std::memory_order_relaxed);
+                            const double maxTime = timeBudget.load (std::memory_order_relaxed);
+                            const bool limited = maxInstructions > 0;
+                            if (limited)
                             {
-                                lua_call (L, 5, 0);
-                            } catch (const sol::error& e)
+                                instructionsLeft = maxInstructions;
+                                processingScript = this;
+                                lua_sethook (L, &DSPScript::budgetHook, LUA_MASKCOUNT, budgetCheckInterval);
+                            }
+
+                            LuaArena::ScopedRealtime realtime (arena);
+                            const int status = lua_pcall (L, 5, 0, 0);
+
+                            if (limited)
+                            {
+                                lua_sethook (L, nullptr, 0, 0);
+                                processingScript = nullptr;
+                            }
+
+                            if (status != LUA_OK)
                             {
-                                std::clog << e.what() << std::endl;
+                                // converting the message could allocate, the
+                                // owner reports the failure off this thread.
+                                auto reason = status == LUA_ERRMEM ? Failure::outOfMemory : Failure::runtime;
+                                if (lua_touserdata (L, -1) == &overBudgetTag)
+                                    reason = Failure::overBudget;
+                                lua_pop (L, 1);
+                                failure.store (reason, std::memory_order_relaxed);
                                 loaded = false;
                             }
                             (*midi)->swapWith (m);
 
+                            if (blockTicks > 0.0)
+                            {
+                                const auto load = (float) ((double) (Time::getHighResolutionTicks() - start) / blockTicks);
+                                const auto smoothed = cpuLoad.load (std::memory_order_relaxed);
+                                cpuLoad.store (smoothed + 0.1f * (load - smoothed), std::memory_order_relaxed);
+
+                                // only a script which is slow block after
+                                // block is stopped for taking too long.
+                                overruns = maxTime > 0.0 && load > maxTime ? overruns + 1 : 0;
+                                if (loaded && overruns >= maxConsecutiveOverruns)
+                                {
+                                    failure.store (Failure::overBudget, std::memory_order_relaxed);
+                                    loaded = false;
+                                }
+                            }
+
                             for (int ci = outParams.size(); --ci >= 0;)
                                 outParams.getUnchecked (ci)->update (controlData[ci]);
+
+                            // the collector is stopped, so garbage is only
+                            // collected here in small steps.
+                            if (loaded)
+                                lua_gc (L, LUA_GCSTEP, gcStepSize);
                         }
                     }
                 }
@@ -560,6 +621,20 @@ void DSPScript::process (AudioSampleBuffer& a, MidiPipe& m)
     }
 }
 
+void DSPScript::budgetHook (lua_State* L, lua_Debug*)
+{
+    auto* self = processingScript;
+    if (self == nullptr)
+        return;
+
+    self->instructionsLeft -= budgetCheckInterval;
+    if (self->instructionsLeft <= 0)
+    {
+        lua_pushlightuserdata (L, &overBudgetTag);
+        lua_error (L);
+    }
+}
+
 void DSPScript::save (MemoryBlock& out)
 {
     ValueTree state ("DSP");
@@ -9,6 +9,7 @@
 #include <element/juce/core.hpp>
 #include <element/juce/audio_basics.hpp>
 
+#include "scripting/luaarena.hpp"
 #include "scripting/scriptinstance.hpp"
 
 namespace element {
@@ -36,9 +37,45 @@ public:
     /** Returns true if the script loaded ok */
     bool isValid() const noexcept { return loaded; }
 
+    /** Why processing stopped, if it did. */
+    enum class Failure
+    {
+        none,
+        outOfMemory,
+        runtime,
+        overBudget
+    };
+
+    /** Returns the reason process() stopped running the script. */
+    Failure getFailure() const noexcept { return failure.load (std::memory_order_relaxed); }
+
+    /** Limit the work process() may do per block.  A script that goes over
+        is stopped with Failure::overBudget.
+
+        The instruction count is a hard limit, a block that runs past it is
+        stopped right away.  The time limit only stops the script after
+        maxConsecutiveOverruns blocks in a row take too long, so a single
+        slow block, like one preempted by the system, doesn't bypass it.
+
+        @param instructions Lua VM instructions per block, zero for no limit
+        @param blockFraction Wall clock time allowed as a fraction of the
+                             block's duration, zero for no limit
+     */
+    void setBudget (int instructions, double blockFraction) noexcept
+    {
+        instructionBudget = juce::jmax (0, instructions);
+        timeBudget = juce::jmax (0.0, blockFraction);
+    }
+
+    /** Time spent in process() relative to the duration of the audio
+        processed, smoothed over a few blocks. */
+    float getCpuLoad() const noexcept { return cpuLoad.load (std::memory_order_relaxed); }
+
     //==========================================================================
     void prepare (double rate, int block)
     {
+        ticksPerSample = (double) juce::Time::getHighResolutionTicksPerSecond() / rate;
+        overruns = 0;
         if (sol::function f = DSP["prepare"])
             f (rate, block);
     }
@@ -60,6 +97,14 @@ public:
     const PortList& getPorts() const { return ports; }
     void getPorts (PortList& out);
 
+    //==========================================================================
+    /** Instructions a script may run per block by default. */
+    static constexpr int defaultInstructionBudget = 10000000;
+
+    /** Blocks in a row which may go over the time budget before the script
+        is stopped. */
+    static constexpr int maxConsecutiveOverruns = 8;
+
     //==========================================================================
     int getNumParameters (bool input = true) const { return input ? numParams : numControls; }
     element::ParameterPtr getParameterObject (int index, bool input = true) const;
@@ -82,7 +127,15 @@ private:
     int positionRef = LUA_REFNIL;
 
     lua_State* L = nullptr;
+    LuaArena* arena = nullptr;
     bool loaded = false;
+    std::atomic<Failure> failure { Failure::none };
+    std::atomic<int> instructionBudget { defaultInstructionBudget };
+    std::atomic<double> timeBudget { 1.0 };
+    double ticksPerSample = 0.0;
+    int instructionsLeft = 0;
+    int overruns = 0;
+    std::atomic<float> cpuLoad { 0.f };
     int numParams = 0, // input params
         numControls = 0; // output params
     enum
@@ -101,6 +154,7 @@ private:
     struct Context;
     struct Position;
 
+    static void budgetHook (lua_State*, lua_Debug*);
     void deref();
     void getParameterData (juce::MemoryBlock&, bool);
     void setParameterData (juce::MemoryBlock&, bool);
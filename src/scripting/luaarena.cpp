@@ -0,0 +1,262 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <cstdlib>
+#include <cstring>
+
+#include "scripting/luaarena.hpp"
+
+namespace element {
+
+static int getSizeClass (size_t size, int minShift)
+{
+    int shift = minShift;
+    while (((size_t) 1 << shift) < size)
+        ++shift;
+    return shift - minShift;
+}
+
+LuaArena::LuaArena (size_t size)
+    : poolSize (size)
+{
+    addPool (poolSize);
+}
+
+LuaArena::~LuaArena()
+{
+    releaseDeferred();
+}
+
+void* LuaArena::allocate (void* ud, void* ptr, size_t osize, size_t nsize)
+{
+    auto& arena = *static_cast<LuaArena*> (ud);
+
+    if (nsize == 0)
+    {
+        if (ptr != nullptr)
+            arena.freeBlock (ptr, osize);
+        return nullptr;
+    }
+
+    // when ptr is null, osize is the kind of object being created.
+    if (ptr == nullptr)
+        return arena.allocateBlock (nsize);
+
+    if (osize <= maxBlockSize && nsize <= maxBlockSize
+        && getSizeClass (osize, minShift) == getSizeClass (nsize, minShift))
+        return ptr;
+
+    if (osize > maxBlockSize && nsize > maxBlockSize && ! arena.realtime)
+    {
+        if (auto* newPtr = std::realloc (ptr, nsize))
+        {
+            arena.used.fetch_add (nsize, std::memory_order_relaxed);
+            arena.used.fetch_sub (osize, std::memory_order_relaxed);
+            return newPtr;
+        }
+        return nullptr;
+    }
+
+    auto* newPtr = arena.allocateBlock (nsize);
+    if (newPtr == nullptr)
+    {
+        if (nsize > osize)
+            return nullptr;
+
+        // Lua expects shrinking to always succeed. Keep the old block, from
+        // now on it is freed as the smaller size. A large block kept this
+        // way came from the system allocator, so note it and free it as a
+        // large block later on instead of adding it to a free list.
+        if (osize > maxBlockSize && nsize <= maxBlockSize)
+            ++arena.numKeptLarge;
+        arena.used.fetch_sub (arena.getBlockSize (osize) - arena.getBlockSize (nsize), std::memory_order_relaxed);
+        return ptr;
+    }
+
+    std::memcpy (newPtr, ptr, std::min (osize, nsize));
+    arena.freeBlock (ptr, osize);
+    return newPtr;
+}
+
+LuaArena* LuaArena::fromState (lua_State* L) noexcept
+{
+    void* ud = nullptr;
+    return L != nullptr && lua_getallocf (L, &ud) == &LuaArena::allocate
+               ? static_cast<LuaArena*> (ud)
+               : nullptr;
+}
+
+size_t LuaArena::getBlockSize (size_t size) const noexcept
+{
+    return size > maxBlockSize ? size : (size_t) 1 << (getSizeClass (size, minShift) + minShift);
+}
+
+void LuaArena::reserve (size_t numBytes)
+{
+    releaseDeferred();
+    if ((size_t) (end - cursor) < numBytes)
+        addPool (numBytes);
+}
+
+void LuaArena::releaseDeferred()
+{
+    while (auto* block = deferred)
+    {
+        deferred = block->next;
+        std::free (block);
+    }
+
+    deferredBytes.store (0, std::memory_order_relaxed);
+}
+
+void* LuaArena::allocateBlock (size_t size)
+{
+    if (size > maxBlockSize)
+    {
+        if (! realtime)
+            releaseDeferred();
+
+        void* block = realtime ? nullptr : std::malloc (size);
+        if (block == nullptr)
+        {
+            failures.fetch_add (1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        used.fetch_add (size, std::memory_order_relaxed);
+        return block;
+    }
+
+    const int sizeClass = getSizeClass (size, minShift);
+    const size_t blockSize = (size_t) 1 << (sizeClass + minShift);
+
+    if (auto* block = freeLists[sizeClass])
+    {
+        freeLists[sizeClass] = block->next;
+        used.fetch_add (blockSize, std::memory_order_relaxed);
+        return block;
+    }
+
+    if ((size_t) (end - cursor) < blockSize)
+    {
+        if (auto* block = splitLargerBlock (sizeClass))
+        {
+            used.fetch_add (blockSize, std::memory_order_relaxed);
+            return block;
+        }
+
+        if (realtime)
+        {
+            failures.fetch_add (1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        addPool (blockSize);
+    }
+
+    auto* block = cursor;
+    cursor += blockSize;
+    used.fetch_add (blockSize, std::memory_order_relaxed);
+    return block;
+}
+
+void LuaArena::freeBlock (void* ptr, size_t size)
+{
+    if (size > maxBlockSize)
+    {
+        used.fetch_sub (size, std::memory_order_relaxed);
+
+        // large blocks are only allocated outside of realtime mode, so what
+        // waits here is bounded by that.
+        if (realtime)
+        {
+            auto* block = static_cast<FreeBlock*> (ptr);
+            block->next = deferred;
+            deferred = block;
+            deferredBytes.fetch_add (size, std::memory_order_relaxed);
+        }
+        else
+        {
+            releaseDeferred();
+            std::free (ptr);
+        }
+        return;
+    }
+
+    const int sizeClass = getSizeClass (size, minShift);
+    const size_t blockSize = (size_t) 1 << (sizeClass + minShift);
+    auto* block = static_cast<FreeBlock*> (ptr);
+    used.fetch_sub (blockSize, std::memory_order_relaxed);
+
+    if (numKeptLarge > 0 && ! isInPool (ptr))
+    {
+        --numKeptLarge;
+        block->next = deferred;
+        deferred = block;
+        deferredBytes.fetch_add (blockSize, std::memory_order_relaxed);
+        if (! realtime)
+            releaseDeferred();
+        return;
+    }
+
+    block->next = freeLists[sizeClass];
+    freeLists[sizeClass] = block;
+}
+
+bool LuaArena::isInPool (const void* ptr) const noexcept
+{
+    auto* p = static_cast<const char*> (ptr);
+    for (const auto& pool : pools)
+        if (p >= pool.data.get() && p < pool.data.get() + pool.size)
+            return true;
+    return false;
+}
+
+void* LuaArena::splitLargerBlock (int sizeClass)
+{
+    int larger = sizeClass + 1;
+    while (larger < numClasses && freeLists[larger] == nullptr)
+        ++larger;
+    if (larger >= numClasses)
+        return nullptr;
+
+    auto* block = reinterpret_cast<char*> (freeLists[larger]);
+    freeLists[larger] = freeLists[larger]->next;
+
+    // keep the first part, return the halves above it to their free lists.
+    while (--larger >= sizeClass)
+    {
+        auto* half = reinterpret_cast<FreeBlock*> (block + ((size_t) 1 << (larger + minShift)));
+        half->next = freeLists[larger];
+        freeLists[larger] = half;
+    }
+
+    return block;
+}
+
+void LuaArena::addPool (size_t minSize)
+{
+    // hand what's left of the current pool to the free lists.
+    for (int sizeClass = numClasses; --sizeClass >= 0;)
+    {
+        const size_t blockSize = (size_t) 1 << (sizeClass + minShift);
+        while ((size_t) (end - cursor) >= blockSize)
+        {
+            auto* block = reinterpret_cast<FreeBlock*> (cursor);
+            block->next = freeLists[sizeClass];
+            freeLists[sizeClass] = block;
+            cursor += blockSize;
+        }
+    }
+
+    const auto size = std::max (poolSize, minSize);
+    pools.push_back ({ std::make_unique<char[]> (size), size });
+
+    // make_unique zero fills, so the pages are touched now and not on the
+    // audio thread.
+    cursor = pools.back().data.get();
+    end = cursor + size;
+    capacity += size;
+}
+
+} // namespace element
@@ -0,0 +1,133 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "sol/sol.hpp"
+
+namespace element {
+
+/** A preallocated lua_Alloc for scripts that run on the audio thread.
+
+    Blocks come from size classes with free lists carved out of pools the
+    arena owns, so allocating and freeing never calls into the system
+    allocator while realtime mode is on.  Outside of realtime mode the arena
+    grows by adding pools. In realtime mode a request it can't serve fails:
+    Lua raises a memory error and the failure is counted so it can be
+    reported later.
+
+    Blocks too large for the size classes come from the system allocator
+    and can only be allocated outside of realtime mode.  Freeing one in
+    realtime mode puts it on a deferred list instead, which is released
+    the next time the arena is used outside of realtime mode.  The same
+    goes for a large block that had to be kept when Lua shrank it to a
+    size class in realtime mode.
+ */
+class LuaArena
+{
+public:
+    explicit LuaArena (size_t poolSize = defaultPoolSize);
+    ~LuaArena();
+
+    /** The lua_Alloc function, pass the arena as its user data. */
+    static void* allocate (void* ud, void* ptr, size_t osize, size_t nsize);
+
+    /** Returns the arena used by a Lua state, or nullptr if it uses some
+        other allocator. */
+    static LuaArena* fromState (lua_State* L) noexcept;
+
+    /** Make sure at least this many bytes can be handed out without adding
+        a pool. Also releases deferred blocks. Don't call this on the audio
+        thread. */
+    void reserve (size_t numBytes);
+
+    /** Give large blocks freed in realtime mode back to the system. Don't
+        call this on the audio thread. */
+    void releaseDeferred();
+
+    /** Returns the number of bytes currently handed out to Lua. */
+    size_t getNumBytesUsed() const noexcept { return used.load (std::memory_order_relaxed); }
+
+    /** Returns the number of bytes waiting in the deferred list. */
+    size_t getNumBytesDeferred() const noexcept { return deferredBytes.load (std::memory_order_relaxed); }
+
+    /** Returns the total size of all pools. */
+    size_t getCapacity() const noexcept { return capacity; }
+
+    /** Returns how many allocations failed since the last reset. */
+    int getNumFailures() const noexcept { return failures.load (std::memory_order_relaxed); }
+    void resetFailures() noexcept { failures.store (0, std::memory_order_relaxed); }
+
+    /** Puts an arena in realtime mode for the current scope. */
+    class ScopedRealtime
+    {
+    public:
+        explicit ScopedRealtime (LuaArena* a) noexcept
+            : arena (a)
+        {
+            if (arena != nullptr)
+            {
+                wasRealtime = arena->realtime;
+                arena->realtime = true;
+            }
+        }
+
+        ~ScopedRealtime()
+        {
+            if (arena != nullptr)
+                arena->realtime = wasRealtime;
+        }
+
+    private:
+        LuaArena* arena;
+        bool wasRealtime = false;
+    };
+
+    static constexpr size_t defaultPoolSize = 1 << 20;
+
+private:
+    static constexpr int minShift = 4;
+    static constexpr int maxShift = 20;
+    static constexpr int numClasses = maxShift - minShift + 1;
+    static constexpr size_t maxBlockSize = (size_t) 1 << maxShift;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct Pool
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    FreeBlock* freeLists[numClasses] = {};
+    FreeBlock* deferred = nullptr;
+    std::vector<Pool> pools;
+    char* cursor = nullptr;
+    char* end = nullptr;
+    const size_t poolSize;
+    size_t capacity = 0;
+    std::atomic<size_t> used { 0 };
+    std::atomic<size_t> deferredBytes { 0 };
+    bool realtime = false;
+    int numKeptLarge = 0;
+    std::atomic<int> failures { 0 };
+
+    size_t getBlockSize (size_t size) const noexcept;
+    void* allocateBlock (size_t size);
+    void freeBlock (void* ptr, size_t size);
+    bool isInPool (const void* ptr) const noexcept;
+    void* splitLargerBlock (int sizeClass);
+    void addPool (size_t minSize);
+
+    LuaArena (const LuaArena&) = delete;
+    LuaArena& operator= (const LuaArena&) = delete;
+};
+
+} // namespace element
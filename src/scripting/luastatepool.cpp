@@ -0,0 +1,195 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include "scripting/bindings.hpp"
+#include "scripting/luastatepool.hpp"
+
+namespace element {
+namespace detail {
+
+/** Modules every pooled state loads up front. */
+static const char* const preloadedModules[] = {
+    "el.audio",
+    "el.midi",
+    "el.bytes",
+    "el.round",
+    "el.dsp",
+    "el.Vector",
+    "el.AudioBuffer",
+    "el.MidiBuffer",
+    "el.MidiMessage",
+    "el.MidiPipe",
+    "el.object",
+    "el.script",
+    "el.strings"
+};
+
+/** Copy a table's fields into a new table on the stack. */
+static void copyTable (lua_State* L, int index)
+{
+    index = lua_absindex (L, index);
+    lua_newtable (L);
+    lua_pushnil (L);
+    while (lua_next (L, index) != 0)
+    {
+        lua_pushvalue (L, -2);
+        lua_insert (L, -2);
+        lua_rawset (L, -4);
+    }
+}
+
+/** Make the table at index hold exactly the fields of the saved table. */
+static void restoreTable (lua_State* L, int index, int saved)
+{
+    index = lua_absindex (L, index);
+    saved = lua_absindex (L, saved);
+
+    // clearing fields during traversal is allowed, adding them isn't
+    lua_pushnil (L);
+    while (lua_next (L, index) != 0)
+    {
+        lua_pop (L, 1);
+        lua_pushvalue (L, -1);
+        if (lua_rawget (L, saved) == LUA_TNIL)
+        {
+            lua_pushvalue (L, -2);
+            lua_pushnil (L);
+            lua_rawset (L, index);
+        }
+        lua_pop (L, 1);
+    }
+
+    lua_pushnil (L);
+    while (lua_next (L, saved) != 0)
+    {
+        lua_pushvalue (L, -2);
+        lua_insert (L, -2);
+        lua_rawset (L, index);
+    }
+}
+
+} // namespace detail
+
+//==============================================================================
+struct LuaStatePool::Handle::Entry
+{
+    Entry()
+    {
+        sol::state_view view (lua);
+        Lua::initializeState (view);
+
+        lua_State* L = lua.lua_state();
+        for (const auto* mod : detail::preloadedModules)
+        {
+            lua_getglobal (L, "require");
+            lua_pushstring (L, mod);
+            if (lua_pcall (L, 1, 0, 0) != LUA_OK)
+            {
+                std::clog << "[element] lua pool: could not preload " << mod << ": "
+                          << lua_tostring (L, -1) << std::endl;
+                lua_pop (L, 1);
+            }
+        }
+
+        // snapshot = { globals, package.loaded }
+        lua_createtable (L, 2, 0);
+        lua_pushglobaltable (L);
+        detail::copyTable (L, -1);
+        lua_rawseti (L, -3, 1);
+        lua_pop (L, 1);
+        lua_getfield (L, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
+        detail::copyTable (L, -1);
+        lua_rawseti (L, -3, 2);
+        lua_pop (L, 1);
+        snapshotRef = luaL_ref (L, LUA_REGISTRYINDEX);
+    }
+
+    /** Put globals and loaded packages back and collect garbage. */
+    void reset()
+    {
+        lua_State* L = lua.lua_state();
+        lua_settop (L, 0);
+        lua_sethook (L, nullptr, 0, 0);
+
+        lua_rawgeti (L, LUA_REGISTRYINDEX, snapshotRef);
+        lua_pushglobaltable (L);
+        lua_pushnil (L);
+        lua_setmetatable (L, -2);
+        lua_rawgeti (L, 1, 1);
+        detail::restoreTable (L, -2, -1);
+        lua_pop (L, 2);
+
+        lua_getfield (L, LUA_REGISTRYINDEX, LUA_LOADED_TABLE);
+        lua_rawgeti (L, 1, 2);
+        detail::restoreTable (L, -2, -1);
+        lua_settop (L, 0);
+
+        lua.collect_garbage();
+    }
+
+    int getKilobytesUsed() { return lua_gc (lua.lua_state(), LUA_GCCOUNT, 0); }
+
+    sol::state lua;
+    int snapshotRef { LUA_NOREF };
+};
+
+//==============================================================================
+LuaStatePool::Handle::Handle (juce::SharedResourcePointer<LuaStatePool> p, std::unique_ptr<Entry> e)
+    : pool (std::make_unique<juce::SharedResourcePointer<LuaStatePool>> (p)),
+      entry (std::move (e)) {}
+
+LuaStatePool::Handle::Handle (Handle&&) = default;
+LuaStatePool::Handle& LuaStatePool::Handle::operator= (Handle&&) = default;
+
+LuaStatePool::Handle::~Handle()
+{
+    if (pool != nullptr && entry != nullptr)
+        (*pool)->release (std::move (entry));
+}
+
+lua_State* LuaStatePool::Handle::get() const noexcept
+{
+    return entry != nullptr ? entry->lua.lua_state() : nullptr;
+}
+
+//==============================================================================
+LuaStatePool::LuaStatePool() = default;
+LuaStatePool::~LuaStatePool() = default;
+
+LuaStatePool::Handle LuaStatePool::acquire()
+{
+    juce::SharedResourcePointer<LuaStatePool> pool;
+    std::unique_ptr<Handle::Entry> entry;
+    {
+        std::lock_guard<std::mutex> sl (pool->lock);
+        if (! pool->idle.empty())
+        {
+            entry = std::move (pool->idle.back());
+            pool->idle.pop_back();
+        }
+    }
+
+    if (entry == nullptr)
+        entry = std::make_unique<Handle::Entry>();
+
+    return Handle (pool, std::move (entry));
+}
+
+int LuaStatePool::getNumIdle()
+{
+    std::lock_guard<std::mutex> sl (lock);
+    return (int) idle.size();
+}
+
+void LuaStatePool::release (std::unique_ptr<Handle::Entry> entry)
+{
+    entry->reset();
+    if (entry->getKilobytesUsed() > maxIdleKilobytes)
+        return;
+
+    std::lock_guard<std::mutex> sl (lock);
+    if ((int) idle.size() < maxIdle)
+        idle.push_back (std::move (entry));
+}
+
+} // namespace element
@@ -0,0 +1,71 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <element/juce/core.hpp>
+
+#include "sol/sol.hpp"
+
+namespace element {
+
+/** Ready to use Lua states for short lived work like reading script info
+    or validating code.
+
+    States are initialized with the element package searchers once and the
+    common el.* modules are loaded up front.  When a handle goes out of scope
+    its globals and package.loaded are put back the way they were after
+    initialization and the state goes back to the pool.  Module tables
+    themselves are shared between uses, so scripts shouldn't modify them.
+
+    Handles keep the pool alive and can be used from any thread, but a
+    single handle must only be used by one thread at a time.
+ */
+class LuaStatePool
+{
+public:
+    LuaStatePool();
+    ~LuaStatePool();
+
+    class Handle
+    {
+    public:
+        Handle (Handle&&);
+        Handle& operator= (Handle&&);
+        ~Handle();
+
+        lua_State* get() const noexcept;
+        operator lua_State*() const noexcept { return get(); }
+        sol::state_view view() const noexcept { return sol::state_view (get()); }
+
+    private:
+        friend class LuaStatePool;
+        struct Entry;
+        Handle (juce::SharedResourcePointer<LuaStatePool>, std::unique_ptr<Entry>);
+        std::unique_ptr<juce::SharedResourcePointer<LuaStatePool>> pool;
+        std::unique_ptr<Entry> entry;
+        JUCE_DECLARE_NON_COPYABLE (Handle)
+    };
+
+    /** Take a state from the shared pool, creating one if none are idle. */
+    static Handle acquire();
+
+    /** Returns the number of states waiting in the pool. */
+    int getNumIdle();
+
+    /** Idle states beyond this are closed instead of kept. */
+    static constexpr int maxIdle = 4;
+    /** States using more memory than this after a reset are closed. */
+    static constexpr int maxIdleKilobytes = 8 * 1024;
+
+private:
+    std::mutex lock;
+    std::vector<std::unique_ptr<Handle::Entry>> idle;
+    void release (std::unique_ptr<Handle::Entry>);
+};
+
+} // namespace element
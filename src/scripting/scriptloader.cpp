@@ -1,8 +1,11 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <cstring>
+
 #include "sol/sol.hpp"
 #include "scripting/bindings.hpp"
+#include "scripting/bytecode.hpp"
 #include <element/script.hpp>
 #include "scripting/scriptloader.hpp"
 
@@ -11,14 +14,9 @@ using namespace juce;
 
 ScriptLoader::ScriptLoader (lua_State* state)
 {
-    ownedstate = state == nullptr;
-    L = ownedstate ? luaL_newstate() : state;
-    sol::state_view view (L);
-
-    if (ownedstate)
-    {
-        Lua::initializeState (view);
-    }
+    if (state == nullptr)
+        pooled = std::make_unique<LuaStatePool::Handle> (LuaStatePool::acquire());
+    L = pooled != nullptr ? pooled->get() : state;
 }
 
 ScriptLoader::ScriptLoader (lua_State* L, const String& buffer)
@@ -47,16 +45,9 @@ ScriptLoader::ScriptLoader (sol::state_view& view, File file)
 
 ScriptLoader::~ScriptLoader()
 {
-    if (ownedstate)
-    {
-        {
-            sol::state_view view (L);
-            view.collect_garbage();
-            loaded = {};
-        }
-        lua_close (L);
-    }
-
+    // release the chunk before a pooled state gets reset
+    loaded = {};
+    pooled.reset();
     L = nullptr;
 }
 
@@ -80,7 +71,9 @@ bool ScriptLoader::load (const String& buffer)
 
     try
     {
-        loaded = view.load_buffer (buffer.toRawUTF8(), (size_t) buffer.length(), chunk);
+        const auto* source = buffer.toRawUTF8();
+        const auto status = LuaBytecode::load (L, source, std::strlen (source), chunk.c_str());
+        loaded = sol::load_result (L, lua_absindex (L, -1), 1, 1, static_cast<sol::load_status> (status));
         switch (loaded.status())
         {
             case sol::load_status::file:
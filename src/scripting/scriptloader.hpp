@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL3-or-later
 
 #include <element/script.hpp>
+#include "scripting/luastatepool.hpp"
 #include "sol/sol.hpp"
 
 namespace element {
@@ -76,7 +77,7 @@ public:
 private:
     ScriptInfo info;
     lua_State* L = nullptr;
-    bool ownedstate = false;
+    std::unique_ptr<LuaStatePool::Handle> pooled;
     bool hasloaded = false;
     sol::load_result loaded;
     juce::String error;
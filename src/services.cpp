@@ -162,9 +162,9 @@ void Services::run()
 
     if (auto* sc = find<SessionService>())
     {
-        bool loadDefault = true;
+        bool loadDefault = ! sc->recoverAutosave();
 
-        if (context().settings().openLastUsedSession())
+        if (loadDefault && context().settings().openLastUsedSession())
         {
             const auto lastSession = context().settings().getUserSettings()->getValue (Settings::lastSessionKey);
             if (File::isAbsolutePath (lastSession) && File (lastSession).existsAsFile())
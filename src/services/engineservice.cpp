@@ -14,6 +14,8 @@
 #include "engine/graphmanager.hpp"
 #include "nodes/mididevice.hpp"
 #include "engine/rootgraph.hpp"
+#include "services/sessionservice.hpp"
+#include "ui/sessiondocument.hpp"
 #include <element/engine.hpp>
 #include <element/ui.hpp>
 
@@ -83,6 +85,7 @@ struct RootGraphHolder
             root->setRenderMode (mode);
             root->setMidiChannels (channels);
             root->setMidiProgram (program);
+            root->setStandby (standby);
 
             if (engine->addGraph (root))
             {
@@ -129,20 +132,22 @@ struct RootGraphHolder
 private:
     friend class EngineService;
     friend class EngineService::RootGraphs;
+    friend class EngineService::SetList;
     PluginManager& plugins;
     DeviceManager& devices;
     std::unique_ptr<RootGraphManager> controller;
     Node model;
     ProcessorPtr node;
+    bool standby = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RootGraphHolder);
 };
 
-class EngineService::RootGraphs
+class EngineService::RootGraphs : private Timer
 {
 public:
-    RootGraphs (EngineService& e) : owner (e) {}
-    ~RootGraphs() {}
+    RootGraphs (EngineService& e) : owner (e), lazyAttach (*this) {}
+    ~RootGraphs() { stopTimer(); }
 
     RootGraphHolder* add (RootGraphHolder* item)
     {
@@ -154,6 +159,24 @@ public:
     {
         detachAll();
         graphs.clear();
+        detachRetired();
+    }
+
+    /** Stop using the current graphs without cutting them off. They stay
+        attached on standby so the active one can fade out when the next
+        graph starts, and are detached shortly after.
+     */
+    void retireAll()
+    {
+        for (auto* g : graphs)
+            if (auto* root = g->getRootGraph())
+                root->setStandby (true);
+
+        while (! graphs.isEmpty())
+            retired.add (graphs.removeAndReturn (0));
+
+        if (! retired.isEmpty())
+            startTimer (250);
     }
 
     RootGraphHolder* findByEngineIndex (const int index) const
@@ -236,6 +259,14 @@ public:
             g->detach (engine);
     }
 
+    /** Attach graphs not attached yet, one per timer callback, so opening a
+        session only loads its active graph right away. */
+    void attachLater()
+    {
+        lazyAttach.next = 0;
+        lazyAttach.startTimer (1);
+    }
+
     // remove the holder, this will also delete it!
     void remove (RootGraphHolder* g)
     {
@@ -249,16 +280,220 @@ private:
     SessionPtr session;
     AudioEnginePtr engine;
     OwnedArray<RootGraphHolder> graphs;
+    OwnedArray<RootGraphHolder> retired;
+
+    struct LazyAttach : public Timer
+    {
+        LazyAttach (RootGraphs& g) : owner (g) {}
+
+        void timerCallback() override
+        {
+            auto& graphs = owner.graphs;
+            while (next < graphs.size())
+            {
+                auto* holder = graphs.getUnchecked (next++);
+                if (holder->attached())
+                    continue;
+                if (! holder->attach (owner.owner.context().audio()))
+                    std::clog << "[element] failed attaching root graph: "
+                              << holder->model.getName().toStdString() << std::endl;
+                return;
+            }
+
+            stopTimer();
+        }
+
+        RootGraphs& owner;
+        int next = 0;
+    } lazyAttach;
+
+    void detachRetired()
+    {
+        stopTimer();
+        engine = owner.context().audio();
+        for (auto* g : retired)
+            g->detach (engine);
+        retired.clear();
+    }
+
+    void timerCallback() override { detachRetired(); }
+};
+
+//==============================================================================
+/** Sessions of a set list preloaded on standby.
+
+    Their graphs are instantiated and prepared in the engine but not
+    rendered. Opening one of them hands its graphs over instead of
+    rebuilding them. Graphs are attached one per timer callback so
+    preloading doesn't stall the message thread.
+ */
+class EngineService::SetList : private Timer
+{
+public:
+    SetList (EngineService& e) : owner (e) {}
+    ~SetList() { stopTimer(); }
+
+    void setSessions (const Array<File>& newSessions, int newNumPreloaded)
+    {
+        sessions = newSessions;
+        numPreloaded = jmax (0, newNumPreloaded);
+    }
+
+    const Array<File>& getSessions() const noexcept { return sessions; }
+
+    /** Preload the sessions that follow the one open now and unload the rest. */
+    void update (const File& current)
+    {
+        Array<File> wanted;
+        const int index = sessions.indexOf (current);
+        if (index >= 0)
+            for (int i = index + 1; i <= index + numPreloaded && i < sessions.size(); ++i)
+                wanted.add (sessions.getReference (i));
+
+        for (int i = entries.size(); --i >= 0;)
+            if (! wanted.contains (entries.getUnchecked (i)->file))
+                unload (i);
+
+        for (const auto& file : wanted)
+            preload (file);
+    }
+
+    void preload (const File& file)
+    {
+        if (auto* entry = find (file))
+        {
+            if (entry->modified == file.getLastModificationTime())
+                return;
+            unload (entries.indexOf (entry));
+        }
+
+        String error;
+        const auto data = SessionDocument::readSessionData (file, error);
+        if (! data.isValid())
+        {
+            std::clog << "[element] set list: " << file.getFileName().toStdString()
+                      << ": " << error.toStdString() << std::endl;
+            return;
+        }
+
+        auto* entry = entries.add (new Entry());
+        entry->file = file;
+        entry->modified = file.getLastModificationTime();
+        entry->data = data;
+
+        for (const auto& graph : data.getChildWithName (tags::graphs))
+        {
+            auto* holder = entry->graphs.add (new RootGraphHolder (Node (graph, false), owner.context()));
+            holder->standby = true;
+        }
+
+        startTimer (1);
+    }
+
+    /** Returns the preloaded data for a file if it didn't change since. */
+    ValueTree getData (const File& file) const
+    {
+        if (auto* entry = find (file))
+            if (entry->modified == file.getLastModificationTime())
+                return entry->data;
+        return {};
+    }
+
+    /** Hand over the preloaded holder for a session graph, or nullptr. */
+    RootGraphHolder* take (const Node& graph)
+    {
+        for (auto* entry : entries)
+        {
+            for (int i = 0; i < entry->graphs.size(); ++i)
+            {
+                if (entry->graphs.getUnchecked (i)->model != graph)
+                    continue;
+
+                if (i < entry->numAttached)
+                    --entry->numAttached;
+                return entry->graphs.removeAndReturn (i);
+            }
+        }
+
+        return nullptr;
+    }
+
+    void remove (const File& file)
+    {
+        if (auto* entry = find (file))
+            unload (entries.indexOf (entry));
+    }
+
+    void clear()
+    {
+        stopTimer();
+        for (int i = entries.size(); --i >= 0;)
+            unload (i);
+    }
+
+private:
+    struct Entry
+    {
+        File file;
+        Time modified;
+        ValueTree data;
+        OwnedArray<RootGraphHolder> graphs;
+        int numAttached = 0;
+    };
+
+    EngineService& owner;
+    Array<File> sessions;
+    int numPreloaded = 1;
+    OwnedArray<Entry> entries;
+
+    Entry* find (const File& file) const
+    {
+        for (auto* entry : entries)
+            if (entry->file == file)
+                return entry;
+        return nullptr;
+    }
+
+    void unload (int index)
+    {
+        std::unique_ptr<Entry> entry (entries.removeAndReturn (index));
+        if (entry == nullptr)
+            return;
+
+        auto engine = owner.context().audio();
+        for (auto* holder : entry->graphs)
+            holder->detach (engine);
+    }
+
+    void timerCallback() override
+    {
+        auto engine = owner.context().audio();
+        for (auto* entry : entries)
+        {
+            if (entry->numAttached >= entry->graphs.size())
+                continue;
+
+            auto* holder = entry->graphs.getUnchecked (entry->numAttached++);
+            if (! holder->attach (engine))
+                std::clog << "[element] set list: failed attaching graph: "
+                          << holder->model.getName().toStdString() << std::endl;
+            return;
+        }
+
+        stopTimer();
+    }
 };
 
 EngineService::EngineService()
     : Service()
 {
     graphs = std::make_unique<RootGraphs> (*this);
+    setList = std::make_unique<SetList> (*this);
 }
 
 EngineService::~EngineService()
 {
+    setList = nullptr;
     graphs = nullptr;
 }
 
@@ -378,7 +613,7 @@ void EngineService::removeGraph (int index)
         return;
     }
 
-    if (auto* holder = graphs->findByEngineIndex (index))
+    if (auto* holder = graphs->findFor (toRemove))
     {
         bool removeIt = false;
         if (holder->detach (engine))
@@ -720,6 +955,7 @@ void EngineService::deactivate()
     }
 
     session->saveGraphState();
+    setList->clear();
     graphs->clear();
 
     engine->deactivate();
@@ -897,19 +1133,33 @@ Node EngineService::addPlugin (const Node& graph, const PluginDescription& desc,
 
 void EngineService::sessionReloaded()
 {
-    graphs->clear();
+    graphs->retireAll();
 
     auto session = context().session();
     auto engine = context().audio();
+    const auto sessionFile = sibling<SessionService>() != nullptr ? sibling<SessionService>()->getSessionFile() : File();
 
     if (session->getNumGraphs() > 0)
     {
         for (int i = 0; i < session->getNumGraphs(); ++i)
         {
             Node rootGraph (session->getGraph (i));
-            if (auto* holder = graphs->add (new RootGraphHolder (rootGraph, context())))
+            auto* holder = setList->take (rootGraph);
+            if (holder != nullptr)
+            {
+                holder->standby = false;
+                if (auto* root = holder->getRootGraph())
+                    root->setStandby (false);
+            }
+            else
             {
-                if (! holder->attach (engine))
+                holder = new RootGraphHolder (rootGraph, context());
+            }
+
+            if (graphs->add (holder) != nullptr)
+            {
+                // inactive graphs are attached right after, see attachLater()
+                if (rootGraph == session->getActiveGraph() && ! holder->attach (engine))
                 {
                     std::clog << "[element] failed attaching root grapn: " << holder->model.getName() << std::endl;
                 }
@@ -923,6 +1173,7 @@ void EngineService::sessionReloaded()
 
         const auto ag = session->getActiveGraph();
         setRootNode (ag);
+        graphs->attachLater();
     }
 
     if (session->getNumGraphs() != graphs->getGraphs().size())
@@ -933,6 +1184,36 @@ void EngineService::sessionReloaded()
     {
         DBG ("[element] session reloaded: " << session->getName());
     }
+
+    setList->remove (sessionFile);
+    setList->update (sessionFile);
+}
+
+void EngineService::setSetList (const Array<File>& sessions, int numPreloaded)
+{
+    setList->setSessions (sessions, numPreloaded);
+    if (auto* ss = sibling<SessionService>())
+        setList->update (ss->getSessionFile());
+}
+
+Array<File> EngineService::getSetList() const
+{
+    return setList->getSessions();
+}
+
+void EngineService::preloadSession (const File& file)
+{
+    setList->preload (file);
+}
+
+ValueTree EngineService::getPreloadedSession (const File& file) const
+{
+    return setList->getData (file);
+}
+
+void EngineService::clearPreloadedSessions()
+{
+    setList->clear();
 }
 
 Node EngineService::addPlugin (GraphManager& c, const PluginDescription& desc)
@@ -716,6 +716,9 @@ void GuiService::getAllCommands (Array<CommandID>& ids)
                     Commands::sessionDuplicateGraph,
                     Commands::sessionDeleteGraph,
                     Commands::sessionInsertPlugin,
+                    Commands::sessionOpenSetList,
+                    Commands::sessionNextInSetList,
+                    Commands::sessionPreviousInSetList,
                     //======================================================================
                     Commands::importGraph,
                     Commands::exportGraph,
@@ -809,6 +812,23 @@ void GuiService::getCommandInfo (CommandID commandID, ApplicationCommandInfo& re
             result.addDefaultKeypress ('p', ModifierKeys::commandModifier);
             result.setInfo ("Insert plugin", "Add a plugin in the current graph", "Session", Info::isDisabled);
             break;
+        case Commands::sessionOpenSetList:
+            result.setInfo ("Open Set List", "Open a list of sessions to play in order", "Session", 0);
+            break;
+        case Commands::sessionNextInSetList: {
+            auto* ec = sibling<EngineService>();
+            int flags = ec != nullptr && ! ec->getSetList().isEmpty() ? 0 : Info::isDisabled;
+            result.addDefaultKeypress (KeyPress::pageDownKey, ModifierKeys::commandModifier);
+            result.setInfo ("Next Session", "Open the next session in the set list", "Session", flags);
+            break;
+        }
+        case Commands::sessionPreviousInSetList: {
+            auto* ec = sibling<EngineService>();
+            int flags = ec != nullptr && ! ec->getSetList().isEmpty() ? 0 : Info::isDisabled;
+            result.addDefaultKeypress (KeyPress::pageUpKey, ModifierKeys::commandModifier);
+            result.setInfo ("Previous Session", "Open the previous session in the set list", "Session", flags);
+            break;
+        }
         //======================================================================
         case Commands::importGraph:
             result.setInfo ("Import graph", "Import a graph into current session", "Session", 0);
@@ -995,6 +1015,21 @@ bool GuiService::perform (const InvocationInfo& info)
         case Commands::sessionInsertPlugin:
             std::clog << "case Commands::sessionInsertPlugin:\n";
             break;
+        case Commands::sessionOpenSetList: {
+            FileChooser chooser ("Open Set List", impl->lastSavedFile, "*.txt", true, false);
+            if (chooser.browseForFileToOpen())
+            {
+                sibling<SessionService>()->openSetList (chooser.getResult());
+                commands().commandStatusChanged();
+            }
+            break;
+        }
+        case Commands::sessionNextInSetList:
+            sibling<SessionService>()->openSetListSession (1);
+            break;
+        case Commands::sessionPreviousInSetList:
+            sibling<SessionService>()->openSetListSession (-1);
+            break;
         //======================================================================
         case Commands::importGraph: {
             FileChooser chooser ("Import Graph", impl->lastExportedGraph, "*.elg");
@@ -14,6 +14,7 @@
 #include "services/mappingservice.hpp"
 #include "services/presetservice.hpp"
 #include "services/sessionservice.hpp"
+#include "session/autosave.hpp"
 
 namespace element {
 
@@ -42,6 +43,26 @@ void SessionService::activate()
     document.reset (new SessionDocument (currentSession));
     changeResetter.reset (new ChangeResetter (*this));
     document->setFile (DataPath::defaultSessionDir());
+    document->onSaveFinished = [this] (const File& file, const Result& result) {
+        if (result.failed())
+        {
+            AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon,
+                                              "Save Session",
+                                              "Could not save " + file.getFileName() + ": " + result.getErrorMessage());
+            return;
+        }
+
+        // nothing to recover once the session is on disk.
+        if (autosave != nullptr && ! hasSessionChanged())
+            autosave->clear();
+    };
+
+    autosave = std::make_unique<Autosave>();
+    autosave->onTimer = [this]() {
+        if (document != nullptr && currentSession != nullptr && document->hasChangedSinceSaved())
+            autosave->save (*currentSession, document->getFile());
+    };
+    autosave->start (context().settings().getAutosaveInterval());
 }
 
 void SessionService::deactivate()
@@ -50,8 +71,17 @@ void SessionService::deactivate()
     auto& settings (world.settings());
     auto* props = settings.getUserSettings();
 
+    if (autosave)
+    {
+        // a clean shutdown leaves nothing to recover.
+        autosave->stop();
+        autosave->clear();
+        autosave.reset();
+    }
+
     if (document)
     {
+        document->waitForPendingSave();
         if (document->getFile().existsAsFile())
             props->setValue (Settings::lastSessionKey, document->getFile().getFullPathName());
         document = nullptr;
@@ -73,6 +103,66 @@ void SessionService::openDefaultSession()
     refreshOtherControllers();
     sibling<GuiService>()->stabilizeContent();
     resetChanges (true);
+    autosave->clear();
+}
+
+void SessionService::setAutosaveInterval (int seconds)
+{
+    if (autosave != nullptr)
+        autosave->start (seconds);
+}
+
+bool SessionService::recoverAutosave()
+{
+    if (! Autosave::hasRecovery())
+        return false;
+
+    if (! AlertWindow::showOkCancelBox (AlertWindow::QuestionIcon,
+                                        "Recover Session?",
+                                        "The last session was not closed cleanly. Would you like to recover its autosaved changes?",
+                                        "Recover",
+                                        "Discard"))
+    {
+        autosave->clear();
+        return false;
+    }
+
+    File file;
+    String error;
+    const auto data = Autosave::restore (file, error);
+    Result result = Result::fail (error.isNotEmpty() ? error : String ("Could not read autosaved session"));
+
+    if (data.isValid())
+    {
+        Session::ScopedFrozenLock freeze (*currentSession);
+        document->setPreloadedData (data);
+        result = document->loadFrom (file, false);
+    }
+
+    if (result.failed())
+    {
+        AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Recover Session", result.getErrorMessage());
+        return false;
+    }
+
+    applySessionContent();
+    document->setChangedFlag (true);
+    return true;
+}
+
+void SessionService::applySessionContent()
+{
+    auto& gui = *sibling<GuiService>();
+    gui.closeAllPluginWindows();
+    refreshOtherControllers();
+
+    if (auto* cc = gui.content())
+    {
+        auto ui = currentSession->data().getOrCreateChildWithName (tags::ui, nullptr);
+        cc->applySessionState (ui.getProperty ("content").toString());
+    }
+
+    gui.stabilizeContent();
 }
 
 void SessionService::openFile (const File& file)
@@ -119,22 +209,15 @@ void SessionService::openFile (const File& file)
     {
         document->saveIfNeededAndUserAgrees();
         Session::ScopedFrozenLock freeze (*currentSession);
+        if (auto* ec = sibling<EngineService>())
+            document->setPreloadedData (ec->getPreloadedSession (file));
         Result result = document->loadFrom (file, true);
 
         if (result.wasOk())
         {
-            auto& gui = *sibling<GuiService>();
-            gui.closeAllPluginWindows();
-            refreshOtherControllers();
-
-            if (auto* cc = gui.content())
-            {
-                auto ui = currentSession->data().getOrCreateChildWithName (tags::ui, nullptr);
-                cc->applySessionState (ui.getProperty ("content").toString());
-            }
-
-            sibling<GuiService>()->stabilizeContent();
+            applySessionContent();
             resetChanges();
+            autosave->clear();
         }
 
         jassert (! hasSessionChanged());
@@ -170,6 +253,46 @@ void SessionService::importGraph (const File& file)
     openFile (file);
 }
 
+Array<File> SessionService::readSetList (const File& file)
+{
+    Array<File> sessions;
+    StringArray lines;
+    file.readLines (lines);
+    for (auto line : lines)
+    {
+        line = line.trim();
+        if (line.isEmpty() || line.startsWithChar ('#'))
+            continue;
+        sessions.add (file.getParentDirectory().getChildFile (line));
+    }
+
+    return sessions;
+}
+
+void SessionService::openSetList (const File& file)
+{
+    const auto sessions = readSetList (file);
+    if (sessions.isEmpty())
+    {
+        AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Open Set List", "The set list has no sessions.");
+        return;
+    }
+
+    auto* ec = sibling<EngineService>();
+    ec->clearPreloadedSessions();
+    ec->setSetList (sessions);
+    openFile (sessions.getFirst());
+}
+
+void SessionService::openSetListSession (int offset)
+{
+    auto* ec = sibling<EngineService>();
+    const auto sessions = ec->getSetList();
+    const int index = sessions.indexOf (getSessionFile()) + offset;
+    if (isPositiveAndBelow (index, sessions.size()))
+        openFile (sessions.getReference (index));
+}
+
 void SessionService::closeSession()
 {
     DBG ("[SC] close session");
@@ -200,6 +323,7 @@ void SessionService::saveSession (const bool saveAs, const bool askForFile, cons
     }
 
     sigWillSave();
+    document->setBinaryFormat (context().settings().binarySessions());
 
     if (saveAs)
     {
@@ -247,7 +371,10 @@ void SessionService::newSession()
                                                "Don't Save",
                                                "Cancel");
     if (res == 1)
+    {
+        document->setBinaryFormat (context().settings().binarySessions());
         document->save (true, true);
+    }
 
     if (res == 1 || res == 2)
     {
@@ -256,6 +383,7 @@ void SessionService::newSession()
         refreshOtherControllers();
         sibling<GuiService>()->stabilizeContent();
         resetChanges (true);
+        autosave->clear();
     }
 }
 
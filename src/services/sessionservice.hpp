@@ -10,6 +10,8 @@
 #include "ui/sessiondocument.hpp"
 
 namespace element {
+class Autosave;
+
 class SessionService : public Service
 {
 public:
@@ -27,6 +29,13 @@ public:
                       const bool askForFile = true,
                       const bool showError = true);
     void newSession();
+
+    /** Offer to restore the autosaved session left by a crash. Returns true
+        if it was restored. */
+    bool recoverAutosave();
+
+    /** Autosave every few seconds from now on, zero or less stops it. */
+    void setAutosaveInterval (int seconds);
     bool hasSessionChanged() { return (document) ? document->hasChangedSinceSaved() : false; }
 
     void resetChanges (const bool clearDocumentFile = false);
@@ -34,6 +43,17 @@ public:
     void exportGraph (const Node& node, const File& targetFile);
     void importGraph (const File& file);
 
+    /** Open a set list and its first session. The sessions that follow the
+        one open are preloaded so switching to them is quick. */
+    void openSetList (const File& file);
+
+    /** Open the session before or after the current one in the set list. */
+    void openSetListSession (int offset);
+
+    /** Read a set list file: one session path per line, relative to the
+        list's folder. Empty lines and lines starting with '#' are skipped. */
+    static Array<File> readSetList (const File& file);
+
     Signal<void()> sigSessionLoaded;
     Signal<void()> sigWillSave;
 
@@ -42,8 +62,10 @@ private:
     std::unique_ptr<SessionDocument> document;
     class ChangeResetter;
     std::unique_ptr<ChangeResetter> changeResetter;
+    std::unique_ptr<Autosave> autosave;
 
     void loadNewSessionData();
+    void applySessionContent();
     void refreshOtherControllers();
 };
 
@@ -0,0 +1,366 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <element/datapath.hpp>
+#include <element/node.hpp>
+#include <element/processor.hpp>
+
+#include <map>
+
+#include "session/autosave.hpp"
+#include "session/sessionarchive.hpp"
+#include "session/statecache.hpp"
+
+using namespace juce;
+
+namespace element {
+namespace detail {
+
+static const Identifier autosaveFile = "autosaveFile";
+static constexpr int fullCaptureInterval = 10;
+
+struct StateProperty
+{
+    Identifier property;
+    Identifier reference;
+};
+
+static const StateProperty stateProperties[] = {
+    { tags::state, "stateFile" },
+    { tags::programState, "programStateFile" }
+};
+
+struct AutosaveSnapshot
+{
+    struct State
+    {
+        String name;
+        MemoryBlock data;
+    };
+
+    ValueTree session;
+    File file;
+    std::vector<State> states;
+    StringArray keep;
+};
+
+/** What was last autosaved for a node. */
+struct TrackedNode
+{
+    const Processor* object = nullptr;
+    int version = 0;
+    String names[2];
+    bool seen = false;
+};
+
+using TrackedNodes = std::map<String, TrackedNode>;
+
+/** States are named after their contents. */
+static String getStateName (const MemoryBlock& data)
+{
+    return String::toHexString (StateCache::hashState (data)) + "-" + String ((int64) data.getSize()) + ".state";
+}
+
+/** Sync node settings into the copy and replace plugin states with
+    references to state files. Only nodes whose state version changed, or
+    all of them when full is true, have their plugin state read. */
+static void captureStates (const ValueTree& live, ValueTree copy, AutosaveSnapshot& snapshot, TrackedNodes& tracked, bool full)
+{
+    const Node node (live, false);
+    ProcessorPtr obj = live.hasType (types::Node) ? node.getObject() : nullptr;
+    if (obj != nullptr)
+    {
+        node.saveProcessorSettings (copy);
+
+        const auto uuid = live.getProperty (tags::uuid).toString();
+        TrackedNode unnamed;
+        auto& entry = uuid.isNotEmpty() ? tracked[uuid] : unnamed;
+        entry.seen = true;
+
+        // take the version before reading, a change while reading is
+        // picked up next time.
+        const int version = obj->getStateVersion();
+        if (full || entry.object != obj.get() || entry.version != version)
+        {
+            MemoryBlock blocks[2];
+            if (node.getPluginState (blocks[0], blocks[1]))
+            {
+                entry.object = obj.get();
+                entry.version = version;
+                for (int i = 0; i < 2; ++i)
+                {
+                    entry.names[i] = blocks[i].getSize() > 0 ? getStateName (blocks[i]) : String();
+                    if (entry.names[i].isNotEmpty())
+                        snapshot.states.push_back ({ entry.names[i], std::move (blocks[i]) });
+                }
+            }
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const auto& name = entry.names[i];
+            if (name.isEmpty())
+                continue;
+            copy.removeProperty (stateProperties[i].property, nullptr);
+            copy.setProperty (stateProperties[i].reference, name, nullptr);
+            snapshot.keep.addIfNotAlreadyThere (name);
+        }
+    }
+
+    for (int i = 0; i < live.getNumChildren(); ++i)
+        captureStates (live.getChild (i), copy.getChild (i), snapshot, tracked, full);
+}
+
+/** Write a state under its name, unless it's already there. */
+static bool writeState (const File& dir, const String& name, const MemoryBlock& data)
+{
+    const auto file = dir.getChildFile (name);
+    if (file.existsAsFile())
+        return true;
+
+    TemporaryFile tempFile (file);
+    if (auto out = tempFile.getFile().createOutputStream())
+    {
+        {
+            GZIPCompressorOutputStream gzip (*out);
+            gzip.write (data.getData(), data.getSize());
+        }
+
+        const bool ok = out->getStatus().wasOk();
+        out.reset();
+        return ok && tempFile.overwriteTargetFileWithTemporary();
+    }
+
+    return false;
+}
+
+static bool readStates (const File& dir, ValueTree tree, String& error)
+{
+    for (const auto& state : stateProperties)
+    {
+        if (! tree.hasProperty (state.reference))
+            continue;
+
+        const auto file = dir.getChildFile (tree.getProperty (state.reference).toString());
+        MemoryBlock data;
+        {
+            FileInputStream in (file);
+            if (! in.openedOk())
+            {
+                error = "Missing autosaved plugin state";
+                return false;
+            }
+
+            GZIPDecompressorInputStream gzip (in);
+            gzip.readIntoMemoryBlock (data);
+        }
+
+        tree.removeProperty (state.reference, nullptr);
+        tree.setProperty (state.property, StateCache::share (std::move (data)), nullptr);
+    }
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        if (! readStates (dir, tree.getChild (i), error))
+            return false;
+
+    return true;
+}
+
+} // namespace detail
+
+//==============================================================================
+class Autosave::Tracker
+{
+public:
+    detail::TrackedNodes nodes;
+
+    /** Forget nodes that weren't seen during the last capture. */
+    void prune()
+    {
+        for (auto it = nodes.begin(); it != nodes.end();)
+        {
+            if (it->second.seen)
+            {
+                it->second.seen = false;
+                ++it;
+            }
+            else
+            {
+                it = nodes.erase (it);
+            }
+        }
+    }
+};
+
+//==============================================================================
+class Autosave::Writer
+{
+public:
+    Writer (const File& dir) : directory (dir), pool (1) {}
+
+    bool isBusy() const { return pool.getNumJobs() > 0; }
+
+    void write (std::unique_ptr<detail::AutosaveSnapshot> snapshot)
+    {
+        idle.reset();
+        pool.addJob (new Job (*this, std::move (snapshot)), true);
+    }
+
+    void waitForPending()
+    {
+        while (isBusy())
+            idle.wait (10);
+    }
+
+    /** True if a write failed since the last call, older state files
+        might be missing then. */
+    bool takeFailed() { return failed.exchange (false); }
+
+    const File directory;
+
+private:
+    struct Job : public ThreadPoolJob
+    {
+        Job (Writer& w, std::unique_ptr<detail::AutosaveSnapshot> s)
+            : ThreadPoolJob ("autosave"), writer (w), snapshot (std::move (s)) {}
+
+        JobStatus runJob() override
+        {
+            if (! write())
+                writer.failed = true;
+            writer.idle.signal();
+            return jobHasFinished;
+        }
+
+        bool write()
+        {
+            const auto& dir = writer.directory;
+            dir.createDirectory();
+
+            for (auto& state : snapshot->states)
+            {
+                if (! detail::writeState (dir, state.name, state.data))
+                {
+                    std::clog << "[element] autosave: could not write plugin state\n";
+                    return false;
+                }
+
+                state.data.reset();
+            }
+
+            snapshot->session.setProperty (detail::autosaveFile, snapshot->file.getFullPathName(), nullptr);
+
+            String error;
+            if (! SessionArchive::write (snapshot->session, dir.getChildFile ("session.els"), error))
+            {
+                std::clog << "[element] autosave: " << error << std::endl;
+                return false;
+            }
+
+            // states from older snapshots are only removed once the new
+            // session no longer refers to them.
+            for (const auto& file : dir.findChildFiles (File::findFiles, false, "*.state"))
+                if (! snapshot->keep.contains (file.getFileName()))
+                    file.deleteFile();
+
+            return true;
+        }
+
+        Writer& writer;
+        std::unique_ptr<detail::AutosaveSnapshot> snapshot;
+    };
+
+    ThreadPool pool;
+    WaitableEvent idle { true };
+    std::atomic<bool> failed { false };
+};
+
+//==============================================================================
+Autosave::Autosave (const File& directory)
+    : writer (std::make_unique<Writer> (directory)),
+      tracker (std::make_unique<Tracker>()) {}
+
+Autosave::~Autosave()
+{
+    stopTimer();
+    writer->waitForPending();
+    writer.reset();
+}
+
+void Autosave::start (int intervalSeconds)
+{
+    if (intervalSeconds > 0)
+        startTimer (intervalSeconds * 1000);
+    else
+        stopTimer();
+}
+
+void Autosave::stop()
+{
+    stopTimer();
+}
+
+bool Autosave::save (const Session& session, const File& sessionFile)
+{
+    if (writer->isBusy())
+        return false;
+
+    // every few saves read all states, not every plugin reports changes.
+    const bool full = writer->takeFailed() || (numSaves++ % detail::fullCaptureInterval) == 0;
+
+    auto snapshot = std::make_unique<detail::AutosaveSnapshot>();
+    snapshot->file = sessionFile;
+    snapshot->session = session.data().createCopy();
+    Node::sanitizeProperties (snapshot->session, true);
+    detail::captureStates (session.data(), snapshot->session, *snapshot, tracker->nodes, full);
+    tracker->prune();
+
+    writer->write (std::move (snapshot));
+    return true;
+}
+
+void Autosave::waitForPendingWrites()
+{
+    writer->waitForPending();
+}
+
+void Autosave::clear()
+{
+    writer->waitForPending();
+    writer->directory.deleteRecursively();
+
+    // the files unchanged nodes would refer to are gone.
+    tracker->nodes.clear();
+    numSaves = 0;
+}
+
+File Autosave::getDirectory()
+{
+    return DataPath::applicationDataDir().getChildFile ("autosave");
+}
+
+bool Autosave::hasRecovery (const File& dir)
+{
+    return dir.getChildFile ("session.els").existsAsFile();
+}
+
+ValueTree Autosave::restore (File& sessionFile, String& error, const File& dir)
+{
+    auto data = SessionArchive::read (dir.getChildFile ("session.els"), error);
+    if (! data.isValid())
+        return {};
+
+    const auto path = data.getProperty (detail::autosaveFile).toString();
+    sessionFile = File::isAbsolutePath (path) ? File (path) : File();
+    data.removeProperty (detail::autosaveFile, nullptr);
+
+    return detail::readStates (dir, data, error) ? data : ValueTree();
+}
+
+void Autosave::timerCallback()
+{
+    if (onTimer)
+        onTimer();
+}
+
+} // namespace element
@@ -0,0 +1,73 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <element/session.hpp>
+
+namespace element {
+
+/** Periodically writes a recovery copy of a session.
+
+    On the message thread only a copy of the session tree is taken and the
+    state of each plugin that changed since the last autosave is read, see
+    Processor::getStateVersion().  Everything else happens on a background
+    thread: plugin states are written as separate compressed files named
+    after their contents and the session itself is written as a
+    SessionArchive that refers to them.  Unchanged nodes keep referring to
+    the files written earlier.  Every few autosaves all states are read
+    again, for plugins that change without telling.
+
+    The recovery files are removed when the session is saved or closed
+    normally, so finding them at startup means the app did not shut down
+    cleanly.
+ */
+class Autosave : private juce::Timer
+{
+public:
+    /** Keeps recovery files in directory, which defaults to getDirectory(). */
+    explicit Autosave (const juce::File& directory = getDirectory());
+    ~Autosave();
+
+    /** Called on the message thread every interval, usually to call save(). */
+    std::function<void()> onTimer;
+
+    /** Start calling onTimer every few seconds. Zero or less stops it. */
+    void start (int intervalSeconds);
+
+    /** Stop the timer, pending writes still finish. */
+    void stop();
+
+    /** Snapshot a session now and write it in the background. Returns false
+        if the previous autosave is still being written. */
+    bool save (const Session& session, const juce::File& sessionFile);
+
+    /** Wait until the last snapshot has been written. */
+    void waitForPendingWrites();
+
+    /** Wait for pending writes then delete the recovery files. */
+    void clear();
+
+    /** Returns the default directory where recovery files are kept. */
+    static juce::File getDirectory();
+
+    /** Returns true if recovery files from a previous run exist. */
+    static bool hasRecovery (const juce::File& directory = getDirectory());
+
+    /** Read the recovered session data and the file it was saved from. */
+    static juce::ValueTree restore (juce::File& sessionFile, juce::String& error,
+                                    const juce::File& directory = getDirectory());
+
+private:
+    class Writer;
+    std::unique_ptr<Writer> writer;
+    class Tracker;
+    std::unique_ptr<Tracker> tracker;
+    int numSaves = 0;
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE (Autosave)
+};
+
+} // namespace element
@@ -11,6 +11,7 @@
 
 #include "nodes/nodetypes.hpp"
 #include "engine/ionode.hpp"
+#include "session/pluginscancache.hpp"
 #include "datapath.hpp"
 #include "utils.hpp"
 
@@ -37,6 +38,27 @@ static const char* pluginListKey() { return Settings::pluginListKey; }
 static void pluginScannerCrashHandler (void*) {}
 static File pluginsXmlFile() { return DataPath::applicationDataDir().getChildFile ("plugins.xml"); }
 
+/* the list a single scanner process writes to */
+static File shardListFile (int shard)
+{
+    return DataPath::applicationDataDir()
+        .getChildFile (EL_PLUGIN_SCANNER_SLAVE_LIST_PATH)
+        .getSiblingFile ("list-" + String (shard) + ".xml");
+}
+
+/* add a plugin to the dead mans pedal so it gets blacklisted */
+static void addDeadPlugin (const String& identifier)
+{
+    const auto file = DataPath::applicationDataDir().getChildFile (EL_DEAD_AUDIO_PLUGINS_FILENAME);
+    StringArray lines;
+    if (file.existsAsFile())
+        file.readLines (lines);
+    lines.removeEmptyStrings();
+    lines.addIfNotAlreadyThere (identifier);
+    file.getParentDirectory().createDirectory();
+    file.replaceWithText (lines.joinIntoString ("\n"), true, true);
+}
+
 static File scannerExeFullPath()
 {
     auto scannerExe = File::getSpecialLocation (File::currentExecutableFile);
@@ -61,11 +83,13 @@ static File scannerExeFullPath()
 
 //==============================================================================
 class PluginScannerCoordinator : public juce::ChildProcessCoordinator,
-                                 public AsyncUpdater
+                                 public AsyncUpdater,
+                                 private Timer
 {
 public:
-    explicit PluginScannerCoordinator (PluginScanner& o) : owner (o) {}
-    ~PluginScannerCoordinator() {}
+    PluginScannerCoordinator (PluginScanner& o, int shardIndex, int totalShards)
+        : owner (o), cache (o.cache), shard (shardIndex), numShards (totalShards) {}
+    ~PluginScannerCoordinator() { stopTimer(); }
 
     bool startScanning (const StringArray& names = StringArray())
     {
@@ -86,10 +110,13 @@ public:
             running = res;
         }
 
-        DBG ("[element] scanner launched: " << (isRunning() ? "yes" : "no"));
+        DBG ("[element] scanner " << shard << " launched: " << (isRunning() ? "yes" : "no"));
+        startTimer (1000);
         return res;
     }
 
+    /** Called on the IPC thread. Anything for listeners goes through the
+        owner's async update, which runs on the message thread. */
     void handleMessageFromWorker (const MemoryBlock& mb) override
     {
         const auto data (mb.toString());
@@ -109,16 +136,36 @@ public:
         }
         else if (type == "name")
         {
-            owner.listeners.call (&PluginScanner::Listener::audioPluginScanStarted, message.trim());
+            {
+                ScopedLock sl (lock);
+                pluginBeingScanned = message.trim();
+                scanStarted = Time::getMillisecondCounter();
+                startedNames.add (pluginBeingScanned);
+            }
+            owner.triggerAsyncUpdate();
+        }
+        else if (type == "done")
+        {
             ScopedLock sl (lock);
-            pluginBeingScanned = message.trim();
+            pluginBeingScanned = String();
         }
-        else if (type == "progress")
+        else if (type == "stamp")
+        {
+            if (cache != nullptr)
+                cache->set (message);
+        }
+        else if (type == "failed")
         {
-            float newProgress = (float) var (message);
-            owner.listeners.call (&PluginScanner::Listener::audioPluginScanProgress, newProgress);
             ScopedLock sl (lock);
-            progress = newProgress;
+            failedFiles.addIfNotAlreadyThere (message.trim());
+        }
+        else if (type == "progress")
+        {
+            {
+                ScopedLock sl (lock);
+                progress = (float) var (message);
+            }
+            owner.triggerAsyncUpdate();
         }
     }
 
@@ -138,16 +185,27 @@ public:
         const auto state = getWorkerState();
         if (state == "ready" && isRunning())
         {
-            String msg = "scan:";
-            msg << formatNames.joinIntoString (",");
-            MemoryBlock mb (msg.toRawUTF8(), msg.length());
-            sendMessageToWorker (mb);
+            sendString ("shard", String (shard) + "/" + String (numShards));
+            StringArray dead, failed;
+            {
+                ScopedLock sl (lock);
+                dead = deadFiles;
+                failed = failedFiles;
+            }
+            // plugins which crashed are blacklisted, ones which only failed
+            // to load are passed over for this scan and tried again next time.
+            if (! dead.isEmpty())
+                sendString ("skip", dead.joinIntoString ("\n"));
+            if (! failed.isEmpty())
+                sendString ("ignore", failed.joinIntoString ("\n"));
+            sendString ("scan", formatNames.joinIntoString (","));
         }
         else if (state == "scanning")
         {
             if (! isRunning())
             {
                 DBG ("[element] a plugin crashed or timed out during scan");
+                recordDeadPlugin();
                 updateListAndLaunchWorker();
             }
             else
@@ -157,7 +215,8 @@ public:
         }
         else if (state == EL_PLUGIN_SCANNER_FINISHED_ID)
         {
-            DBG ("[element] worker finished scanning");
+            DBG ("[element] worker " << shard << " finished scanning");
+            stopTimer();
             sendQuitMessage();
             killWorkerProcess();
 
@@ -167,7 +226,7 @@ public:
                 slaveState = "idle";
             }
 
-            owner.listeners.call (&PluginScanner::Listener::audioPluginScanFinished);
+            owner.workerFinished();
         }
         else if (state == EL_PLUGIN_SCANNER_WAITING_STATE)
         {
@@ -205,6 +264,30 @@ public:
         return running;
     }
 
+    bool isFinished() const
+    {
+        ScopedLock sl (lock);
+        return slaveState == "idle";
+    }
+
+    /** Returns files which crashed the scanner or failed to load. */
+    StringArray getFailedFiles() const
+    {
+        ScopedLock sl (lock);
+        auto files = deadFiles;
+        files.addArray (failedFiles);
+        return files;
+    }
+
+    /** Returns the plugins started since the last call. */
+    StringArray takeStartedNames()
+    {
+        ScopedLock sl (lock);
+        StringArray names;
+        names.swapWith (startedNames);
+        return names;
+    }
+
     bool sendQuitMessage()
     {
         if (isRunning())
@@ -214,20 +297,65 @@ public:
 
 private:
     PluginScanner& owner;
+    // shared so a stamp arriving while the scan is cancelled stays valid.
+    std::shared_ptr<PluginScanCache> cache;
+    const int shard, numShards;
 
     CriticalSection lock;
     bool running = false;
     float progress = 0.f;
     String slaveState;
     StringArray formatNames;
-    StringArray faileFiles;
+    StringArray deadFiles, failedFiles, startedNames;
 
     String pluginBeingScanned;
+    uint32 scanStarted = 0;
+
+    bool sendString (const String& type, const String& message)
+    {
+        String data = type;
+        data << ":" << message;
+        MemoryBlock mb (data.toRawUTF8(), data.getNumBytesAsUTF8());
+        return sendMessageToWorker (mb);
+    }
+
+    void timerCallback() override
+    {
+        {
+            ScopedLock sl (lock);
+            if (! running || pluginBeingScanned.isEmpty()
+                || Time::getMillisecondCounter() - scanStarted < (uint32) owner.getPluginTimeout())
+                return;
+            Logger::writeToLog ("[element] plugin scan timed out: " + pluginBeingScanned);
+            running = false;
+        }
+
+        killWorkerProcess();
+        triggerAsyncUpdate();
+    }
+
+    /** Blacklist the plugin that was being scanned when the worker died. */
+    void recordDeadPlugin()
+    {
+        String plugin;
+
+        {
+            ScopedLock sl (lock);
+            plugin = pluginBeingScanned;
+            pluginBeingScanned = String();
+            if (plugin.isNotEmpty())
+                deadFiles.addIfNotAlreadyThere (plugin);
+        }
+
+        if (plugin.isNotEmpty())
+            detail::addDeadPlugin (plugin);
+    }
 
     void updateListAndLaunchWorker()
     {
-        if (auto xml = XmlDocument::parse (PluginScanner::getWorkerPluginListFile()))
-            owner.list.recreateFromXml (*xml);
+        // the new worker skips files already stamped this scan.
+        if (cache != nullptr)
+            cache->save();
 
         const bool res = launchScanner();
         ScopedLock sl (lock);
@@ -267,7 +395,6 @@ class PluginScannerWorker : public juce::ChildProcessWorker,
 public:
     PluginScannerWorker()
     {
-        scanFile = PluginScanner::getWorkerPluginListFile();
         SystemStats::setApplicationCrashHandler (detail::pluginScannerCrashHandler);
         auto logfile = DataPath::applicationDataDir().getChildFile ("log/scanner.log");
         logfile.create();
@@ -294,7 +421,29 @@ public:
             return;
         }
 
-        if (type == "scan")
+        if (type == "shard")
+        {
+            shard = jmax (0, message.upToFirstOccurrenceOf ("/", false, false).getIntValue());
+            numShards = jmax (1, message.fromFirstOccurrenceOf ("/", false, false).getIntValue());
+            scanFile = detail::shardListFile (shard);
+            if (! scanFile.existsAsFile())
+                scanFile.create();
+            if (auto xml = XmlDocument::parse (scanFile))
+                pluginList.recreateFromXml (*xml);
+        }
+        else if (type == "skip")
+        {
+            for (const auto& file : StringArray::fromLines (message))
+                if (file.isNotEmpty())
+                    pluginList.addToBlacklist (file);
+        }
+        else if (type == "ignore")
+        {
+            for (const auto& file : StringArray::fromLines (message))
+                if (file.isNotEmpty())
+                    ignoredFiles.addIfNotAlreadyThere (file);
+        }
+        else if (type == "scan")
         {
             const auto formats (StringArray::fromTokens (message.trim(), ",", "'"));
             formatsToScan = formats;
@@ -312,6 +461,7 @@ public:
         }
 
         updateScanFileWithSettings();
+        cache.restore();
 
         sendState ("scanning");
 
@@ -349,12 +499,6 @@ public:
         plugins = std::make_unique<PluginManager>();
         logger->logMessage ("[scanner] created global objects");
 
-        if (! scanFile.existsAsFile())
-            scanFile.create();
-
-        if (auto xml = XmlDocument::parse (scanFile))
-            pluginList.recreateFromXml (*xml);
-
         logger->logMessage ("[scanner] processing blacklist");
         // This must happen before user settings, PluginManager will delete the deadman file
         // when restoring user plugins
@@ -383,19 +527,19 @@ public:
         logger.reset();
         settings = nullptr;
         plugins = nullptr;
-        scanner = nullptr;
         Process::terminate();
     }
 
 private:
     std::unique_ptr<Settings> settings;
     std::unique_ptr<PluginManager> plugins;
-    std::unique_ptr<PluginDirectoryScanner> scanner;
-    String fileOrIdentifier;
     KnownPluginList pluginList;
-    StringArray filesToSkip;
+    PluginScanCache cache;
     File scanFile;
     StringArray formatsToScan;
+    // failed earlier in this scan, not blacklisted.
+    StringArray ignoredFiles;
+    int shard = 0, numShards = 1;
 
     std::unique_ptr<juce::FileLogger> logger;
 
@@ -428,24 +572,6 @@ private:
         return sendMessageToCoordinator (mb);
     }
 
-    bool doNextScan()
-    {
-        const auto nextFile = scanner->getNextPluginFileThatWillBeScanned();
-        sendString ("name", nextFile);
-        logger->logMessage (String ("[scanner] scan: ") + nextFile);
-
-        for (const auto& file : scanner->getFailedFiles())
-            pluginList.addToBlacklist (file);
-
-        if (scanner->scanNextFile (true, fileOrIdentifier))
-        {
-            writePluginListNow();
-            return true;
-        }
-
-        return false;
-    }
-
     void scanFor (const String& formatName)
     {
         if (plugins == nullptr || settings == nullptr)
@@ -468,14 +594,17 @@ private:
             if (p->format() != "LV2")
                 continue;
             const auto types = p->findTypes();
+            const int total = jmax (1, (types.size() - shard + numShards - 1) / numShards);
             float step = 1.f;
-            for (const auto& tp : types)
+            for (int i = shard; i < types.size(); i += numShards)
             {
-                if (! pluginList.getBlacklistedFiles().contains (tp) && pluginList.getTypeForFile (tp) == nullptr)
+                const auto& tp = types.getReference (i);
+                if (! pluginList.getBlacklistedFiles().contains (tp)
+                    && ! ignoredFiles.contains (tp)
+                    && pluginList.getTypeForFile (tp) == nullptr)
                 {
                     sendString ("name", tp.trim());
                     logger->logMessage (String ("[scanner] scan: ") + tp);
-                    OwnedArray<PluginDescription> dc;
                     pluginList.addToBlacklist (tp);
                     writePluginListNow();
 
@@ -487,9 +616,18 @@ private:
                         pluginList.addType (desc);
                         writePluginListNow();
                     }
+                    else
+                    {
+                        // it didn't crash, so don't leave it blacklisted.
+                        pluginList.removeFromBlacklist (tp);
+                        writePluginListNow();
+                        sendString ("failed", tp);
+                    }
+
+                    sendString ("done", tp);
                 }
 
-                sendString ("progress", String (step / (float) types.size()));
+                sendString ("progress", String (step / (float) total));
                 step += 1.f;
             }
         }
@@ -502,37 +640,93 @@ private:
 
         const auto key = String (settings->lastPluginScanPathPrefix) + format.getName();
         FileSearchPath path (settings->getUserSettings()->getValue (key));
-        scanner = std::make_unique<PluginDirectoryScanner> (pluginList, format, path, true, plugins->getDeadAudioPluginsFile(), false);
 
-        while (doNextScan())
-            sendString ("progress", String (scanner->getProgress()));
+        // every worker sees the same sorted list and takes every Nth file.
+        auto files = format.searchPathsForPlugins (path, true, false);
+        files.sort (false);
+
+        const int total = jmax (1, (files.size() - shard + numShards - 1) / numShards);
+        float step = 1.f;
+        for (int i = shard; i < files.size(); i += numShards)
+        {
+            scanFile (format, files.getReference (i));
+            sendString ("progress", String (step / (float) total));
+            step += 1.f;
+        }
 
         writePluginListNow();
-#if JUCE_LINUX
-        Thread::sleep (1000);
-#endif
+    }
+
+    void scanFile (AudioPluginFormat& format, const String& file)
+    {
+        if (pluginList.getBlacklistedFiles().contains (file) || ignoredFiles.contains (file))
+            return;
+
+        const auto stamp = PluginScanCache::stamp (file);
+        if (pluginList.getTypeForFile (file) != nullptr && cache.isUpToDate (file, stamp))
+            return;
+
+        sendString ("name", file);
+        logger->logMessage (String ("[scanner] scan: ") + file);
+
+        OwnedArray<PluginDescription> found;
+        pluginList.scanAndAddFile (file, false, found, format);
+
+        // files which didn't load aren't stamped, so they're tried again next time.
+        if (found.isEmpty())
+            sendString ("failed", file);
+        else
+            sendString ("stamp", PluginScanCache::toString (file, stamp));
+
+        sendString ("done", file);
+        writePluginListNow();
     }
 };
 
 //==============================================================================
-PluginScanner::PluginScanner (KnownPluginList& listToManage) : list (listToManage) {}
+PluginScanner::PluginScanner (KnownPluginList& listToManage)
+    : list (listToManage), numWorkers (getDefaultNumWorkers()) {}
+
 PluginScanner::~PluginScanner()
 {
     listeners.clear();
-    master.reset();
+    workers.clear();
+    cache.reset();
+}
+
+int PluginScanner::getDefaultNumWorkers()
+{
+    return jlimit (1, 8, SystemStats::getNumCpus() / 2);
+}
+
+void PluginScanner::setNumWorkers (int newNumWorkers)
+{
+    numWorkers = jlimit (1, 32, newNumWorkers);
 }
 
 void PluginScanner::cancel()
 {
-    if (master)
+    for (auto* worker : workers)
     {
-        master->handleUpdateNowIfNeeded();
-        master->sendQuitMessage();
-        master.reset();
+        worker->cancelPendingUpdate();
+        worker->sendQuitMessage();
     }
+
+    workers.clear();
+    cancelPendingUpdate();
+
+    if (cache != nullptr)
+        cache->save();
+    cache.reset();
 }
 
-bool PluginScanner::isScanning() const { return master && master->isRunning(); }
+bool PluginScanner::isScanning() const
+{
+    for (auto* worker : workers)
+        if (worker->isRunning())
+            return true;
+    return false;
+}
 
 void PluginScanner::scanForAudioPlugins (const juce::String& formatName)
 {
@@ -543,11 +737,66 @@ void PluginScanner::scanForAudioPlugins (const StringArray& formats)
 {
     cancel();
     getWorkerPluginListFile().deleteFile();
-    if (master == nullptr)
-        master.reset (new PluginScannerCoordinator (*this));
-    if (master->isRunning())
+    for (const auto& file : getWorkerPluginListFile().getParentDirectory().findChildFiles (File::findFiles, false, "list-*.xml"))
+        file.deleteFile();
+
+    failedIdentifiers.clearQuick();
+    cache = std::make_shared<PluginScanCache>();
+    cache->restore();
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add (new PluginScannerCoordinator (*this, i, numWorkers));
+    for (auto* worker : workers)
+        worker->startScanning (formats);
+}
+
+void PluginScanner::handleAsyncUpdate()
+{
+    if (workers.isEmpty())
         return;
-    master->startScanning (formats);
+
+    float total = 0.f;
+    for (auto* worker : workers)
+    {
+        for (const auto& name : worker->takeStartedNames())
+            listeners.call (&PluginScanner::Listener::audioPluginScanStarted, name);
+        total += jmax (0.f, worker->getProgress());
+    }
+
+    listeners.call (&PluginScanner::Listener::audioPluginScanProgress,
+                    total / (float) workers.size());
+}
+
+void PluginScanner::workerFinished()
+{
+    for (auto* worker : workers)
+        if (! worker->isFinished())
+            return;
+
+    // merge each worker's results in to the list the app restores from.
+    KnownPluginList merged;
+    for (int i = 0; i < workers.size(); ++i)
+    {
+        if (auto xml = XmlDocument::parse (detail::shardListFile (i)))
+        {
+            KnownPluginList shardList;
+            shardList.recreateFromXml (*xml);
+            for (const auto& type : shardList.getTypes())
+                merged.addType (type);
+            for (const auto& file : shardList.getBlacklistedFiles())
+                merged.addToBlacklist (file);
+        }
+
+        failedIdentifiers.addArray (workers[i]->getFailedFiles());
+    }
+
+    failedIdentifiers.removeDuplicates (false);
+    if (auto xml = merged.createXml())
+        xml->writeTo (getWorkerPluginListFile());
+    if (cache != nullptr)
+        cache->save();
+
+    listeners.call (&PluginScanner::Listener::audioPluginScanFinished);
 }
 
 void PluginScanner::timerCallback()
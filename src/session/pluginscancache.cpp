@@ -0,0 +1,99 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include "session/pluginscancache.hpp"
+#include "datapath.hpp"
+
+#define EL_PLUGIN_SCANNER_CACHE_PATH "scanner/cache.xml"
+
+namespace element {
+using namespace juce;
+
+File PluginScanCache::getDefaultFile()
+{
+    return DataPath::applicationDataDir().getChildFile (EL_PLUGIN_SCANNER_CACHE_PATH);
+}
+
+PluginScanCache::Stamp PluginScanCache::stamp (const String& path)
+{
+    const File file (path);
+    Stamp s;
+    if (file.isDirectory())
+    {
+        s.modified = file.getLastModificationTime().toMilliseconds();
+        for (const auto& entry : RangedDirectoryIterator (file, true, "*", File::findFiles))
+        {
+            s.size += entry.getFileSize();
+            s.modified = jmax (s.modified, entry.getModificationTime().toMilliseconds());
+        }
+    }
+    else
+    {
+        s.size = file.getSize();
+        s.modified = file.getLastModificationTime().toMilliseconds();
+    }
+    return s;
+}
+
+String PluginScanCache::toString (const String& path, const Stamp& s)
+{
+    return String (s.size) + "|" + String (s.modified) + "|" + path;
+}
+
+bool PluginScanCache::set (const String& encoded)
+{
+    const auto path = encoded.fromFirstOccurrenceOf ("|", false, false).fromFirstOccurrenceOf ("|", false, false);
+    if (path.isEmpty())
+        return false;
+    const auto size = encoded.upToFirstOccurrenceOf ("|", false, false).getLargeIntValue();
+    const auto modified = encoded.fromFirstOccurrenceOf ("|", false, false).upToFirstOccurrenceOf ("|", false, false).getLargeIntValue();
+    set (path, { size, modified });
+    return true;
+}
+
+void PluginScanCache::set (const String& path, const Stamp& s)
+{
+    ScopedLock sl (lock);
+    entries[path] = s;
+}
+
+bool PluginScanCache::isUpToDate (const String& path, const Stamp& s) const
+{
+    ScopedLock sl (lock);
+    auto iter = entries.find (path);
+    return iter != entries.end() && iter->second == s;
+}
+
+int PluginScanCache::size() const
+{
+    ScopedLock sl (lock);
+    return (int) entries.size();
+}
+
+void PluginScanCache::restore (const File& file)
+{
+    ScopedLock sl (lock);
+    entries.clear();
+    if (auto xml = XmlDocument::parse (file))
+        for (auto* e : xml->getChildWithTagNameIterator ("file"))
+            entries[e->getStringAttribute ("path")] = { e->getStringAttribute ("size").getLargeIntValue(),
+                                                        e->getStringAttribute ("modified").getLargeIntValue() };
+}
+
+bool PluginScanCache::save (const File& file) const
+{
+    XmlElement xml ("scancache");
+    {
+        ScopedLock sl (lock);
+        for (const auto& entry : entries)
+        {
+            auto* e = xml.createNewChildElement ("file");
+            e->setAttribute ("path", entry.first);
+            e->setAttribute ("size", String (entry.second.size));
+            e->setAttribute ("modified", String (entry.second.modified));
+        }
+    }
+    return xml.writeTo (file);
+}
+
+} // namespace element
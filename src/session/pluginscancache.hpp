@@ -0,0 +1,58 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <map>
+
+#include <element/juce/core.hpp>
+
+namespace element {
+
+/** Size and modification time of each plugin file from the last scan. Files
+    which haven't changed are skipped when scanning again. */
+class PluginScanCache
+{
+public:
+    struct Stamp
+    {
+        juce::int64 size = 0;
+        juce::int64 modified = 0;
+        bool operator== (const Stamp& o) const noexcept { return size == o.size && modified == o.modified; }
+    };
+
+    PluginScanCache() = default;
+
+    /** The cache file in the application data directory. */
+    static juce::File getDefaultFile();
+
+    /** Stamp a plugin file. Bundles are stamped by their contents. */
+    static Stamp stamp (const juce::String& path);
+
+    /** Encode an entry for sending between processes */
+    static juce::String toString (const juce::String& path, const Stamp& s);
+
+    /** Set an entry from a string made with toString() */
+    bool set (const juce::String& encoded);
+
+    /** Set the stamp of a file. */
+    void set (const juce::String& path, const Stamp& s);
+
+    /** Returns true if the file was stamped with s. */
+    bool isUpToDate (const juce::String& path, const Stamp& s) const;
+
+    /** Returns the number of files in the cache. */
+    int size() const;
+
+    /** Replace the entries with those saved in a file. */
+    void restore (const juce::File& file = getDefaultFile());
+
+    /** Write the entries to a file. */
+    bool save (const juce::File& file = getDefaultFile()) const;
+
+private:
+    juce::CriticalSection lock;
+    std::map<juce::String, Stamp> entries;
+};
+
+} // namespace element
@@ -7,6 +7,7 @@
 #include <element/session.hpp>
 
 #include <element/context.hpp>
+#include "session/sessionarchive.hpp"
 #include "tempo.hpp"
 
 namespace element {
@@ -287,23 +288,19 @@ bool Session::writeToFile (const File& file) const
 {
     ValueTree saveData = objectData.createCopy();
     Node::sanitizeProperties (saveData, true);
-    TemporaryFile tempFile (file);
-
-    if (auto fos = tempFile.getFile().createOutputStream())
-    {
-        {
-            GZIPCompressorOutputStream gzip (*fos, 9);
-            saveData.writeToStream (gzip);
-        }
-        fos.reset();
-        return tempFile.overwriteTargetFileWithTemporary();
-    }
-
-    return false;
+    String error;
+    return SessionArchive::write (saveData, file, error);
 }
 
 ValueTree Session::readFromFile (const File& file)
 {
+    if (SessionArchive::isArchive (file))
+    {
+        String error;
+        return SessionArchive::read (file, error);
+    }
+
+    // older files were a single gzipped tree.
     ValueTree data;
     FileInputStream fi (file);
 
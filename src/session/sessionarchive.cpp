@@ -0,0 +1,517 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <limits>
+#include <map>
+
+#include <element/tags.hpp>
+
+#include "session/sessionarchive.hpp"
+#include "session/statecache.hpp"
+
+using namespace juce;
+
+#define EL_SESSION_ARCHIVE_VERSION 1
+
+namespace element {
+namespace detail {
+
+static const char archiveMagic[4] = { 'E', 'L', 'S', 'B' };
+
+/** States shorter than this many base64 characters stay in the graph chunk. */
+static constexpr int minBlobLength = 1024;
+
+/** magic, version, number of chunks and the offset of the table of contents */
+static constexpr int64 archiveHeaderSize = 4 + 4 + 4 + 8;
+static constexpr int64 tocOffsetPosition = 4 + 4 + 4;
+static constexpr int64 tocEntrySize = 4 + 4 + 8 + 8 + 8;
+
+/** Deflate can't shrink data by more than about 1032:1, and no single
+    chunk is allowed past what a MemoryBlock read can hold. */
+static constexpr int64 maxCompressionRatio = 1032;
+static constexpr int64 maxChunkSize = std::numeric_limits<int>::max();
+
+enum ChunkType
+{
+    sessionChunk = 0,
+    graphChunk,
+    blobChunk
+};
+
+struct BlobProperty
+{
+    Identifier property;
+    Identifier reference;
+};
+
+static const BlobProperty blobProperties[] = {
+    { tags::state, "stateBlob" },
+    { tags::programState, "programStateBlob" }
+};
+
+struct Chunk
+{
+    int type = sessionChunk;
+    int graph = -1;
+    int64 offset = 0;
+    int64 size = 0;
+    int64 rawSize = 0;
+
+    ValueTree tree;
+    MemoryBlock data;
+    bool ok = false;
+};
+
+/** Runs a function for every chunk on a thread pool. Results can be
+    collected in order while later chunks are still being processed. */
+class ChunkJobs
+{
+public:
+    ChunkJobs (int numChunks, std::function<void (int)> f)
+        : fn (std::move (f)),
+          pool (jlimit (1, 8, SystemStats::getNumCpus()))
+    {
+        for (int i = 0; i < numChunks; ++i)
+            pool.addJob (jobs.add (new Job (fn, i)), false);
+    }
+
+    void wait (int index) { pool.waitForJobToFinish (jobs[index], -1); }
+
+    void waitAll()
+    {
+        for (auto* job : jobs)
+            pool.waitForJobToFinish (job, -1);
+    }
+
+private:
+    struct Job : public ThreadPoolJob
+    {
+        Job (const std::function<void (int)>& f, int i)
+            : ThreadPoolJob ("session archive"), fn (f), index (i) {}
+
+        JobStatus runJob() override
+        {
+            fn (index);
+            return jobHasFinished;
+        }
+
+        const std::function<void (int)>& fn;
+        const int index;
+    };
+
+    // the pool is declared last so it stops before the jobs are deleted.
+    std::function<void (int)> fn;
+    OwnedArray<Job> jobs;
+    ThreadPool pool;
+};
+
+/** Move large base64 states out of a graph into raw blobs, leaving the
+    index of the blob in their place. */
+static void extractBlobs (ValueTree tree, Array<MemoryBlock>& blobs)
+{
+    for (const auto& blob : blobProperties)
+    {
+        if (! tree.hasProperty (blob.property))
+            continue;
+
+        const auto& value = tree.getProperty (blob.property);
+        MemoryBlock data;
+        if (auto* binary = value.getBinaryData())
+        {
+            // states which were set as raw bytes.
+            if ((int) binary->getSize() * 4 / 3 < minBlobLength)
+                continue;
+            data = *binary;
+        }
+        else if (! value.isString() || value.toString().length() < minBlobLength
+                 || ! data.fromBase64Encoding (value.toString()))
+        {
+            continue;
+        }
+
+        tree.removeProperty (blob.property, nullptr);
+        tree.setProperty (blob.reference, blobs.size(), nullptr);
+        blobs.add (std::move (data));
+    }
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        extractBlobs (tree.getChild (i), blobs);
+}
+
+/** Point blob references at their index in the deduplicated blob list. */
+static void remapBlobs (ValueTree tree, const Array<int>& indexes)
+{
+    for (const auto& blob : blobProperties)
+        if (tree.hasProperty (blob.reference))
+            tree.setProperty (blob.reference, indexes[(int) tree.getProperty (blob.reference)], nullptr);
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        remapBlobs (tree.getChild (i), indexes);
+}
+
+/** Reverse of extractBlobs(), states are put back as shared text. */
+static bool resolveBlobs (ValueTree tree, const Array<String>& blobs)
+{
+    for (const auto& blob : blobProperties)
+    {
+        if (! tree.hasProperty (blob.reference))
+            continue;
+
+        const int index = tree.getProperty (blob.reference, -1);
+        if (! isPositiveAndBelow (index, blobs.size()))
+            return false;
+
+        // every node with this state holds the same string, and decoding
+        // it returns the blob's bytes without copying them.
+        tree.removeProperty (blob.reference, nullptr);
+        tree.setProperty (blob.property, blobs.getReference (index), nullptr);
+    }
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        if (! resolveBlobs (tree.getChild (i), blobs))
+            return false;
+
+    return true;
+}
+
+static void compressChunk (Chunk& chunk)
+{
+    if (chunk.tree.isValid())
+    {
+        MemoryOutputStream mo (chunk.data, false);
+        chunk.tree.writeToStream (mo);
+        mo.flush();
+        chunk.tree = ValueTree();
+    }
+
+    chunk.rawSize = (int64) chunk.data.getSize();
+
+    MemoryBlock compressed;
+    {
+        MemoryOutputStream mo (compressed, false);
+        GZIPCompressorOutputStream gzip (mo);
+        gzip.write (chunk.data.getData(), chunk.data.getSize());
+    }
+
+    chunk.data = std::move (compressed);
+    chunk.size = (int64) chunk.data.getSize();
+    chunk.ok = true;
+}
+
+static void decompressChunk (const File& file, Chunk& chunk)
+{
+    MemoryBlock compressed;
+    {
+        FileInputStream in (file);
+        if (! in.openedOk() || ! in.setPosition (chunk.offset)
+            || in.readIntoMemoryBlock (compressed, (ssize_t) chunk.size) != (size_t) chunk.size)
+            return;
+    }
+
+    MemoryInputStream mi (compressed, false);
+    GZIPDecompressorInputStream gzip (mi);
+    if (gzip.readIntoMemoryBlock (chunk.data, (ssize_t) chunk.rawSize) != (size_t) chunk.rawSize)
+        return;
+
+    if (chunk.type != blobChunk)
+    {
+        chunk.tree = ValueTree::readFromData (chunk.data.getData(), chunk.data.getSize());
+        chunk.data.reset();
+        if (! chunk.tree.isValid())
+            return;
+    }
+
+    chunk.ok = true;
+}
+
+} // namespace detail
+
+bool SessionArchive::isArchive (const File& file)
+{
+    FileInputStream in (file);
+    char magic[4] = { 0 };
+    return in.openedOk() && in.read (magic, 4) == 4
+           && std::memcmp (magic, detail::archiveMagic, 4) == 0;
+}
+
+bool SessionArchive::write (const ValueTree& session, const File& file, String& error)
+{
+    using namespace detail;
+    error.clear();
+
+    if (! session.isValid())
+    {
+        error = "No session data";
+        return false;
+    }
+
+    // the header chunk is the session without its graphs.
+    ValueTree header = session.createCopy();
+    Array<ValueTree> graphs;
+    {
+        auto graphsData = header.getChildWithName (tags::graphs);
+        for (int i = 0; i < graphsData.getNumChildren(); ++i)
+            graphs.add (graphsData.getChild (i));
+        graphsData.removeAllChildren (nullptr);
+    }
+
+    Array<Array<MemoryBlock>> blobs;
+    Array<Array<int64>> hashes;
+    blobs.resize (graphs.size());
+    hashes.resize (graphs.size());
+    {
+        ChunkJobs extract (graphs.size(), [&] (int g) {
+            extractBlobs (graphs.getReference (g), blobs.getReference (g));
+            for (const auto& blob : blobs.getReference (g))
+                hashes.getReference (g).add (StateCache::hashState (blob));
+        });
+        extract.waitAll();
+    }
+
+    // identical states, like many instances of one plugin, are stored once.
+    Array<MemoryBlock*> unique;
+    Array<Array<int>> indexes;
+    indexes.resize (graphs.size());
+    {
+        std::multimap<int64, int> byHash;
+        for (int g = 0; g < graphs.size(); ++g)
+        {
+            for (int i = 0; i < blobs.getReference (g).size(); ++i)
+            {
+                auto& blob = blobs.getReference (g).getReference (i);
+                const auto hash = hashes.getReference (g)[i];
+                int index = -1;
+
+                auto range = byHash.equal_range (hash);
+                for (auto iter = range.first; iter != range.second && index < 0; ++iter)
+                    if (*unique.getUnchecked (iter->second) == blob)
+                        index = iter->second;
+
+                if (index < 0)
+                {
+                    index = unique.size();
+                    unique.add (&blob);
+                    byHash.emplace (hash, index);
+                }
+
+                indexes.getReference (g).add (index);
+            }
+        }
+    }
+
+    {
+        ChunkJobs remap (graphs.size(), [&] (int g) {
+            remapBlobs (graphs.getReference (g), indexes.getReference (g));
+        });
+        remap.waitAll();
+    }
+
+    OwnedArray<Chunk> chunks;
+    auto* chunk = chunks.add (new Chunk());
+    chunk->tree = header;
+
+    for (int g = 0; g < graphs.size(); ++g)
+    {
+        chunk = chunks.add (new Chunk());
+        chunk->type = graphChunk;
+        chunk->graph = g;
+        chunk->tree = graphs.getReference (g);
+    }
+
+    for (int i = 0; i < unique.size(); ++i)
+    {
+        chunk = chunks.add (new Chunk());
+        chunk->type = blobChunk;
+        chunk->data = std::move (*unique.getUnchecked (i));
+    }
+
+    header = ValueTree();
+    graphs.clear();
+    unique.clear();
+    blobs.clear();
+
+    TemporaryFile tempFile (file);
+    auto out = tempFile.getFile().createOutputStream();
+    if (out == nullptr)
+    {
+        error = "Could not open session file for writing";
+        return false;
+    }
+
+    out->write (archiveMagic, 4);
+    out->writeInt (EL_SESSION_ARCHIVE_VERSION);
+    out->writeInt (chunks.size());
+    out->writeInt64 (0);
+
+    // compress everything at once, but write in order and release each
+    // chunk's memory as soon as it's on disk.
+    ChunkJobs compress (chunks.size(), [&] (int i) {
+        compressChunk (*chunks.getUnchecked (i));
+    });
+
+    for (int i = 0; i < chunks.size(); ++i)
+    {
+        compress.wait (i);
+        auto& c = *chunks.getUnchecked (i);
+        c.offset = out->getPosition();
+        out->write (c.data.getData(), c.data.getSize());
+        c.data.reset();
+    }
+
+    const auto tocOffset = out->getPosition();
+    for (const auto* c : chunks)
+    {
+        out->writeInt (c->type);
+        out->writeInt (c->graph);
+        out->writeInt64 (c->offset);
+        out->writeInt64 (c->size);
+        out->writeInt64 (c->rawSize);
+    }
+
+    out->setPosition (tocOffsetPosition);
+    out->writeInt64 (tocOffset);
+    out->flush();
+
+    const bool ok = out->getStatus().wasOk();
+    out.reset();
+
+    if (! ok || ! tempFile.overwriteTargetFileWithTemporary())
+    {
+        error = "Error writing session file";
+        return false;
+    }
+
+    return true;
+}
+
+ValueTree SessionArchive::read (const File& file, String& error)
+{
+    using namespace detail;
+    error.clear();
+
+    OwnedArray<Chunk> chunks;
+    int version = 0;
+    {
+        FileInputStream in (file);
+        char magic[4] = { 0 };
+        if (! in.openedOk() || in.read (magic, 4) != 4
+            || std::memcmp (magic, archiveMagic, 4) != 0)
+        {
+            error = "Not a session archive";
+            return {};
+        }
+
+        version = in.readInt();
+        const int numChunks = in.readInt();
+        const int64 tocOffset = in.readInt64();
+        if (version > EL_SESSION_ARCHIVE_VERSION)
+        {
+            error = "Session archive was written by a newer version";
+            return {};
+        }
+
+        if (version < 1)
+        {
+            error = "Session archive is damaged";
+            return {};
+        }
+
+        if (numChunks < 1 || tocOffset < archiveHeaderSize
+            || tocOffset + (int64) numChunks * tocEntrySize > in.getTotalLength()
+            || ! in.setPosition (tocOffset))
+        {
+            error = "Session archive is damaged";
+            return {};
+        }
+
+        for (int i = 0; i < numChunks; ++i)
+        {
+            auto* c = chunks.add (new Chunk());
+            c->type = in.readInt();
+            c->graph = in.readInt();
+            c->offset = in.readInt64();
+            c->size = in.readInt64();
+            c->rawSize = in.readInt64();
+
+            if (c->offset < archiveHeaderSize || c->size < 0 || c->rawSize < 0
+                || c->size > tocOffset - c->offset
+                || c->rawSize > jmin (maxChunkSize, c->size * maxCompressionRatio + 64))
+            {
+                error = "Session archive is damaged";
+                return {};
+            }
+        }
+    }
+
+    {
+        ChunkJobs decompress (chunks.size(), [&] (int i) {
+            decompressChunk (file, *chunks.getUnchecked (i));
+        });
+        decompress.waitAll();
+    }
+
+    ValueTree session;
+    Array<ValueTree> graphs;
+    Array<Chunk*> blobs;
+
+    for (auto* c : chunks)
+    {
+        if (! c->ok)
+        {
+            error = "Could not decompress session data";
+            return {};
+        }
+
+        if (c->type == sessionChunk)
+        {
+            session = c->tree;
+        }
+        else if (c->type == graphChunk)
+        {
+            graphs.add (c->tree);
+        }
+        else if (c->type == blobChunk)
+        {
+            blobs.add (c);
+        }
+    }
+
+    if (! session.isValid())
+    {
+        error = "Session archive has no session data";
+        return {};
+    }
+
+    Array<String> blobTexts;
+    blobTexts.resize (blobs.size());
+    {
+        ChunkJobs share (blobs.size(), [&] (int i) {
+            blobTexts.getReference (i) = StateCache::share (std::move (blobs.getUnchecked (i)->data));
+        });
+        share.waitAll();
+    }
+
+    // blobs are numbered across the whole session, graphs share them.
+    std::atomic<bool> resolved { true };
+    {
+        ChunkJobs resolve (graphs.size(), [&] (int g) {
+            if (! resolveBlobs (graphs.getReference (g), blobTexts))
+                resolved.store (false);
+        });
+        resolve.waitAll();
+    }
+
+    if (! resolved.load())
+    {
+        error = "Session archive is missing plugin state";
+        return {};
+    }
+
+    auto graphsData = session.getOrCreateChildWithName (tags::graphs, nullptr);
+    for (const auto& graph : graphs)
+        graphsData.addChild (graph, -1, nullptr);
+
+    return session;
+}
+
+} // namespace element
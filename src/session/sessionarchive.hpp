@@ -0,0 +1,39 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <element/juce/core.hpp>
+#include <element/juce/data_structures.hpp>
+
+namespace element {
+
+/** Binary, chunked session file.
+
+    The session is split into a header chunk, one chunk per graph and one
+    chunk per distinct large plugin state; identical states are stored once.
+    Plugin states are stored as raw bytes instead of base64 and every chunk
+    is compressed separately, so chunks can be compressed and decompressed
+    on several threads at once.  A table of contents at the end of the file
+    lists the chunks.
+
+    Chunks are written in order as soon as they are compressed, so a large
+    session is never held in memory twice in compressed form.
+ */
+class SessionArchive
+{
+public:
+    /** Returns true if the file starts with the archive's magic. */
+    static bool isArchive (const juce::File& file);
+
+    /** Write session data to a file.  The data should already be sanitized. */
+    static bool write (const juce::ValueTree& session, const juce::File& file, juce::String& error);
+
+    /** Read session data from a file.  Returns an invalid tree on error. */
+    static juce::ValueTree read (const juce::File& file, juce::String& error);
+
+private:
+    SessionArchive() = delete;
+};
+
+} // namespace element
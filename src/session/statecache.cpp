@@ -0,0 +1,209 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <map>
+
+#include <element/tags.hpp>
+
+#include "session/statecache.hpp"
+
+using namespace juce;
+
+namespace element {
+namespace detail {
+
+/** Small states are cheaper to decode than to look up. */
+static constexpr int minCachedLength = 256;
+static constexpr size_t maxStateCacheBytes = 64 * 1024 * 1024;
+
+class StateCacheData
+{
+public:
+    struct Entry
+    {
+        String text;
+        size_t textBytes = 0;
+        std::shared_ptr<const MemoryBlock> decoded;
+        uint32 lastUsed = 0;
+    };
+
+    CriticalSection lock;
+
+    /** Returns the entry for some text, adding it if needed. Call with the
+        lock held. */
+    Entry& get (const String& text, int64 hash)
+    {
+        auto range = entries.equal_range (hash);
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            if (iter->second.text == text)
+            {
+                iter->second.lastUsed = ++clock;
+                return iter->second;
+            }
+        }
+
+        auto iter = entries.emplace (hash, Entry());
+        auto& entry = iter->second;
+        entry.text = text;
+        entry.textBytes = text.getNumBytesAsUTF8();
+        entry.lastUsed = ++clock;
+        numBytes += entry.textBytes;
+        return entry;
+    }
+
+    void setDecoded (Entry& entry, std::shared_ptr<const MemoryBlock> decoded)
+    {
+        if (entry.decoded != nullptr)
+            return;
+        entry.decoded = std::move (decoded);
+        numBytes += entry.decoded->getSize();
+    }
+
+    /** Drop least recently used entries until under the limit. Call with
+        the lock held. */
+    void trim()
+    {
+        while (numBytes > maxStateCacheBytes && entries.size() > 1)
+        {
+            auto oldest = entries.begin();
+            for (auto iter = entries.begin(); iter != entries.end(); ++iter)
+                if (iter->second.lastUsed < oldest->second.lastUsed)
+                    oldest = iter;
+
+            numBytes -= oldest->second.textBytes;
+            if (oldest->second.decoded != nullptr)
+                numBytes -= oldest->second.decoded->getSize();
+            entries.erase (oldest);
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        numBytes = 0;
+    }
+
+private:
+    std::multimap<int64, Entry> entries;
+    size_t numBytes = 0;
+    uint32 clock = 0;
+};
+
+static StateCacheData& stateCache()
+{
+    static StateCacheData data;
+    return data;
+}
+
+static std::shared_ptr<const MemoryBlock> decodeBase64 (const String& state)
+{
+    auto block = std::make_shared<MemoryBlock>();
+    block->fromBase64Encoding (state);
+    return block;
+}
+
+} // namespace detail
+
+String StateCache::intern (const String& state)
+{
+    if (state.length() < detail::minCachedLength)
+        return state;
+
+    auto& cache = detail::stateCache();
+    const auto hash = state.hashCode64();
+    const ScopedLock sl (cache.lock);
+    const auto text = cache.get (state, hash).text;
+    cache.trim();
+    return text;
+}
+
+std::shared_ptr<const MemoryBlock> StateCache::decode (const String& state)
+{
+    if (state.length() < detail::minCachedLength)
+        return detail::decodeBase64 (state);
+
+    auto& cache = detail::stateCache();
+    const auto hash = state.hashCode64();
+
+    {
+        const ScopedLock sl (cache.lock);
+        if (auto decoded = cache.get (state, hash).decoded)
+            return decoded;
+    }
+
+    // decode without the lock so other states can be restored meanwhile.
+    auto decoded = detail::decodeBase64 (state);
+
+    const ScopedLock sl (cache.lock);
+    auto& entry = cache.get (state, hash);
+    cache.setDecoded (entry, decoded);
+    decoded = entry.decoded;
+    cache.trim();
+    return decoded;
+}
+
+std::shared_ptr<const MemoryBlock> StateCache::decode (const var& state)
+{
+    if (auto* data = state.getBinaryData())
+        return std::make_shared<const MemoryBlock> (*data);
+    return decode (state.toString().trim());
+}
+
+String StateCache::share (MemoryBlock data)
+{
+    auto text = data.toBase64Encoding();
+    if (text.length() < detail::minCachedLength)
+        return text;
+
+    auto& cache = detail::stateCache();
+    const auto hash = text.hashCode64();
+    auto decoded = std::make_shared<const MemoryBlock> (std::move (data));
+
+    const ScopedLock sl (cache.lock);
+    auto& entry = cache.get (text, hash);
+    cache.setDecoded (entry, std::move (decoded));
+    text = entry.text;
+    cache.trim();
+    return text;
+}
+
+void StateCache::internStates (ValueTree tree)
+{
+    for (const auto& property : { tags::state, tags::programState })
+    {
+        const auto& value = tree.getProperty (property);
+        if (! value.isString())
+            continue;
+
+        // an equal value wouldn't replace the existing one, so remove it first.
+        const auto text = value.toString();
+        const auto interned = intern (text);
+        if (interned.getCharPointer() == text.getCharPointer())
+            continue;
+        tree.removeProperty (property, nullptr);
+        tree.setProperty (property, interned, nullptr);
+    }
+
+    for (int i = 0; i < tree.getNumChildren(); ++i)
+        internStates (tree.getChild (i));
+}
+
+int64 StateCache::hashState (const MemoryBlock& data)
+{
+    // 64-bit FNV-1a
+    uint64 hash = 14695981039346656037ull;
+    const auto* bytes = static_cast<const uint8*> (data.getData());
+    for (size_t i = 0; i < data.getSize(); ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return (int64) hash;
+}
+
+void StateCache::clear()
+{
+    auto& cache = detail::stateCache();
+    const ScopedLock sl (cache.lock);
+    cache.clear();
+}
+
+} // namespace element
@@ -0,0 +1,55 @@
+// Copyright 2014-2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#pragma once
+
+#include <memory>
+
+#include <element/juce/core.hpp>
+#include <element/juce/data_structures.hpp>
+
+namespace element {
+
+/** Process wide cache of base64 plugin states keyed by their content.
+
+    Nodes created from the same preset, default node or session blob carry
+    the same state text.  The cache lets them share one copy of that text
+    and decode it only once, no matter how many instances restore it.
+    Least recently used entries are dropped once the cache grows past its
+    size limit.
+ */
+class StateCache
+{
+public:
+    /** Returns a string equal to state that shares storage with every other
+        interned copy of the same text. */
+    static juce::String intern (const juce::String& state);
+
+    /** Returns the decoded bytes of a base64 state. */
+    static std::shared_ptr<const juce::MemoryBlock> decode (const juce::String& state);
+
+    /** Returns the bytes of a state property, which is base64 text or
+        binary data. */
+    static std::shared_ptr<const juce::MemoryBlock> decode (const juce::var& state);
+
+    /** Returns interned base64 text for raw state bytes, with the bytes
+        themselves kept as its decoded value.  States read in binary, like
+        the blobs of a session archive, are shared this way by every node
+        which restores them instead of being copied into each one. */
+    static juce::String share (juce::MemoryBlock data);
+
+    /** Intern the state and program state properties of a tree and all of
+        its children. */
+    static void internStates (juce::ValueTree tree);
+
+    /** Returns a hash of raw state data, used to find identical states. */
+    static juce::int64 hashState (const juce::MemoryBlock& data);
+
+    /** Drop everything in the cache. */
+    static void clear();
+
+private:
+    StateCache() = delete;
+};
+
+} // namespace element
@@ -6,6 +6,7 @@
 #include <element/settings.hpp>
 
 #include "appinfo.hpp"
+#include "engine/diskstreaming.hpp"
 #include "engine/midiengine.hpp"
 #include "engine/midipanic.hpp"
 
@@ -41,6 +42,10 @@ const char* Settings::updateKeyTypeKey = "updateKeyType";
 const char* Settings::updateKeyKey = "updateKey";
 const char* Settings::updateKeyUserKey = "updateKeyUserKey";
 const char* Settings::transportStartStopContinue = "transportStartStopContinueKey";
+const char* Settings::diskStreamingThreadsKey = "diskStreamingThreads";
+const char* Settings::diskStreamingLatencyKey = "diskStreamingLatency";
+const char* Settings::binarySessionsKey = "binarySessions";
+const char* Settings::autosaveIntervalKey = "autosaveInterval";
 
 //=============================================================================
 enum OptionsMenuItemId
@@ -231,6 +236,32 @@ void Settings::setAskToSaveSession (const bool value)
         props->setValue (askToSaveSessionKey, value);
 }
 
+bool Settings::binarySessions() const
+{
+    if (auto* props = getProps())
+        return props->getBoolValue (binarySessionsKey, false);
+    return false;
+}
+
+void Settings::setBinarySessions (bool value)
+{
+    if (auto* props = getProps())
+        props->setValue (binarySessionsKey, value);
+}
+
+int Settings::getAutosaveInterval() const
+{
+    if (auto* props = getProps())
+        return props->getIntValue (autosaveIntervalKey, 300);
+    return 300;
+}
+
+void Settings::setAutosaveInterval (int seconds)
+{
+    if (auto* props = getProps())
+        props->setValue (autosaveIntervalKey, jmax (0, seconds));
+}
+
 bool Settings::sendMidiClockToInput() const
 {
     if (auto* props = getProps())
@@ -505,6 +536,33 @@ bool Settings::transportRespondToStartStopContinue() const
     return false;
 }
 
+//=============================================================================
+int Settings::getDiskStreamingThreads() const
+{
+    if (auto* p = getProps())
+        return p->getIntValue (diskStreamingThreadsKey, DiskStreamingPool::getDefaultNumThreads());
+    return DiskStreamingPool::getDefaultNumThreads();
+}
+
+void Settings::setDiskStreamingThreads (int numThreads)
+{
+    if (auto* p = getProps())
+        p->setValue (diskStreamingThreadsKey, jlimit (1, 32, numThreads));
+}
+
+double Settings::getDiskStreamingLatency() const
+{
+    if (auto* p = getProps())
+        return p->getDoubleValue (diskStreamingLatencyKey, 50.0);
+    return 50.0;
+}
+
+void Settings::setDiskStreamingLatency (double latencyMs)
+{
+    if (auto* p = getProps())
+        p->setValue (diskStreamingLatencyKey, latencyMs);
+}
+
 //=============================================================================
 void Settings::addItemsToMenu (Context& world, PopupMenu& menu)
 {
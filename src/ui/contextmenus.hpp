@@ -205,7 +205,7 @@ public:
         int index = 40000;
         ProcessorPtr ptr = node.getObject();
 
-        if (ptr == nullptr || ptr->isAudioIONode() || ptr->isMidiIONode()) // not the right type of node
+        if (ptr == nullptr || ptr->isAudioIONode() || ptr->isMidiIONode() || ptr->isRootGraph()) // not the right type of node
             return;
 
         osMenu.addItem (index++, "Off", true, ptr->getOversamplingFactor() == 1);
@@ -432,6 +432,118 @@ private:
     }
 };
 
+class GraphOversamplingPropertyComponent : public ChoicePropertyComponent
+{
+public:
+    GraphOversamplingPropertyComponent (const Node& g)
+        : ChoicePropertyComponent ("Oversampling"),
+          graph (g)
+    {
+        jassert (graph.isGraph() && ! graph.isRootGraph());
+        choices.add ("Off");
+        choices.add ("2x");
+        choices.add ("4x");
+        choices.add ("8x");
+    }
+
+    inline int getIndex() const override
+    {
+        const int factor = jlimit (1, 8, (int) graph.getProperty (tags::oversamplingFactor, 1));
+        return roundToInt (std::log2 ((double) factor));
+    }
+
+    inline void setIndex (const int index) override
+    {
+        if (! isPositiveAndBelow (index, choices.size()))
+            return;
+
+        const int factor = 1 << index;
+        graph.setProperty (tags::oversamplingFactor, factor);
+        if (ProcessorPtr obj = graph.getObject())
+            obj->setOversamplingFactor (factor);
+    }
+
+private:
+    Node graph;
+};
+
+class LatencyReportPropertyComponent : public PropertyComponent
+{
+public:
+    LatencyReportPropertyComponent (const Node& g)
+        : PropertyComponent ("Latency", 100),
+          graph (dynamic_cast<GraphNode*> (g.getObject()))
+    {
+        addAndMakeVisible (text);
+        text.setMultiLine (true, false);
+        text.setReadOnly (true);
+        text.setScrollbarsShown (true);
+
+        if (graph != nullptr)
+        {
+            sequenceChanged = graph->renderingSequenceChanged.connect ([this]() { refresh(); });
+            latencyChanged = graph->latencyChanged.connect ([this]() { refresh(); });
+        }
+
+        refresh();
+    }
+
+    ~LatencyReportPropertyComponent()
+    {
+        sequenceChanged.disconnect();
+        latencyChanged.disconnect();
+    }
+
+    void refresh() override
+    {
+        if (graph == nullptr)
+        {
+            text.setText ({}, dontSendNotification);
+            return;
+        }
+
+        String report;
+        report << "Total: " << graph->getLatencySamples() << " samples" << newLine;
+
+        int numDelayed = 0;
+        for (const auto& lc : graph->getLatencyCompensation())
+        {
+            if (lc.delaySamples <= 0)
+                continue;
+            ++numDelayed;
+            report << nodeName (lc.sourceNode) << " > " << nodeName (lc.destNode)
+                   << " (" << lc.type.getName() << "): "
+                   << lc.delaySamples << " samples" << newLine;
+        }
+
+        if (numDelayed == 0)
+            report << "No paths compensated" << newLine;
+
+        for (const auto& warning : graph->getLatencyWarnings())
+            report << "Warning: " << warning << newLine;
+
+        text.setText (report.trimEnd(), dontSendNotification);
+    }
+
+    void resized() override
+    {
+        text.setBounds (getLookAndFeel().getPropertyComponentContentPosition (*this));
+    }
+
+private:
+    using Proc = juce::ReferenceCountedObjectPtr<GraphNode>;
+    Proc graph;
+    TextEditor text;
+    boost::signals2::connection sequenceChanged, latencyChanged;
+
+    String nodeName (uint32 nodeId) const
+    {
+        if (auto* node = graph->getNodeForId (nodeId))
+            return node->getName();
+        return String (static_cast<int> (nodeId));
+    }
+};
+
 class GraphPropertyPanel : public PropertyPanel
 {
 public:
@@ -493,6 +605,11 @@ private:
         props.add (new GraphChannelCountPropertyComponent (g, PortType::Audio, false));
         props.add (new GraphChannelCountPropertyComponent (g, PortType::Midi, true));
         props.add (new GraphChannelCountPropertyComponent (g, PortType::Midi, false));
+#if ! ELEMENT_SE
+        if (! g.isRootGraph())
+            props.add (new GraphOversamplingPropertyComponent (g));
+        props.add (new LatencyReportPropertyComponent (g));
+#endif
         // props.add (new BooleanPropertyComponent (g.getPropertyAsValue (tags::persistent),
         //                                          TRANS("Persistent"),
         //                                          TRANS("Don't unload when deactivated")));
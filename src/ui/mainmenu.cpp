@@ -237,6 +237,10 @@ void MainMenu::buildFileMenu (PopupMenu& menu)
     menu.addCommandItem (&cmd, Commands::sessionSave, "Save Session");
     menu.addCommandItem (&cmd, Commands::sessionSaveAs, "Save Session As...");
     menu.addSeparator();
+    menu.addCommandItem (&cmd, Commands::sessionOpenSetList, "Open Set List...");
+    menu.addCommandItem (&cmd, Commands::sessionPreviousInSetList, "Previous Session");
+    menu.addCommandItem (&cmd, Commands::sessionNextInSetList, "Next Session");
+    menu.addSeparator();
     menu.addCommandItem (&cmd, Commands::importGraph, "Import...");
     menu.addCommandItem (&cmd, Commands::exportGraph, "Export graph...");
 
@@ -129,6 +129,7 @@ public:
                     {
                         node.savePluginState();
                         node.writeToFile (ptr->getMidiProgramFile());
+                        ptr->clearMidiProgramCache (ptr->getMidiProgram());
                     }
                 }
                 else
@@ -294,6 +295,9 @@ NodeProperties::NodeProperties (const Node& n, bool nodeProps, bool midiProps)
         if (detail::showNodeDelayComp (node))
             add (new MillisecondSliderPropertyComponent (
                 node.getPropertyAsValue (tags::delayCompensation), "Delay comp."));
+        add (new BooleanPropertyComponent (node.getPropertyAsValue (tags::liveMode),
+                                           "Live mode",
+                                           "Skip latency alignment"));
     }
 
     if (midiProps)
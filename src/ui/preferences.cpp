@@ -15,6 +15,7 @@
 #include "ui/guicommon.hpp"
 #include "ui/viewhelpers.hpp"
 #include "services/oscservice.hpp"
+#include "services/sessionservice.hpp"
 #include "engine/midiengine.hpp"
 #include "engine/midipanic.hpp"
 
@@ -408,6 +409,36 @@ public:
         askToSaveSession.setToggleState (settings.askToSaveSession(), dontSendNotification);
         askToSaveSession.getToggleStateValue().addListener (this);
 
+        addAndMakeVisible (binarySessionsLabel);
+        binarySessionsLabel.setText (String ("Save XXXs in binary format").replace ("XXX", sessionStr),
+                                     dontSendNotification);
+        binarySessionsLabel.setFont (Font (12.0, Font::bold));
+        addAndMakeVisible (binarySessions);
+        binarySessions.setClickingTogglesState (true);
+        binarySessions.setToggleState (settings.binarySessions(), dontSendNotification);
+        binarySessions.getToggleStateValue().addListener (this);
+
+        addAndMakeVisible (autosaveIntervalLabel);
+        autosaveIntervalLabel.setText ("Autosave interval (seconds)", dontSendNotification);
+        autosaveIntervalLabel.setFont (Font (12.0, Font::bold));
+        addAndMakeVisible (autosaveInterval);
+        autosaveInterval.textFromValueFunction = [] (double value) -> String {
+            return value < 1.0 ? String ("Off") : String (roundToInt (value));
+        };
+        autosaveInterval.valueFromTextFunction = [] (const String& text) -> double {
+            return (double) jmax (0, text.getIntValue());
+        };
+        autosaveInterval.setRange (0.0, 3600.0, 1.0);
+        autosaveInterval.setValue ((double) settings.getAutosaveInterval());
+        autosaveInterval.setSliderStyle (Slider::IncDecButtons);
+        autosaveInterval.setTextBoxStyle (Slider::TextBoxLeft, false, 82, 22);
+        autosaveInterval.onValueChange = [this]() {
+            const auto seconds = roundToInt (autosaveInterval.getValue());
+            settings.setAutosaveInterval (seconds);
+            if (auto* sessions = gui.sibling<SessionService>())
+                sessions->setAutosaveInterval (seconds);
+        };
+
         addAndMakeVisible (systrayLabel);
         systrayLabel.setText ("Show system tray", dontSendNotification);
         systrayLabel.setFont (Font (12.0, Font::bold));
@@ -438,6 +469,20 @@ public:
             }
         };
 
+        addAndMakeVisible (diskThreadsLabel);
+        diskThreadsLabel.setText ("Disk streaming threads", dontSendNotification);
+        diskThreadsLabel.setFont (Font (12.0, Font::bold));
+        addAndMakeVisible (diskThreads);
+        diskThreads.setRange (1.0, 32.0, 1.0);
+        diskThreads.setValue ((double) settings.getDiskStreamingThreads());
+        diskThreads.setSliderStyle (Slider::IncDecButtons);
+        diskThreads.setTextBoxStyle (Slider::TextBoxLeft, false, 82, 22);
+        diskThreads.onValueChange = [this]() {
+            settings.setDiskStreamingThreads (roundToInt (diskThreads.getValue()));
+            if (engine != nullptr)
+                engine->applySettings (settings);
+        };
+
         addAndMakeVisible (defaultSessionFileLabel);
         defaultSessionFileLabel.setText ("Default new Session", dontSendNotification);
         defaultSessionFileLabel.setFont (Font (12.0, Font::bold));
@@ -528,6 +573,8 @@ public:
         layoutSetting (r, hidePluginWindowsLabel, hidePluginWindows);
         layoutSetting (r, openLastSessionLabel, openLastSession);
         layoutSetting (r, askToSaveSessionLabel, askToSaveSession);
+        layoutSetting (r, binarySessionsLabel, binarySessions);
+        layoutSetting (r, autosaveIntervalLabel, autosaveInterval, getWidth() / 4);
 
         r.removeFromTop (spacingBetweenSections);
         r2 = r.removeFromTop (settingHeight);
@@ -536,6 +583,7 @@ public:
 
         layoutSetting (r, systrayLabel, systray);
         layoutSetting (r, desktopScaleLabel, desktopScale, getWidth() / 4);
+        layoutSetting (r, diskThreadsLabel, diskThreads, getWidth() / 4);
 
 #if ! ELEMENT_SE
         layoutSetting (r, defaultSessionFileLabel, defaultSessionFile, 190 - settingHeight);
@@ -590,6 +638,10 @@ public:
         {
             settings.setAskToSaveSession (askToSaveSession.getToggleState());
         }
+        else if (value.refersToSameSourceAs (binarySessions.getToggleStateValue()))
+        {
+            settings.setBinarySessions (binarySessions.getToggleState());
+        }
         else if (value.refersToSameSourceAs (hidePluginWindows.getToggleStateValue()))
         {
             settings.setHidePluginWindowsWhenFocusLost (hidePluginWindows.getToggleState());
@@ -653,6 +705,12 @@ private:
     Label askToSaveSessionLabel;
     SettingButton askToSaveSession;
 
+    Label binarySessionsLabel;
+    SettingButton binarySessions;
+
+    Label autosaveIntervalLabel;
+    Slider autosaveInterval;
+
     Label defaultSessionFileLabel;
     FilenameComponent defaultSessionFile;
     TextButton defaultSessionClearButton;
@@ -663,6 +721,9 @@ private:
     Label desktopScaleLabel;
     Slider desktopScale;
 
+    Label diskThreadsLabel;
+    Slider diskThreads;
+
     Label mainContentLabel;
     ComboBox mainContentBox;
 
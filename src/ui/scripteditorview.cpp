@@ -124,20 +124,42 @@ ScriptNodeScriptEditorView::ScriptNodeScriptEditorView (Context& context, const
     applyButton.setButtonText (editingUI ? TRANS ("Apply") : TRANS ("Apply"));
     addAndMakeVisible (applyButton);
     applyButton.onClick = [this]() {
-        auto r = updateScript();
-        if (! r.wasOk())
+        auto showError = [] (Result r) {
+            if (! r.wasOk())
+            {
+                AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon,
+                                                  "Script Error",
+                                                  r.getErrorMessage());
+            }
+        };
+
+        ScriptNode::Ptr sn = dynamic_cast<ScriptNode*> (node.getObject());
+        if (sn != nullptr && ! isEditingUI())
         {
-            AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon,
-                                              "Script Error",
-                                              r.getErrorMessage());
+            // compile in the background so audio keeps running.
+            auto& doc = sn->getCodeDocument (false);
+            doc.replaceAllContent (getCodeDocument().getAllContent());
+            sn->loadScriptAsync (doc.getAllContent(), showError);
+            return;
         }
+
+        showError (updateScript());
     };
 
+    if (! editingUI)
+    {
+        status.setFont (status.getFont().withHeight (12.f));
+        status.setJustificationType (Justification::centredRight);
+        addAndMakeVisible (status);
+        startTimer (500);
+    }
+
     reload();
 }
 
 ScriptNodeScriptEditorView::~ScriptNodeScriptEditorView()
 {
+    stopTimer();
     for (auto& c : connections)
         c.disconnect();
     connections.clear();
@@ -172,9 +194,30 @@ String ScriptNodeScriptEditorView::getScriptContent() const
     return {};
 }
 
+void ScriptNodeScriptEditorView::timerCallback()
+{
+    String text;
+    if (ScriptNode::Ptr sn = dynamic_cast<ScriptNode*> (node.getObject()))
+    {
+        // the graph measures the whole render, script included.
+        text << "CPU: " << String (sn->getCpuLoad() * 100.f, 1) << "%";
+        if (sn->getErrorMessage().isNotEmpty())
+            text << "  " << sn->getErrorMessage();
+    }
+
+    status.setText (text, dontSendNotification);
+}
+
 void ScriptNodeScriptEditorView::resized()
 {
     BaseScriptEditorView::resized();
+    if (status.isVisible())
+    {
+        auto r = getLocalBounds();
+        status.setBounds (r.removeFromBottom (18).reduced (4, 0));
+        getEditor().setBounds (r);
+    }
+
     applyButton.changeWidthToFitText (22);
     applyButton.setBounds (
         getWidth() - 16 - applyButton.getWidth(),
@@ -144,7 +144,8 @@ private:
 };
 
 //==============================================================================
-class ScriptNodeScriptEditorView : public BaseScriptEditorView
+class ScriptNodeScriptEditorView : public BaseScriptEditorView,
+                                   private juce::Timer
 {
 public:
     ScriptNodeScriptEditorView (Context& ctx, const Node& n, bool editUI);
@@ -164,7 +165,10 @@ private:
     Node node;
     bool editingUI;
     TextButton applyButton;
+    Label status;
     std::vector<boost::signals2::connection> connections;
+
+    void timerCallback() override;
 };
 
 } // namespace element
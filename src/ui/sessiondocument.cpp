@@ -1,60 +1,181 @@
 // Copyright 2023 Kushview, LLC <info@kushview.net>
 // SPDX-License-Identifier: GPL3-or-later
 
+#include <element/node.hpp>
 #include <element/session.hpp>
+#include "session/sessionarchive.hpp"
+#include "session/statecache.hpp"
 #include "ui/sessiondocument.hpp"
 
 namespace element {
 
+/** Writes session snapshots on a background thread, in the order saved. */
+class SessionDocument::Writer
+{
+public:
+    Writer (AsyncUpdater& u) : updater (u), pool (1) {}
+
+    void write (const ValueTree& data, const File& file, bool binary)
+    {
+        ++numPending;
+        pool.addJob (new Job (*this, data, file, binary), true);
+    }
+
+    void waitForPending()
+    {
+        while (numPending.load() > 0)
+            jobFinished.wait (50);
+    }
+
+    /** Returns the saves finished since last called. */
+    std::vector<std::pair<File, Result>> takeFinished()
+    {
+        const ScopedLock sl (lock);
+        return std::exchange (finished, {});
+    }
+
+private:
+    struct Job : public ThreadPoolJob
+    {
+        Job (Writer& w, const ValueTree& d, const File& f, bool b)
+            : ThreadPoolJob ("session save"), writer (w), data (d), file (f), binary (b) {}
+
+        JobStatus runJob() override
+        {
+            auto result = Result::ok();
+            String error;
+            if (binary)
+            {
+                if (! SessionArchive::write (data, file, error))
+                    result = Result::fail (error);
+            }
+            else
+            {
+                auto xml = data.createXml();
+                if (xml == nullptr || ! xml->writeTo (file))
+                    result = Result::fail ("Error writing session file");
+            }
+
+            if (result.failed())
+                std::clog << "[element] save failed: " << result.getErrorMessage().toStdString() << std::endl;
+
+            data = ValueTree();
+            writer.finish (file, result);
+            return jobHasFinished;
+        }
+
+        Writer& writer;
+        ValueTree data;
+        const File file;
+        const bool binary;
+    };
+
+    AsyncUpdater& updater;
+    CriticalSection lock;
+    std::vector<std::pair<File, Result>> finished;
+    std::atomic<int> numPending { 0 };
+    WaitableEvent jobFinished;
+    ThreadPool pool;
+
+    void finish (const File& file, const Result& result)
+    {
+        {
+            const ScopedLock sl (lock);
+            finished.emplace_back (file, result);
+        }
+
+        --numPending;
+        jobFinished.signal();
+        updater.triggerAsyncUpdate();
+    }
+};
+
 SessionDocument::SessionDocument (SessionPtr s)
     : FileBasedDocument (".els", "*.els", "Open Session", "Save Session"),
       session (s)
 {
+    writer = std::make_unique<Writer> (*this);
     if (session)
         session->addChangeListener (this);
 }
 
 SessionDocument::~SessionDocument()
 {
+    waitForPendingSave();
+    cancelPendingUpdate();
+    writer.reset();
     if (session)
         session->removeChangeListener (this);
 }
 
-String SessionDocument::getDocumentTitle()
+void SessionDocument::waitForPendingSave()
 {
-    return (session != nullptr) ? session->getName() : "Unknown";
+    writer->waitForPending();
 }
 
-Result SessionDocument::loadDocument (const File& file)
+void SessionDocument::handleAsyncUpdate()
 {
-    if (nullptr == session)
-        return Result::fail ("No session data target");
-
-    String error;
-    if (auto e = XmlDocument::parse (file))
+    for (const auto& save : writer->takeFinished())
     {
-        ValueTree newData (ValueTree::fromXml (*e));
-        if (newData.isValid() && (int) newData.getProperty (tags::version, -1) != EL_SESSION_VERSION)
-        {
-            std::clog << "[element] migrate session...\n";
-            newData = Session::migrate (newData, error);
-        }
+        if (save.second.failed())
+            setChangedFlag (true);
+        if (onSaveFinished)
+            onSaveFinished (save.first, save.second);
+    }
+}
 
-        if (error.isEmpty() && (! newData.isValid() || ! newData.hasType (types::Session)))
-        {
-            error = "Not a valid session file or type";
-            if (newData.isValid())
-                error << ": el." << newData.getType().toString();
-        }
+String SessionDocument::getDocumentTitle()
+{
+    return (session != nullptr) ? session->getName() : "Unknown";
+}
 
-        if (error.isEmpty() && ! session->loadData (newData))
-            error = "Could not load session data";
+ValueTree SessionDocument::readSessionData (const File& file, String& error)
+{
+    ValueTree newData;
+    if (SessionArchive::isArchive (file))
+    {
+        newData = SessionArchive::read (file, error);
+    }
+    else if (auto e = XmlDocument::parse (file))
+    {
+        newData = ValueTree::fromXml (*e);
+        StateCache::internStates (newData);
     }
     else
     {
         error = "Not a valid session file";
     }
 
+    if (error.isEmpty() && newData.isValid() && (int) newData.getProperty (tags::version, -1) != EL_SESSION_VERSION)
+    {
+        std::clog << "[element] migrate session...\n";
+        newData = Session::migrate (newData, error);
+    }
+
+    if (error.isEmpty() && (! newData.isValid() || ! newData.hasType (types::Session)))
+    {
+        error = "Not a valid session file or type";
+        if (newData.isValid())
+            error << ": el." << newData.getType().toString();
+    }
+
+    return error.isEmpty() ? newData : ValueTree();
+}
+
+Result SessionDocument::loadDocument (const File& file)
+{
+    if (nullptr == session)
+        return Result::fail ("No session data target");
+
+    waitForPendingSave();
+
+    String error;
+    ValueTree newData = preloaded.isValid() ? preloaded : readSessionData (file, error);
+    preloaded = ValueTree();
+
+    if (error.isEmpty() && ! session->loadData (newData))
+        error = "Could not load session data";
+
     if (error.isEmpty())
     {
         session->forEach ([&] (const ValueTree& d) {
@@ -74,15 +195,16 @@ Result SessionDocument::saveDocument (const File& file)
         return Result::fail ("Nil session");
 
     session->saveGraphState();
-    if (auto e = session->createXml())
-    {
-        Result res (e->writeTo (file)
-                        ? Result::ok()
-                        : Result::fail ("Error writing session file"));
-        return res;
-    }
 
-    return Result::fail ("Could not create session data");
+    // plugin states are collected here, compressing and writing a large
+    // session happens in the background so the UI keeps running.
+    ValueTree data = session->data().createCopy();
+    Node::sanitizeProperties (data, true);
+    if (! data.isValid())
+        return Result::fail ("Could not create session data");
+
+    writer->write (data, file, binaryFormat);
+    return Result::ok();
 }
 
 File SessionDocument::getLastDocumentOpened() { return lastSession; }
@@ -8,7 +8,8 @@
 
 namespace element {
 class SessionDocument : public FileBasedDocument,
-                        public ChangeListener
+                        public ChangeListener,
+                        private AsyncUpdater
 {
 public:
     SessionDocument (SessionPtr);
@@ -26,10 +27,33 @@ public:
 
     void changeListenerCallback (ChangeBroadcaster*) override;
 
+    /** Use already parsed session data on the next load instead of reading
+        the file. Set lists use this to open a preloaded session. */
+    void setPreloadedData (const ValueTree& data) { preloaded = data; }
+
+    /** Save as a binary session archive instead of XML. Loading detects
+        the format on its own. */
+    void setBinaryFormat (bool binary) { binaryFormat = binary; }
+
+    /** Read, migrate and validate session data from a file. */
+    static ValueTree readSessionData (const File& file, String& error);
+
+    /** Block until a save running in the background has been written. */
+    void waitForPendingSave();
+
+    /** Called on the message thread once a background save has finished. If
+        it failed the document is flagged as changed again. */
+    std::function<void (const File&, const Result&)> onSaveFinished;
+
 private:
+    class Writer;
+    std::unique_ptr<Writer> writer;
     SessionPtr session;
     File lastSession;
+    ValueTree preloaded;
+    bool binaryFormat = false;
     friend class Session;
     void onSessionChanged();
+    void handleAsyncUpdate() override;
 };
 } // namespace element
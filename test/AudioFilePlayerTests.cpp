@@ -0,0 +1,101 @@
+#include <boost/test/unit_test.hpp>
+#include "nodes/audiofileplayer.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+
+/** Write a mono WAV file holding a constant value. */
+static void writeTestFile (const File& file, double sampleRate, double seconds)
+{
+    file.deleteFile();
+    AudioBuffer<float> data (1, roundToInt (sampleRate * seconds));
+    data.clear();
+    for (int i = 0; i < data.getNumSamples(); ++i)
+        data.setSample (0, i, 0.5f);
+
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer (
+        wav.createWriterFor (file.createOutputStream().release(), sampleRate, 1, 16, {}, 0));
+    BOOST_REQUIRE (writer != nullptr);
+    BOOST_REQUIRE (writer->writeFromAudioSampleBuffer (data, 0, data.getNumSamples()));
+}
+
+/** Render a few blocks and return the last sample of the left channel. */
+static float renderBlocks (AudioFilePlayerNode& player, int numBlocks)
+{
+    AudioBuffer<float> audio (2, 256);
+    MidiBuffer midi;
+    for (int i = 0; i < numBlocks; ++i)
+        player.processBlock (audio, midi);
+    return audio.getSample (0, audio.getNumSamples() - 1);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (AudioFilePlayerTests)
+
+BOOST_AUTO_TEST_CASE (StreamModes)
+{
+    TemporaryFile temp (".wav");
+    const auto file = temp.getFile();
+    writeTestFile (file, 8000.0, 1.0);
+
+    for (auto mode : { AudioFilePlayerNode::Preload, AudioFilePlayerNode::MemoryMapped })
+    {
+        AudioFilePlayerNode player;
+        player.prepareToPlay (8000.0, 256);
+        player.setStreamMode (mode);
+        player.openFile (file);
+        BOOST_REQUIRE (player.getAudioFile() == file);
+        BOOST_REQUIRE_EQUAL ((int) player.getActiveStreamMode(), (int) mode);
+
+        // memory backed sources play from the first block, nothing to wait for.
+        player.getPlayer().start();
+        BOOST_REQUIRE_CLOSE (renderBlocks (player, 2), 0.5f, 1.0f);
+        player.releaseResources();
+    }
+}
+
+BOOST_AUTO_TEST_CASE (LongFilesStream)
+{
+    TemporaryFile temp (".wav");
+    const auto file = temp.getFile();
+    writeTestFile (file, 8000.0, AudioFilePlayerNode::maxPreloadSeconds + 1.0);
+
+    AudioFilePlayerNode player;
+    player.prepareToPlay (8000.0, 256);
+    player.setStreamMode (AudioFilePlayerNode::Preload);
+    player.openFile (file);
+    BOOST_REQUIRE (player.getAudioFile() == file);
+    BOOST_REQUIRE_EQUAL ((int) player.getStreamMode(), (int) AudioFilePlayerNode::Preload);
+    BOOST_REQUIRE_EQUAL ((int) player.getActiveStreamMode(), (int) AudioFilePlayerNode::Streaming);
+    player.releaseResources();
+}
+
+BOOST_AUTO_TEST_CASE (ModeChangeReopens)
+{
+    TemporaryFile temp (".wav");
+    const auto file = temp.getFile();
+    writeTestFile (file, 8000.0, 1.0);
+
+    AudioFilePlayerNode player;
+    player.prepareToPlay (8000.0, 256);
+    player.openFile (file);
+    BOOST_REQUIRE_EQUAL ((int) player.getActiveStreamMode(), (int) AudioFilePlayerNode::Streaming);
+    player.setStreamMode (AudioFilePlayerNode::MemoryMapped);
+    BOOST_REQUIRE_EQUAL ((int) player.getActiveStreamMode(), (int) AudioFilePlayerNode::MemoryMapped);
+
+    MemoryBlock state;
+    player.getStateInformation (state);
+    AudioFilePlayerNode restored;
+    restored.prepareToPlay (8000.0, 256);
+    restored.setStateInformation (state.getData(), (int) state.getSize());
+    BOOST_REQUIRE_EQUAL ((int) restored.getActiveStreamMode(), (int) AudioFilePlayerNode::MemoryMapped);
+
+    restored.releaseResources();
+    player.releaseResources();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
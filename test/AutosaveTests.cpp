@@ -0,0 +1,151 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/node.hpp>
+#include <element/session.hpp>
+
+#include "session/autosave.hpp"
+#include "session/statecache.hpp"
+#include "fixture/PreparedGraph.h"
+#include "fixture/TestNode.h"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+
+/** Counts how often its state is read. */
+class CountingNode : public TestNode
+{
+public:
+    explicit CountingNode (const String& s) : state (s) {}
+
+    void getState (MemoryBlock& block) override
+    {
+        ++numReads;
+        block.replaceAll (state.toRawUTF8(), state.getNumBytesAsUTF8());
+    }
+
+    void setState (const void* data, int size) override
+    {
+        state = String::fromUTF8 ((const char*) data, size);
+    }
+
+    String state;
+    int numReads = 0;
+};
+
+static void addNode (const Node& graph, Processor* object)
+{
+    ValueTree node (types::Node);
+    node.setProperty (tags::uuid, Uuid().toString(), nullptr)
+        .setProperty (tags::object, object, nullptr);
+    graph.data().getOrCreateChildWithName (tags::nodes, nullptr).addChild (node, -1, nullptr);
+}
+
+static String readState (const ValueTree& node)
+{
+    const auto state = StateCache::decode (node.getProperty (tags::state));
+    return state->toString();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (AutosaveTests)
+
+BOOST_AUTO_TEST_CASE (SaveAndRecover)
+{
+    const auto dir = File::createTempFile ("autosave");
+    const auto sessionFile = File::getSpecialLocation (File::tempDirectory).getChildFile ("recover.els");
+
+    PreparedGraph fix;
+    ProcessorPtr one = fix.graph.addNode (new CountingNode ("one"));
+    ProcessorPtr two = fix.graph.addNode (new CountingNode ("two"));
+    auto& first = dynamic_cast<CountingNode&> (*one);
+    auto& second = dynamic_cast<CountingNode&> (*two);
+
+    SessionPtr session = new Session();
+    auto graph = Node::createGraph ("Autosave");
+    addNode (graph, one.get());
+    addNode (graph, two.get());
+    session->addGraph (graph, true);
+
+    Autosave autosave (dir);
+    BOOST_REQUIRE (! Autosave::hasRecovery (dir));
+    BOOST_REQUIRE (autosave.save (*session, sessionFile));
+    autosave.waitForPendingWrites();
+    BOOST_REQUIRE (Autosave::hasRecovery (dir));
+    BOOST_REQUIRE_EQUAL (first.numReads, 1);
+    BOOST_REQUIRE_EQUAL (second.numReads, 1);
+
+    // nothing changed, nothing is read.
+    BOOST_REQUIRE (autosave.save (*session, sessionFile));
+    autosave.waitForPendingWrites();
+    BOOST_REQUIRE_EQUAL (first.numReads, 1);
+    BOOST_REQUIRE_EQUAL (second.numReads, 1);
+
+    // only the changed node is read, settings are synced regardless.
+    first.state = "changed";
+    first.markStateChanged();
+    second.setMuted (true);
+    BOOST_REQUIRE (autosave.save (*session, sessionFile));
+    autosave.waitForPendingWrites();
+    BOOST_REQUIRE_EQUAL (first.numReads, 2);
+    BOOST_REQUIRE_EQUAL (second.numReads, 1);
+    BOOST_REQUIRE_EQUAL (dir.findChildFiles (File::findFiles, false, "*.state").size(), 2);
+
+    File recoveredFile;
+    String error;
+    const auto data = Autosave::restore (recoveredFile, error, dir);
+    BOOST_REQUIRE_MESSAGE (data.isValid(), error);
+    BOOST_REQUIRE (recoveredFile == sessionFile);
+
+    const auto nodes = data.getChildWithName (tags::graphs).getChild (0).getChildWithName (tags::nodes);
+    BOOST_REQUIRE_EQUAL (nodes.getNumChildren(), 2);
+    BOOST_REQUIRE_EQUAL (readState (nodes.getChild (0)), String ("changed"));
+    BOOST_REQUIRE_EQUAL (readState (nodes.getChild (1)), String ("two"));
+    BOOST_REQUIRE (! (bool) nodes.getChild (0).getProperty (tags::mute));
+    BOOST_REQUIRE ((bool) nodes.getChild (1).getProperty (tags::mute));
+
+    // recovered data loads like a saved session.
+    SessionPtr recovered = new Session();
+    BOOST_REQUIRE (recovered->loadData (data));
+    ProcessorPtr restored = fix.graph.addNode (new CountingNode ({}));
+    auto node = recovered->getGraph (0).getNode (0);
+    node.data().setProperty (tags::object, restored.get(), nullptr);
+    node.restorePluginState();
+    BOOST_REQUIRE_EQUAL (dynamic_cast<CountingNode&> (*restored).state, String ("changed"));
+
+    autosave.clear();
+    BOOST_REQUIRE (! Autosave::hasRecovery (dir));
+    BOOST_REQUIRE (! dir.exists());
+}
+
+BOOST_AUTO_TEST_CASE (ClearForgetsStates)
+{
+    const auto dir = File::createTempFile ("autosave");
+
+    PreparedGraph fix;
+    ProcessorPtr one = fix.graph.addNode (new CountingNode ("one"));
+    auto& first = dynamic_cast<CountingNode&> (*one);
+
+    SessionPtr session = new Session();
+    auto graph = Node::createGraph ("Autosave");
+    addNode (graph, one.get());
+    session->addGraph (graph, true);
+
+    Autosave autosave (dir);
+    BOOST_REQUIRE (autosave.save (*session, {}));
+    autosave.clear();
+
+    // the state file went with the clear, so it must be written again.
+    BOOST_REQUIRE (autosave.save (*session, {}));
+    autosave.waitForPendingWrites();
+    BOOST_REQUIRE_EQUAL (first.numReads, 2);
+
+    File recoveredFile;
+    String error;
+    BOOST_REQUIRE_MESSAGE (Autosave::restore (recoveredFile, error, dir).isValid(), error);
+    autosave.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+#include <boost/test/unit_test.hpp>
+#include "lv2/bundlecache.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+
+struct TestBundle
+{
+    TestBundle()
+    {
+        dir = File::createTempFile ("lv2");
+        bundle = dir.getChildFile ("test.lv2");
+        bundle.createDirectory();
+        manifest = bundle.getChildFile ("manifest.ttl");
+        plugin = bundle.getChildFile ("plugin.ttl");
+        manifest.replaceWithText ("# manifest\n");
+        plugin.replaceWithText ("# plugin\n");
+
+        // start with every file well in the past.
+        const auto past = Time::getCurrentTime() - RelativeTime::hours (1);
+        manifest.setLastModificationTime (past);
+        plugin.setLastModificationTime (past);
+        bundle.setLastModificationTime (past);
+    }
+
+    ~TestBundle() { dir.deleteRecursively(); }
+
+    File dir, bundle, manifest, plugin;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (BundleCacheTests)
+
+BOOST_AUTO_TEST_CASE (SaveRestore)
+{
+    TemporaryFile temp (".xml");
+    {
+        BundleCache cache (temp.getFile());
+        auto& bundle = cache.reset ("/lv2/test.lv2", 1234);
+        cache.addPlugin (bundle, { "urn:test:one", "One", true });
+        cache.addPlugin (bundle, { "urn:test:two", "Two", false });
+        BOOST_REQUIRE (cache.save());
+    }
+
+    BundleCache cache (temp.getFile());
+    BOOST_REQUIRE (cache.restore());
+    auto* bundle = cache.getBundle ("/lv2/test.lv2");
+    BOOST_REQUIRE (bundle != nullptr);
+    BOOST_REQUIRE_EQUAL (bundle->modified, (int64) 1234);
+    BOOST_REQUIRE_EQUAL (bundle->plugins.size(), (size_t) 2);
+    BOOST_REQUIRE (cache.getBundleForPlugin ("urn:test:two") == bundle);
+    BOOST_REQUIRE (cache.getPlugin ("urn:test:one")->supported);
+    BOOST_REQUIRE (! cache.getPlugin ("urn:test:two")->supported);
+
+    cache.retain ({});
+    BOOST_REQUIRE (cache.getBundle ("/lv2/test.lv2") == nullptr);
+    BOOST_REQUIRE (cache.getPlugin ("urn:test:one") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE (ResetDropsPlugins)
+{
+    TemporaryFile temp (".xml");
+    BundleCache cache (temp.getFile());
+    cache.addPlugin (cache.reset ("/lv2/test.lv2", 1), { "urn:test:one", "One", true });
+    cache.reset ("/lv2/test.lv2", 2);
+    BOOST_REQUIRE (cache.getPlugin ("urn:test:one") == nullptr);
+    BOOST_REQUIRE_EQUAL (cache.getBundle ("/lv2/test.lv2")->modified, (int64) 2);
+}
+
+BOOST_AUTO_TEST_CASE (InvalidFile)
+{
+    TemporaryFile temp (".xml");
+    temp.getFile().replaceWithText ("<lv2cache version=\"0\"/>");
+    BundleCache cache (temp.getFile());
+    BOOST_REQUIRE (! cache.restore());
+}
+
+BOOST_AUTO_TEST_CASE (ModificationTime)
+{
+    TestBundle test;
+    const auto before = BundleCache::getModificationTime (test.bundle);
+
+    // editing a plugin's data file, not the manifest, must be noticed.
+    // whole seconds, some file systems don't keep milliseconds.
+    const Time later ((Time::currentTimeMillis() / 1000) * 1000);
+    test.plugin.setLastModificationTime (later);
+    const auto after = BundleCache::getModificationTime (test.bundle);
+    BOOST_REQUIRE (after > before);
+    BOOST_REQUIRE_EQUAL (after, later.toMilliseconds());
+
+    // files that aren't turtle don't matter.
+    auto binary = test.bundle.getChildFile ("plugin.so");
+    binary.replaceWithText ("");
+    binary.setLastModificationTime (later + RelativeTime::minutes (1));
+    test.bundle.setLastModificationTime (later - RelativeTime::minutes (1));
+    BOOST_REQUIRE_EQUAL (BundleCache::getModificationTime (test.bundle), later.toMilliseconds());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
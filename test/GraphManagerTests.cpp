@@ -0,0 +1,192 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/context.hpp>
+#include <element/graph.hpp>
+#include <element/nodefactory.hpp>
+#include <element/plugins.hpp>
+
+#include "engine/graphmanager.hpp"
+#include "fixture/PreparedGraph.h"
+#include "fixture/TestNode.h"
+#include "scripting/luatest.hpp"
+
+using namespace element;
+
+namespace {
+
+#define EL_TEST_FORMAT   "ThreadSafeTest"
+#define EL_TEST_STATE_ID "test.state"
+
+/** Records how and when its program and state were restored. */
+class StateNode : public TestNode
+{
+public:
+    int getNumPrograms() const override { return 4; }
+    int getCurrentProgram() const override { return program; }
+    void setCurrentProgram (int index) override { program = index; }
+
+    void setState (const void* data, int size) override
+    {
+        state = String::fromUTF8 ((const char*) data, size);
+        programWhenRestored = program;
+        suspendedWhenRestored = isSuspended();
+    }
+
+    void getPluginDescription (PluginDescription& desc) const override
+    {
+        desc.pluginFormatName = EL_TEST_FORMAT;
+        desc.fileOrIdentifier = EL_TEST_STATE_ID;
+        desc.name = "State";
+    }
+
+    std::atomic<int> program { 0 };
+    String state;
+    int programWhenRestored = -1;
+    bool suspendedWhenRestored = true;
+};
+
+class ThreadSafeProvider : public NodeProvider
+{
+public:
+    String format() const override { return EL_TEST_FORMAT; }
+    Processor* create (const String& ID) override
+    {
+        ++numCreated;
+        return ID == EL_TEST_STATE_ID ? new StateNode() : nullptr;
+    }
+    StringArray findTypes() override { return { EL_TEST_STATE_ID }; }
+    bool isThreadSafe() const override { return true; }
+
+    static std::atomic<int> numCreated;
+};
+
+std::atomic<int> ThreadSafeProvider::numCreated { 0 };
+
+static void addThreadSafeProvider (Context& context)
+{
+    auto& factory = context.plugins().getNodeFactory();
+    for (auto* provider : factory.providers())
+        if (provider->format() == EL_TEST_FORMAT)
+            return;
+    factory.add (new ThreadSafeProvider());
+}
+
+/** Counts nodes the graph model's listeners are told about. */
+struct ModelListener : public ValueTree::Listener
+{
+    explicit ModelListener (const ValueTree& t) : tree (t) { tree.addListener (this); }
+    ~ModelListener() override { tree.removeListener (this); }
+
+    void valueTreeChildAdded (ValueTree&, ValueTree& child) override
+    {
+        if (child.hasType (types::Node))
+            ++numNodes;
+        else if (child.hasType (tags::nodes))
+            ++numNodeTrees;
+    }
+
+    ValueTree tree;
+    int numNodes = 0, numNodeTrees = 0;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (GraphManagerTests)
+
+BOOST_AUTO_TEST_CASE (ConcurrentLoad)
+{
+    auto& context = *test::context();
+    addThreadSafeProvider (context);
+    ThreadSafeProvider::numCreated = 0;
+
+    const int numNodes = 6;
+    auto model = Node::createGraph ("Concurrent");
+    auto nodes = model.data().getOrCreateChildWithName (tags::nodes, nullptr);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        ValueTree node (types::Node);
+        node.setProperty (tags::id, i + 1, nullptr)
+            .setProperty (tags::format, EL_TEST_FORMAT, nullptr)
+            .setProperty (tags::identifier, EL_TEST_STATE_ID, nullptr)
+            .setProperty (tags::program, 2, nullptr)
+            .setProperty (tags::bypass, true, nullptr);
+        const String state ("state " + String (i));
+        node.setProperty (tags::state, MemoryBlock (state.toRawUTF8(), state.getNumBytesAsUTF8()).toBase64Encoding(), nullptr);
+        nodes.addChild (node, -1, nullptr);
+    }
+
+    PreparedGraph fix;
+    GraphManager manager (fix.graph, context.plugins());
+    manager.setNodeModel (model);
+
+    BOOST_REQUIRE_EQUAL ((int) ThreadSafeProvider::numCreated, numNodes);
+    BOOST_REQUIRE_EQUAL (manager.getNumNodes(), numNodes);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        auto* node = dynamic_cast<StateNode*> (manager.getNodeForId ((uint32) i + 1).get());
+        BOOST_REQUIRE (node != nullptr);
+        BOOST_REQUIRE_EQUAL (node->state, String ("state ") + String (i));
+        BOOST_REQUIRE_EQUAL ((int) node->program, 2);
+
+        // program before state, and settings after both, as when
+        // restoring serially.
+        BOOST_REQUIRE_EQUAL (node->programWhenRestored, 2);
+        BOOST_REQUIRE (! node->suspendedWhenRestored);
+        BOOST_REQUIRE (node->isSuspended());
+    }
+
+    manager.clear();
+}
+
+BOOST_AUTO_TEST_CASE (LuaBatch)
+{
+    auto& context = *test::context();
+    addThreadSafeProvider (context);
+
+    auto model = Node::createGraph ("Batch");
+    PreparedGraph fix;
+    GraphManager manager (fix.graph, context.plugins());
+    manager.setNodeModel (model);
+    fix.graph.handleUpdateNowIfNeeded();
+
+    const int numNodes = manager.getNumNodes();
+    const int numArcs = model.getArcsValueTree().getNumChildren();
+    const int rebuilds = fix.graph.getNumRebuilds();
+    ModelListener listener (model.data());
+
+    LuaFixture lua;
+    sol::state_view view (lua.luaState());
+    view.script ("require ('el.Node'); require ('el.Graph')");
+    view["graph"] = Graph (model);
+    view["base"] = numNodes;
+    view["num_nodes"] = [&manager]() { return manager.getNumNodes(); };
+    auto result = view.safe_script (R"(
+        graph:batch (function()
+            local last = nil
+            for i = 1, 8 do
+                local node = graph:addNode ('test.state', 'ThreadSafeTest')
+                assert (node ~= nil, "node not created")
+                assert (num_nodes() == base + i, "node not in the model")
+                if last then
+                    assert (graph:connect (last, 3, node, 0), "not connected")
+                end
+                last = node
+            end
+        end)
+    )", sol::script_pass_on_error);
+    BOOST_REQUIRE_MESSAGE (result.valid(), sol::error (result).what());
+
+    // one rebuild for the whole batch, the model updates per node.
+    fix.graph.handleUpdateNowIfNeeded();
+    BOOST_REQUIRE_EQUAL (fix.graph.getNumRebuilds(), rebuilds + 1);
+    BOOST_REQUIRE_EQUAL (manager.getNumNodes(), numNodes + 8);
+    BOOST_REQUIRE_EQUAL (model.getNodesValueTree().getNumChildren(), numNodes + 8);
+    BOOST_REQUIRE_EQUAL (model.getArcsValueTree().getNumChildren(), numArcs + 7);
+    BOOST_REQUIRE (model.getNodesValueTree().getParent() == model.data());
+    BOOST_REQUIRE_EQUAL (listener.numNodes, 8);
+    BOOST_REQUIRE_EQUAL (listener.numNodeTrees, 0);
+
+    manager.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,12 +3,30 @@
 #include <element/context.hpp>
 
 #include "fixture/PreparedGraph.h"
+#include "fixture/ScriptNodes.h"
 #include "fixture/TestNode.h"
 #include "engine/graphnode.hpp"
+#include "nodes/scriptnode.hpp"
 #include "utils.hpp"
 
 using namespace element;
 
+class LatentTestNode : public TestNode {
+public:
+    explicit LatentTestNode (int latency) { setLatencySamples (latency); }
+};
+
+/** Writes a note on every sample of each block. */
+class MidiFloodNode : public TestNode {
+public:
+    void render (RenderContext& rc) override
+    {
+        auto& midi = *rc.midi.getWriteBuffer (0);
+        for (int i = 0; i < rc.audio.getNumSamples(); ++i)
+            midi.addEvent (MidiMessage::noteOn (1, 60, (uint8) 100), i);
+    }
+};
+
 BOOST_AUTO_TEST_SUITE (GraphNodeTests)
 
 BOOST_AUTO_TEST_CASE (IO)
@@ -77,4 +95,132 @@ BOOST_AUTO_TEST_CASE (AddRemove)
     BOOST_REQUIRE (graph.removeNode (node->nodeId));
 }
 
+BOOST_AUTO_TEST_CASE (OversampledSubGraph)
+{
+    PreparedGraph fix (44100.0, 512);
+    ReferenceCountedObjectPtr<GraphNode> sub = new GraphNode (*element::test::context());
+    fix.graph.addNode (sub.get());
+    sub->setOversamplingFactor (4);
+    BOOST_REQUIRE_EQUAL (sub->getOversamplingFactor(), 4);
+
+    ProcessorPtr node = sub->addNode (new TestNode());
+    BOOST_REQUIRE_EQUAL (node->getSampleRate(), 44100.0 * 4);
+    BOOST_REQUIRE_EQUAL (node->getBlockSize(), 512 * 4);
+
+    sub->setOversamplingFactor (1);
+    BOOST_REQUIRE_EQUAL (node->getSampleRate(), 44100.0);
+    BOOST_REQUIRE_EQUAL (node->getBlockSize(), 512);
+
+    fix.graph.removeNode (sub->nodeId);
+}
+
+BOOST_AUTO_TEST_CASE (LatencyCompensation)
+{
+    PreparedGraph fix;
+    GraphNode& graph = fix.graph;
+    ProcessorPtr slow = graph.addNode (new LatentTestNode (100));
+    ProcessorPtr fast = graph.addNode (new TestNode());
+    ProcessorPtr sum = graph.addNode (new TestNode());
+    BOOST_REQUIRE (graph.connectChannels (PortType::Audio, slow->nodeId, 0, sum->nodeId, 0));
+    BOOST_REQUIRE (graph.connectChannels (PortType::Audio, fast->nodeId, 0, sum->nodeId, 0));
+    graph.rebuild();
+
+    int slowDelay = -1, fastDelay = -1;
+    for (const auto& lc : graph.getLatencyCompensation())
+    {
+        if (lc.destNode != sum->nodeId || ! lc.type.isAudio())
+            continue;
+        if (lc.sourceNode == slow->nodeId)
+            slowDelay = lc.delaySamples;
+        else if (lc.sourceNode == fast->nodeId)
+            fastDelay = lc.delaySamples;
+    }
+
+    BOOST_REQUIRE_EQUAL (slowDelay, 0);
+    BOOST_REQUIRE_EQUAL (fastDelay, 100);
+}
+
+BOOST_AUTO_TEST_CASE (LiveModeSkipsAlignment)
+{
+    PreparedGraph fix;
+    GraphNode& graph = fix.graph;
+    ProcessorPtr slow = graph.addNode (new LatentTestNode (100));
+    ProcessorPtr fast = graph.addNode (new TestNode());
+    ProcessorPtr sum = graph.addNode (new TestNode());
+    BOOST_REQUIRE (graph.connectChannels (PortType::Audio, slow->nodeId, 0, sum->nodeId, 0));
+    BOOST_REQUIRE (graph.connectChannels (PortType::Audio, fast->nodeId, 0, sum->nodeId, 0));
+    sum->setLiveMode (true);
+    graph.rebuild();
+
+    for (const auto& lc : graph.getLatencyCompensation())
+    {
+        if (lc.destNode != sum->nodeId || ! lc.type.isAudio())
+            continue;
+        BOOST_REQUIRE (lc.live);
+        BOOST_REQUIRE_EQUAL (lc.delaySamples, 0);
+        if (lc.sourceNode == fast->nodeId)
+            BOOST_REQUIRE_EQUAL (lc.unalignedSamples, 100);
+    }
+
+    BOOST_REQUIRE_EQUAL (graph.getLatencyWarnings().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (MidiDelayOverflow)
+{
+    PreparedGraph fix;
+    GraphNode& graph = fix.graph;
+    ProcessorPtr slow = graph.addNode (new LatentTestNode (100));
+    ProcessorPtr flood = graph.addNode (new MidiFloodNode());
+    ProcessorPtr sum = graph.addNode (new TestNode());
+    BOOST_REQUIRE (graph.connectChannels (PortType::Midi, slow->nodeId, 0, sum->nodeId, 0));
+    BOOST_REQUIRE (graph.connectChannels (PortType::Midi, flood->nodeId, 0, sum->nodeId, 0));
+    graph.rebuild();
+    BOOST_REQUIRE_EQUAL (graph.getNumDroppedMidiEvents(), 0);
+
+    AtomBuffer atoms;
+    MidiBuffer midi;
+    AudioSampleBuffer audio (2, 512), cv;
+    for (int i = 0; i < 8; ++i)
+    {
+        RenderContext rc (audio, cv, midi, atoms, audio.getNumSamples());
+        graph.render (rc);
+        midi.clear();
+    }
+
+    // more than the delay line holds is dropped rather than allocated.
+    BOOST_REQUIRE (graph.getNumDroppedMidiEvents() > 0);
+}
+
+BOOST_AUTO_TEST_CASE (Batch)
+{
+    PreparedGraph fix;
+    GraphNode& graph = fix.graph;
+    ReferenceCountedArray<ScriptNode> scripts;
+    const int rebuilds = graph.getNumRebuilds();
+    const int numNodes = graph.getNumNodes();
+
+    graph.beginBatch();
+    graph.beginBatch();
+    for (int i = 0; i < 2; ++i)
+    {
+        auto* node = scripts.add (new ScriptNode());
+        BOOST_REQUIRE (node->loadScript (test::passScript).wasOk());
+        graph.addNode (node);
+    }
+    BOOST_REQUIRE (graph.connectChannels (PortType::Audio, scripts[0]->nodeId, 0, scripts[1]->nodeId, 0));
+
+    // nothing is rebuilt until the outermost batch ends
+    graph.handleUpdateNowIfNeeded();
+    BOOST_REQUIRE_EQUAL (graph.getNumRebuilds(), rebuilds);
+    graph.endBatch();
+    BOOST_REQUIRE (graph.isBatching());
+    BOOST_REQUIRE_EQUAL (graph.getNumRebuilds(), rebuilds);
+    graph.endBatch();
+
+    BOOST_REQUIRE (! graph.isBatching());
+    BOOST_REQUIRE (! graph.isUpdatePending());
+    BOOST_REQUIRE_EQUAL (graph.getNumRebuilds(), rebuilds + 1);
+    BOOST_REQUIRE_EQUAL (graph.getNumNodes(), numNodes + 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
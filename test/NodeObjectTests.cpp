@@ -2,10 +2,68 @@
 #include "fixture/PreparedGraph.h"
 #include "fixture/TestNode.h"
 #include "engine/ionode.hpp"
+#include <element/node.hpp>
 #include <element/processor.hpp>
 
 using namespace element;
 
+namespace {
+
+/** Keeps the last state set so program changes can be checked. */
+class ProgramNode : public TestNode
+{
+public:
+    explicit ProgramNode (const String& id) : identifier (id) {}
+
+    void setState (const void* data, int size) override
+    {
+        state = String::fromUTF8 ((const char*) data, size);
+    }
+
+    void getPluginDescription (PluginDescription& desc) const override
+    {
+        TestNode::getPluginDescription (desc);
+        desc.fileOrIdentifier = identifier;
+    }
+
+    String identifier, state;
+};
+
+static void writeProgram (const File& file, const String& state)
+{
+    ValueTree data (types::Node);
+    data.setProperty (tags::state, MemoryBlock (state.toRawUTF8(), state.getNumBytesAsUTF8()).toBase64Encoding(), nullptr);
+    BOOST_REQUIRE (data.createXml()->writeTo (file));
+}
+
+static void loadProgram (ProgramNode& node, int program)
+{
+    node.setMidiProgram (program);
+    node.reloadMidiProgram();
+    MessageManager::getInstance()->runDispatchLoopUntil (20);
+}
+
+/** Points global MIDI programs at a temporary directory for one test. */
+struct TempProgramsDir
+{
+    TempProgramsDir()
+        : previous (Processor::getGlobalMidiProgramsDirectory()),
+          dir (File::createTempFile ("programs"))
+    {
+        Processor::setGlobalMidiProgramsDirectory (dir);
+    }
+
+    ~TempProgramsDir()
+    {
+        Processor::setGlobalMidiProgramsDirectory (previous);
+        dir.deleteRecursively();
+    }
+
+    const File previous, dir;
+};
+
+} // namespace
+
 BOOST_AUTO_TEST_SUITE (NodeObjectTests)
 
 BOOST_AUTO_TEST_CASE (DelayCompensation)
@@ -81,4 +139,39 @@ BOOST_AUTO_TEST_CASE (PortChannelMapping)
     graph.rebuild();
 }
 
+BOOST_AUTO_TEST_CASE (SharedGlobalPrograms)
+{
+    TempProgramsDir programs;
+
+    const auto id = "element.test.programs." + Uuid().toString();
+    ProgramNode one (id), two (id);
+    for (auto* node : { &one, &two })
+        node->setUseGlobalMidiPrograms (true);
+
+    const auto file = one.getMidiProgramFile (3);
+    BOOST_REQUIRE (file == two.getMidiProgramFile (3));
+    BOOST_REQUIRE (file.isAChildOf (programs.dir));
+    writeProgram (file, "first");
+    one.preloadMidiPrograms();
+    two.preloadMidiPrograms();
+
+    loadProgram (one, 3);
+    loadProgram (two, 3);
+    BOOST_REQUIRE_EQUAL (one.state, String ("first"));
+    BOOST_REQUIRE_EQUAL (two.state, String ("first"));
+
+    // one instance overwrites the program, the other must not see the old state.
+    writeProgram (file, "second");
+    one.clearMidiProgramCache (3);
+    loadProgram (two, 3);
+    BOOST_REQUIRE_EQUAL (two.state, String ("second"));
+
+    // deleting it from one instance leaves nothing for the other to load.
+    one.removeMidiProgram (3, true);
+    BOOST_REQUIRE (! file.existsAsFile());
+    two.state = String();
+    loadProgram (two, 3);
+    BOOST_REQUIRE (two.state.isEmpty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
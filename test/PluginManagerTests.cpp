@@ -4,9 +4,11 @@
 #include <element/plugins.hpp>
 #include <element/lv2.hpp>
 
+#include "session/pluginscancache.hpp"
 #include "utils.hpp"
 
 using namespace element;
+using namespace juce;
 
 BOOST_AUTO_TEST_SUITE (PluginManagerTests)
 
@@ -22,4 +24,71 @@ BOOST_AUTO_TEST_CASE (SupportedFormats)
         BOOST_REQUIRE_MESSAGE (manager.isAudioPluginFormatSupported (supported), supported.toStdString());
 }
 
+BOOST_AUTO_TEST_CASE (ScanCacheStamp)
+{
+    const auto dir = File::createTempFile ("bundle");
+    BOOST_REQUIRE (dir.createDirectory());
+    const auto one = dir.getChildFile ("one.so");
+    const auto two = dir.getChildFile ("sub/two.ttl");
+    BOOST_REQUIRE (one.replaceWithText ("12345"));
+    BOOST_REQUIRE (two.create());
+    BOOST_REQUIRE (two.replaceWithText ("123"));
+
+    const auto file = PluginScanCache::stamp (one.getFullPathName());
+    BOOST_REQUIRE_EQUAL (file.size, (int64) 5);
+    BOOST_REQUIRE_EQUAL (file.modified, one.getLastModificationTime().toMilliseconds());
+
+    // bundles are stamped by everything in them.
+    auto bundle = PluginScanCache::stamp (dir.getFullPathName());
+    BOOST_REQUIRE_EQUAL (bundle.size, (int64) 8);
+    BOOST_REQUIRE (bundle.modified >= file.modified);
+
+    BOOST_REQUIRE (two.replaceWithText ("1234567"));
+    BOOST_REQUIRE (! (PluginScanCache::stamp (dir.getFullPathName()) == bundle));
+
+    BOOST_REQUIRE (PluginScanCache::stamp (dir.getChildFile ("missing").getFullPathName()) == PluginScanCache::Stamp());
+    dir.deleteRecursively();
+}
+
+BOOST_AUTO_TEST_CASE (ScanCacheParse)
+{
+    PluginScanCache cache;
+    const PluginScanCache::Stamp stamp { 1234, 5678 };
+    const String path ("/plugins/odd|name.vst3");
+
+    BOOST_REQUIRE (cache.set (PluginScanCache::toString (path, stamp)));
+    BOOST_REQUIRE (cache.isUpToDate (path, stamp));
+    BOOST_REQUIRE (! cache.isUpToDate (path, { 1234, 5679 }));
+    BOOST_REQUIRE (! cache.isUpToDate ("/plugins/odd", stamp));
+
+    BOOST_REQUIRE (! cache.set (String ("1234|5678")));
+    BOOST_REQUIRE (! cache.set (String ("1234|5678|")));
+    BOOST_REQUIRE (! cache.set (String()));
+    BOOST_REQUIRE_EQUAL (cache.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (ScanCacheRestore)
+{
+    TemporaryFile temp ("xml");
+    const auto file = temp.getFile();
+
+    PluginScanCache cache;
+    cache.set ("/plugins/a.so", { 1, 2 });
+    cache.set ("/plugins/b.lv2", { int64 (1) << 40, 3 });
+    BOOST_REQUIRE (cache.save (file));
+
+    PluginScanCache restored;
+    restored.set ("/plugins/stale.so", { 9, 9 });
+    restored.restore (file);
+    BOOST_REQUIRE_EQUAL (restored.size(), 2);
+    BOOST_REQUIRE (restored.isUpToDate ("/plugins/a.so", { 1, 2 }));
+    BOOST_REQUIRE (restored.isUpToDate ("/plugins/b.lv2", { int64 (1) << 40, 3 }));
+    BOOST_REQUIRE (! restored.isUpToDate ("/plugins/stale.so", { 9, 9 }));
+
+    // a missing or unreadable file leaves the cache empty.
+    BOOST_REQUIRE (file.replaceWithText ("not xml"));
+    restored.restore (file);
+    BOOST_REQUIRE_EQUAL (restored.size(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
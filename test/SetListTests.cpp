@@ -0,0 +1,75 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/context.hpp>
+#include <element/engine.hpp>
+#include <element/services.hpp>
+#include <element/session.hpp>
+
+#include "engine/rootgraph.hpp"
+#include "services/sessionservice.hpp"
+#include "testutil.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (SetListTests)
+
+BOOST_AUTO_TEST_CASE (ReadSetList)
+{
+    TemporaryFile temp (".txt");
+    const auto list = temp.getFile();
+    list.replaceWithText ("# opener\nfirst.els\n\n  sub/second.els  \n");
+
+    const auto sessions = SessionService::readSetList (list);
+    BOOST_REQUIRE_EQUAL (sessions.size(), 2);
+    BOOST_REQUIRE (sessions[0] == list.getSiblingFile ("first.els"));
+    BOOST_REQUIRE (sessions[1] == list.getSiblingFile ("sub").getChildFile ("second.els"));
+}
+
+BOOST_AUTO_TEST_CASE (PreloadAndSwitch)
+{
+    auto& context = *test::context();
+    auto* engine = context.services().find<EngineService>();
+    BOOST_REQUIRE (engine != nullptr);
+
+    TemporaryFile temp (".els");
+    const auto file = temp.getFile();
+    {
+        SessionPtr session = new Session();
+        session->addGraph (Node::createGraph ("Preloaded"), true);
+        BOOST_REQUIRE (session->createXml()->writeTo (file));
+    }
+
+    engine->preloadSession (file);
+    const auto data = engine->getPreloadedSession (file);
+    BOOST_REQUIRE (data.isValid());
+
+    // graphs attach one per timer callback.
+    const Node preloaded (data.getChildWithName (tags::graphs).getChild (0), false);
+    RootGraph* root = nullptr;
+    const auto end = Time::getMillisecondCounter() + 5000;
+    while (root == nullptr && Time::getMillisecondCounter() < end)
+    {
+        MessageManager::getInstance()->runDispatchLoopUntil (10);
+        root = dynamic_cast<RootGraph*> (preloaded.getObject());
+    }
+    BOOST_REQUIRE (root != nullptr);
+    BOOST_REQUIRE (root->isStandby());
+
+    // switching hands over the prepared graph instead of rebuilding it.
+    auto session = context.session();
+    BOOST_REQUIRE (session->loadData (data));
+    engine->sessionReloaded();
+    BOOST_REQUIRE (session->getGraph (0).getObject() == root);
+    BOOST_REQUIRE (! root->isStandby());
+
+    engine->setSetList ({});
+    engine->clearPreloadedSessions();
+    BOOST_REQUIRE (! engine->getPreloadedSession (file).isValid());
+
+    session->clear();
+    engine->sessionReloaded();
+    MessageManager::getInstance()->runDispatchLoopUntil (300);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "lv2/workthread.hpp"
+
+using namespace element;
+using namespace juce;
+
+namespace {
+
+/** Adds up the integers it is sent. */
+class SumWorker : public WorkerBase
+{
+public:
+    explicit SumWorker (WorkerPool& pool) : WorkerBase (pool, 1024) {}
+
+    void processRequest (uint32_t size, const void* data) override
+    {
+        // runs on a pool thread, so no test macros here.
+        if (size != sizeof (int))
+            return;
+        if (block != nullptr)
+            block->wait (-1);
+        sum += *static_cast<const int*> (data);
+        ++count;
+    }
+
+    void processResponse (uint32_t, const void*) override {}
+
+    /** Schedule a value, retrying while the request queue is full. */
+    void send (int value)
+    {
+        while (! scheduleWork (sizeof (value), &value))
+            Thread::yield();
+    }
+
+    std::atomic<int64> sum { 0 };
+    std::atomic<int> count { 0 };
+    WaitableEvent* block = nullptr;
+};
+
+static bool waitForCount (const SumWorker& worker, int count, int timeoutMs = 10000)
+{
+    const auto end = Time::getMillisecondCounter() + (uint32) timeoutMs;
+    while (worker.count.load() < count)
+    {
+        if (Time::getMillisecondCounter() > end)
+            return false;
+        Thread::sleep (1);
+    }
+    return true;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (WorkerPoolTests)
+
+BOOST_AUTO_TEST_CASE (ConcurrentScheduling)
+{
+    const int numWorkers = 6, numRequests = 2000;
+    WorkerPool pool ("test", 3, 64);
+    OwnedArray<SumWorker> workers;
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add (new SumWorker (pool));
+
+    // one realtime-like producer per worker, all racing the pool threads.
+    std::vector<std::thread> producers;
+    for (auto* worker : workers)
+        producers.emplace_back ([worker]() {
+            for (int i = 1; i <= numRequests; ++i)
+                worker->send (i);
+        });
+    for (auto& producer : producers)
+        producer.join();
+
+    const int64 expected = (int64) numRequests * (numRequests + 1) / 2;
+    for (auto* worker : workers)
+    {
+        BOOST_REQUIRE (waitForCount (*worker, numRequests));
+        BOOST_REQUIRE_EQUAL (worker->sum.load(), expected);
+    }
+
+    workers.clear();
+}
+
+BOOST_AUTO_TEST_CASE (BusyHomeThread)
+{
+    WorkerPool pool ("test", 2, 64);
+    SumWorker first (pool), second (pool), third (pool);
+
+    // hold one pool thread in a long job.
+    WaitableEvent release;
+    first.block = &release;
+    first.send (1);
+    Thread::sleep (20);
+
+    // the free thread takes every request, including those queued again
+    // while it was still processing the worker.
+    for (int i = 1; i <= 500; ++i)
+    {
+        second.send (i);
+        third.send (i);
+    }
+
+    BOOST_REQUIRE (waitForCount (second, 500));
+    BOOST_REQUIRE (waitForCount (third, 500));
+    BOOST_REQUIRE_EQUAL (first.count.load(), 0);
+
+    release.signal();
+    BOOST_REQUIRE (waitForCount (first, 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
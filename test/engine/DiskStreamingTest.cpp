@@ -0,0 +1,93 @@
+#include <boost/test/unit_test.hpp>
+#include "engine/diskstreaming.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (DiskStreamingTest)
+
+BOOST_AUTO_TEST_CASE (ReadAhead)
+{
+    DiskStreamingPool pool;
+    pool.setDiskLatency (100.0);
+    const int small = pool.getReadAheadSamples (44100.0, 64);
+    BOOST_REQUIRE (small >= 4410);
+    BOOST_REQUIRE (isPowerOfTwo (small));
+    BOOST_REQUIRE (pool.getReadAheadSamples (192000.0, 64) > small);
+}
+
+BOOST_AUTO_TEST_CASE (StreamsSource)
+{
+    DiskStreamingPool pool;
+    pool.setNumThreads (2);
+
+    AudioBuffer<float> data (2, 44100);
+    for (int i = 0; i < data.getNumSamples(); ++i)
+    {
+        data.setSample (0, i, (float) i / (float) data.getNumSamples());
+        data.setSample (1, i, 0.5f);
+    }
+
+    {
+        DiskStream stream (pool, new MemoryAudioSource (data, false), true, 2);
+        stream.prepareToPlay (512, 44100.0);
+        BOOST_REQUIRE_EQUAL (pool.getNumStreams(), 1);
+
+        AudioBuffer<float> out (2, 512);
+        stream.getNextAudioBlock (AudioSourceChannelInfo (out));
+        BOOST_REQUIRE_EQUAL (stream.getNumUnderruns(), 0);
+        BOOST_REQUIRE_EQUAL (out.getSample (0, 100), data.getSample (0, 100));
+        BOOST_REQUIRE_EQUAL (out.getSample (1, 511), 0.5f);
+        BOOST_REQUIRE_EQUAL (stream.getNextReadPosition(), (int64) 512);
+
+        pool.setNumThreads (1);
+        BOOST_REQUIRE_EQUAL (pool.getNumStreams(), 1);
+        stream.releaseResources();
+    }
+
+    BOOST_REQUIRE_EQUAL (pool.getNumStreams(), 0);
+}
+
+BOOST_AUTO_TEST_CASE (ReadAheadGrowsWithStreams)
+{
+    DiskStreamingPool pool;
+    pool.setNumThreads (1);
+    pool.setDiskLatency (500.0);
+
+    AudioBuffer<float> data (1, 44100 * 4);
+    for (int i = 0; i < data.getNumSamples(); ++i)
+        data.setSample (0, i, (float) (i % 1000) / 1000.f);
+
+    {
+        DiskStream first (pool, new MemoryAudioSource (data, false), true, 1);
+        first.prepareToPlay (512, 44100.0);
+        const int single = first.getReadAheadSamples();
+        BOOST_REQUIRE_EQUAL (single, pool.getReadAheadSamples (44100.0, 512));
+
+        // a second stream on the same thread makes the first buffer more.
+        DiskStream second (pool, new MemoryAudioSource (data, false), true, 1);
+        second.prepareToPlay (512, 44100.0);
+        const int shared = pool.getReadAheadSamples (44100.0, 512);
+        BOOST_REQUIRE (shared > single);
+
+        const auto end = Time::getMillisecondCounter() + 5000;
+        while (first.getReadAheadSamples() < shared && Time::getMillisecondCounter() < end)
+            Thread::sleep (5);
+        BOOST_REQUIRE_EQUAL (first.getReadAheadSamples(), shared);
+
+        // what was read before growing is still in place.
+        AudioBuffer<float> out (1, 512);
+        first.getNextAudioBlock (AudioSourceChannelInfo (out));
+        BOOST_REQUIRE_EQUAL (first.getNumUnderruns(), 0);
+        BOOST_REQUIRE_EQUAL (out.getSample (0, 100), data.getSample (0, 100));
+
+        // and doesn't shrink when the other goes.
+        second.releaseResources();
+        Thread::sleep (50);
+        BOOST_REQUIRE_EQUAL (first.getReadAheadSamples(), shared);
+    }
+
+    BOOST_REQUIRE_EQUAL (pool.getNumStreams(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
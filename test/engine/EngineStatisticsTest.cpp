@@ -0,0 +1,87 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/audioengine.hpp>
+#include <element/context.hpp>
+
+#include "scripting/bindings.hpp"
+#include "sol/sol.hpp"
+
+using namespace element;
+using namespace juce;
+
+BOOST_AUTO_TEST_SUITE (EngineStatisticsTest)
+
+BOOST_AUTO_TEST_CASE (Counters)
+{
+    Context context (RunMode::Standalone);
+    AudioEnginePtr engine = new AudioEngine (context, RunMode::Standalone);
+    BOOST_REQUIRE_EQUAL (engine->getStatistics().callbacks, 0);
+
+    engine->prepareExternalPlayback (44100.0, 512, 2, 2);
+    AudioBuffer<float> audio (2, 512);
+    MidiBuffer midi;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        audio.clear();
+        midi.clear();
+        for (int j = 0; j <= i; ++j)
+            midi.addEvent (MidiMessage::noteOn (1, 60 + j, 0.5f), j);
+        engine->processExternalBuffers (audio, midi);
+    }
+
+    auto stats = engine->getStatistics();
+    BOOST_REQUIRE_EQUAL (stats.sampleRate, 44100.0);
+    BOOST_REQUIRE_EQUAL (stats.bufferSize, 512);
+    BOOST_REQUIRE_EQUAL (stats.lastBlockSize, 512);
+    BOOST_REQUIRE_EQUAL (stats.callbacks, 3);
+    BOOST_REQUIRE_EQUAL (stats.midiInputEvents, 3);
+    BOOST_REQUIRE_EQUAL (stats.peakMidiInputEvents, 3);
+    BOOST_REQUIRE (stats.peakCpuLoad >= stats.cpuLoad);
+
+    engine->resetStatistics();
+    stats = engine->getStatistics();
+    BOOST_REQUIRE_EQUAL (stats.callbacks, 0);
+    BOOST_REQUIRE_EQUAL (stats.peakMidiInputEvents, 0);
+    BOOST_REQUIRE_EQUAL (stats.peakCpuLoad, 0.f);
+    BOOST_REQUIRE_EQUAL (stats.midiInputEvents, 3);
+
+    engine->releaseExternalResources();
+}
+
+BOOST_AUTO_TEST_CASE (LuaModule)
+{
+    Context context (RunMode::Standalone);
+    sol::state lua;
+    sol::state_view view (lua.lua_state());
+    Lua::initializeState (view, context);
+
+    context.setEngine (nullptr);
+    BOOST_REQUIRE (! lua.script ("return require ('el.stats').available()").get<bool>());
+
+    AudioEnginePtr engine = new AudioEngine (context, RunMode::Standalone);
+    context.setEngine (engine);
+    engine->prepareExternalPlayback (44100.0, 256, 2, 2);
+    AudioBuffer<float> audio (2, 256);
+    MidiBuffer midi;
+    engine->processExternalBuffers (audio, midi);
+
+    auto result = lua.safe_script (R"(
+        local stats = require ('el.stats')
+        local s = stats.snapshot()
+        assert (s.callbacks == 1)
+        assert (s.bufferSize == 256 and s.lastBlockSize == 256)
+        assert (stats.snapshot (s) == s)
+        assert (#stats.nodes() == 0)
+        stats.reset()
+        return stats.snapshot().callbacks
+    )");
+
+    BOOST_REQUIRE (result.valid());
+    BOOST_REQUIRE_EQUAL (result.get<int>(), 0);
+
+    engine->releaseExternalResources();
+    context.setEngine (nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
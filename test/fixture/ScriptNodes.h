@@ -0,0 +1,15 @@
+#pragma once
+
+namespace element {
+namespace test {
+
+/** A DSP script with one audio input and output that leaves audio as is. */
+static const char* const passScript = R"(
+local S = {}
+function S.layout() return { audio = { 1, 1 }, midi = { 0, 0 } } end
+function S.process (a) end
+return S
+)";
+
+} // namespace test
+} // namespace element
@@ -0,0 +1,156 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <cstring>
+
+#include <boost/test/unit_test.hpp>
+
+#include "scripting/bytecode.hpp"
+#include "scripting/scriptloader.hpp"
+
+using namespace element;
+
+namespace {
+
+/** Points the disk cache at a temporary directory for one test. */
+struct TempCache
+{
+    TempCache()
+        : previous (LuaBytecode::getCacheDirectory()),
+          dir (juce::File::createTempFile ("bytecode"))
+    {
+        LuaBytecode::setCacheDirectory (dir);
+        LuaBytecode::clear();
+    }
+
+    ~TempCache()
+    {
+        LuaBytecode::setCacheDirectory (previous);
+        LuaBytecode::clear();
+        dir.deleteRecursively();
+    }
+
+    int getNumFiles() const { return dir.getNumberOfChildFiles (juce::File::findFiles, "*.luac"); }
+
+    const juce::File previous, dir;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (BytecodeTest)
+
+BOOST_AUTO_TEST_CASE (MemoryCache)
+{
+    TempCache cache;
+    sol::state lua;
+    lua.open_libraries (sol::lib::base);
+    const char* code = "return 40 + 2";
+
+    for (int i = 0; i < 2; ++i)
+    {
+        BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, code, std::strlen (code), "=test"), LUA_OK);
+        lua_call (lua, 0, 1);
+        BOOST_REQUIRE_EQUAL (lua_tointeger (lua, -1), 42);
+        lua_pop (lua, 1);
+        BOOST_REQUIRE_EQUAL (LuaBytecode::getNumEntries(), 1);
+    }
+
+    BOOST_REQUIRE (LuaBytecode::load (lua, "return +", 8, "=bad") != LUA_OK);
+    BOOST_REQUIRE (lua_isstring (lua, -1));
+    BOOST_REQUIRE_EQUAL (LuaBytecode::getNumEntries(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (DiskCache)
+{
+    TempCache cache;
+    sol::state lua;
+    lua.open_libraries (sol::lib::base);
+    const char* code = "return 'cached'";
+
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, code, std::strlen (code), "=disk"), LUA_OK);
+    lua_pop (lua, 1);
+    BOOST_REQUIRE_EQUAL (cache.getNumFiles(), 1);
+
+    // a fresh process only has the file
+    LuaBytecode::clear();
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, code, std::strlen (code), "=disk"), LUA_OK);
+    lua_call (lua, 0, 1);
+    BOOST_REQUIRE_EQUAL (std::string (lua_tostring (lua, -1)), "cached");
+    lua_pop (lua, 1);
+
+    // damaged files fall back to the source
+    for (const auto& file : cache.dir.findChildFiles (juce::File::findFiles, false, "*.luac"))
+        BOOST_REQUIRE (file.replaceWithText ("ELBC garbage"));
+    LuaBytecode::clear();
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, code, std::strlen (code), "=disk"), LUA_OK);
+    lua_call (lua, 0, 1);
+    BOOST_REQUIRE_EQUAL (std::string (lua_tostring (lua, -1)), "cached");
+    lua_pop (lua, 1);
+}
+
+BOOST_AUTO_TEST_CASE (HashCollision)
+{
+    TempCache cache;
+    sol::state lua;
+    lua.open_libraries (sol::lib::base);
+    const char* first = "return 'aaa'";
+    const char* second = "return 'bbb'";
+
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, first, std::strlen (first), "=collide"), LUA_OK);
+    const auto firstFile = cache.dir.findChildFiles (juce::File::findFiles, false, "*.luac")[0];
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, second, std::strlen (second), "=collide"), LUA_OK);
+    lua_pop (lua, 2);
+    BOOST_REQUIRE_EQUAL (cache.getNumFiles(), 2);
+
+    juce::File secondFile;
+    for (const auto& file : cache.dir.findChildFiles (juce::File::findFiles, false, "*.luac"))
+        if (file != firstFile)
+            secondFile = file;
+
+    // the first chunk's code under the second's name, hash and size, as if
+    // the two had collided.
+    juce::MemoryBlock firstData, secondData;
+    BOOST_REQUIRE (firstFile.loadFileAsData (firstData));
+    BOOST_REQUIRE (secondFile.loadFileAsData (secondData));
+    firstData.copyFrom (static_cast<const char*> (secondData.getData()) + 8, 8, 8);
+    BOOST_REQUIRE (secondFile.replaceWithData (firstData.getData(), firstData.getSize()));
+
+    LuaBytecode::clear();
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, second, std::strlen (second), "=collide"), LUA_OK);
+    lua_call (lua, 0, 1);
+    BOOST_REQUIRE_EQUAL (std::string (lua_tostring (lua, -1)), "bbb");
+    lua_pop (lua, 1);
+}
+
+BOOST_AUTO_TEST_CASE (NoFilesNextToScripts)
+{
+    TempCache cache;
+    sol::state lua;
+    lua.open_libraries (sol::lib::base);
+
+    const auto scripts = cache.dir.getChildFile ("scripts");
+    BOOST_REQUIRE (scripts.createDirectory());
+    const auto script = scripts.getChildFile ("script.lua");
+    BOOST_REQUIRE (script.replaceWithText ("return { name = 'File' }"));
+    {
+        ScriptLoader loader (lua.lua_state(), script);
+        BOOST_REQUIRE (loader.isReady());
+    }
+
+    BOOST_REQUIRE_EQUAL (scripts.getNumberOfChildFiles (juce::File::findFiles, "*.luac"), 0);
+    BOOST_REQUIRE_EQUAL (cache.getNumFiles(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (DisabledCache)
+{
+    TempCache cache;
+    LuaBytecode::setCacheDirectory ({});
+    sol::state lua;
+    lua.open_libraries (sol::lib::base);
+    const char* code = "return 1";
+    BOOST_REQUIRE_EQUAL (LuaBytecode::load (lua, code, std::strlen (code), "=off"), LUA_OK);
+    lua_pop (lua, 1);
+    BOOST_REQUIRE (! cache.dir.exists());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
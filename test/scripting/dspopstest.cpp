@@ -0,0 +1,37 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include "luatest.hpp"
+#include "testutil.hpp"
+
+using namespace element;
+
+BOOST_AUTO_TEST_SUITE (DSPOpsTest)
+
+BOOST_AUTO_TEST_CASE (Basics)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+    auto script = fix.readSnippet ("test_dsp_ops.lua");
+    BOOST_REQUIRE (! script.isEmpty());
+    try {
+        lua.safe_script (script.toRawUTF8(), "[test:dspops]");
+    } catch (const std::exception& e) {
+        BOOST_REQUIRE_MESSAGE (false, e.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE (BadArguments)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+    auto result = lua.safe_script (R"(
+        local dsp = require ('el.dsp')
+        dsp.biquad():process ({})
+    )", sol::script_pass_on_error);
+    BOOST_REQUIRE (! result.valid());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -80,4 +80,80 @@ BOOST_AUTO_TEST_CASE (Basics)
     expect (Amp.get_or ("released", false) == true);
 }
 
+BOOST_AUTO_TEST_CASE (OverBudget)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+
+    ScriptLoader loader (lua);
+    loader.load (R"(
+        local S = {}
+        function S.process (a)
+            while true do end
+        end
+        return S
+    )");
+    BOOST_REQUIRE (! loader.hasError());
+
+    sol::table S = loader.call();
+    DSPScript dsp (S);
+    BOOST_REQUIRE (dsp.isValid());
+    dsp.setBudget (100000, 0.0);
+    dsp.prepare (44100, 512);
+
+    AudioSampleBuffer audio (2, 512);
+    audio.clear();
+    MidiPipe midi;
+    dsp.process (audio, midi);
+
+    BOOST_REQUIRE (dsp.getFailure() == DSPScript::Failure::overBudget);
+    BOOST_REQUIRE (! dsp.isValid());
+
+    // the script is bypassed from now on.
+    dsp.process (audio, midi);
+    BOOST_REQUIRE (dsp.getFailure() == DSPScript::Failure::overBudget);
+}
+
+BOOST_AUTO_TEST_CASE (SlowBlocks)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+
+    ScriptLoader loader (lua);
+    loader.load (R"(
+        local S = {}
+        function S.process (a)
+            local x = 0
+            for i = 1, 20000 do x = x + i end
+        end
+        return S
+    )");
+    BOOST_REQUIRE (! loader.hasError());
+
+    sol::table S = loader.call();
+    DSPScript dsp (S);
+    BOOST_REQUIRE (dsp.isValid());
+
+    // no instruction limit and a time limit every block goes over.
+    dsp.setBudget (0, 1.0e-9);
+    dsp.prepare (44100, 512);
+
+    AudioSampleBuffer audio (2, 512);
+    audio.clear();
+    MidiPipe midi;
+
+    // a few slow blocks are tolerated...
+    for (int i = 1; i < DSPScript::maxConsecutiveOverruns; ++i)
+    {
+        dsp.process (audio, midi);
+        BOOST_REQUIRE (dsp.getFailure() == DSPScript::Failure::none);
+        BOOST_REQUIRE (dsp.isValid());
+    }
+
+    // ...but not one after another indefinitely.
+    dsp.process (audio, midi);
+    BOOST_REQUIRE (dsp.getFailure() == DSPScript::Failure::overBudget);
+    BOOST_REQUIRE (! dsp.isValid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include "scripting/luaarena.hpp"
+
+using namespace element;
+
+BOOST_AUTO_TEST_SUITE (LuaArenaTest)
+
+BOOST_AUTO_TEST_CASE (Basics)
+{
+    LuaArena arena;
+    {
+        sol::state lua (sol::default_at_panic, LuaArena::allocate, &arena);
+        BOOST_REQUIRE (LuaArena::fromState (lua) == &arena);
+        lua.open_libraries (sol::lib::base, sol::lib::string, sol::lib::table);
+
+        auto result = lua.safe_script (R"(
+            local t = {}
+            for i = 1, 1000 do
+                t[i] = string.rep ('x', i)
+            end
+            return #t
+        )");
+        BOOST_REQUIRE (result.valid());
+        BOOST_REQUIRE_EQUAL ((int) result, 1000);
+        BOOST_REQUIRE (arena.getNumBytesUsed() > 0);
+    }
+
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesUsed(), (size_t) 0);
+    BOOST_REQUIRE_EQUAL (arena.getNumFailures(), 0);
+}
+
+BOOST_AUTO_TEST_CASE (RealtimeExhaustion)
+{
+    LuaArena arena;
+    {
+        sol::state lua (sol::default_at_panic, LuaArena::allocate, &arena);
+        lua.open_libraries (sol::lib::base);
+        lua.stop_gc();
+
+        lua_State* L = lua;
+        BOOST_REQUIRE_EQUAL (luaL_loadstring (L, "local t = {} for i = 1, 10000000 do t[i] = i end"), LUA_OK);
+
+        int status = LUA_OK;
+        {
+            LuaArena::ScopedRealtime realtime (&arena);
+            status = lua_pcall (L, 0, 0, 0);
+        }
+
+        BOOST_REQUIRE_EQUAL (status, LUA_ERRMEM);
+        BOOST_REQUIRE (arena.getNumFailures() > 0);
+        lua_pop (L, 1);
+
+        // the state is still usable after the failure.
+        lua.collect_garbage();
+        auto result = lua.safe_script ("return 1 + 1");
+        BOOST_REQUIRE (result.valid());
+    }
+
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesUsed(), (size_t) 0);
+}
+
+BOOST_AUTO_TEST_CASE (DeferredLargeFree)
+{
+    LuaArena arena;
+    const size_t size = LuaArena::defaultPoolSize * 2;
+    void* block = LuaArena::allocate (&arena, nullptr, 0, size);
+    BOOST_REQUIRE (block != nullptr);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesUsed(), size);
+
+    // not given back to the system on the audio thread.
+    {
+        LuaArena::ScopedRealtime realtime (&arena);
+        BOOST_REQUIRE (LuaArena::allocate (&arena, block, size, 0) == nullptr);
+    }
+
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesUsed(), (size_t) 0);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesDeferred(), size);
+
+    arena.reserve (0);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesDeferred(), (size_t) 0);
+}
+
+BOOST_AUTO_TEST_CASE (KeptLargeShrink)
+{
+    LuaArena arena (256);
+    const size_t size = LuaArena::defaultPoolSize * 2;
+    void* block = LuaArena::allocate (&arena, nullptr, 0, size);
+    BOOST_REQUIRE (block != nullptr);
+
+    // the pool can't serve the smaller size, so the large block is kept.
+    LuaArena::ScopedRealtime realtime (&arena);
+    BOOST_REQUIRE (LuaArena::allocate (&arena, block, size, 1024) == block);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesUsed(), (size_t) 1024);
+
+    // freed like a large block, not onto a free list.
+    BOOST_REQUIRE (LuaArena::allocate (&arena, block, 1024, 0) == nullptr);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesUsed(), (size_t) 0);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesDeferred(), (size_t) 1024);
+
+    // and blocks from the pool still go to their free lists.
+    void* small = LuaArena::allocate (&arena, nullptr, 0, 64);
+    BOOST_REQUIRE (small != nullptr);
+    BOOST_REQUIRE (LuaArena::allocate (&arena, small, 64, 0) == nullptr);
+    BOOST_REQUIRE_EQUAL (arena.getNumBytesDeferred(), (size_t) 1024);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,64 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include <element/script.hpp>
+
+#include "scripting/bytecode.hpp"
+#include "scripting/luastatepool.hpp"
+
+using namespace element;
+
+BOOST_AUTO_TEST_SUITE (LuaStatePoolTest)
+
+BOOST_AUTO_TEST_CASE (ReuseAndReset)
+{
+    juce::SharedResourcePointer<LuaStatePool> pool;
+    lua_State* first = nullptr;
+    {
+        auto lua = LuaStatePool::acquire();
+        first = lua;
+        auto view = lua.view();
+        BOOST_REQUIRE (view["package"]["loaded"]["el.midi"].valid());
+        auto result = view.safe_script (R"(
+            leaked = true
+            package.loaded['some.module'] = {}
+            setmetatable (_G, { __index = function() return 1 end })
+        )");
+        BOOST_REQUIRE (result.valid());
+    }
+
+    BOOST_REQUIRE_EQUAL (pool->getNumIdle(), 1);
+
+    auto lua = LuaStatePool::acquire();
+    BOOST_REQUIRE (lua.get() == first);
+    BOOST_REQUIRE_EQUAL (pool->getNumIdle(), 0);
+
+    auto view = lua.view();
+    BOOST_REQUIRE (! view["leaked"].valid());
+    BOOST_REQUIRE (! view["package"]["loaded"]["some.module"].valid());
+    BOOST_REQUIRE (view["package"]["loaded"]["el.midi"].valid());
+    BOOST_REQUIRE (view["print"].get_type() == sol::type::function);
+}
+
+BOOST_AUTO_TEST_CASE (ReadInfo)
+{
+    const juce::String code = R"(
+        return {
+            type = 'DSP',
+            name = 'Pooled',
+            author = 'Element'
+        }
+    )";
+
+    LuaBytecode::clear();
+    for (int i = 0; i < 3; ++i)
+    {
+        auto info = ScriptInfo::read (code);
+        BOOST_REQUIRE_EQUAL (info.name.toStdString(), "Pooled");
+        BOOST_REQUIRE_EQUAL (info.type.toStdString(), "DSP");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
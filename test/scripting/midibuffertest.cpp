@@ -0,0 +1,101 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include "luatest.hpp"
+
+using namespace element;
+
+BOOST_AUTO_TEST_SUITE (MidiBufferTest)
+
+BOOST_AUTO_TEST_CASE (RawEvents)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+    auto result = lua.safe_script (R"(
+        local MidiBuffer = require ('el.MidiBuffer')
+        local buf = MidiBuffer.new()
+        buf:insertRaw (0x90, 60, 100, 1)
+        buf:insertRaw (0x80, 60, 0, 11)
+        buf:insertRaw (0xb0, 7, 64, 21)
+
+        local function sum()
+            local total = 0
+            for status, d1, d2, frame in buf:raw() do
+                total = total + status + d1 + d2 + frame
+            end
+            return total
+        end
+
+        assert (buf:size() == 3)
+        local expected = (0x90 + 60 + 100 + 1) + (0x80 + 60 + 0 + 11) + (0xb0 + 7 + 64 + 21)
+        assert (sum() == expected)
+
+        -- the iterator is reused, so reading events must not allocate
+        collectgarbage ('stop')
+        local before = collectgarbage ('count')
+        for _ = 1, 100 do sum() end
+        assert (collectgarbage ('count') == before, "raw() allocated")
+        collectgarbage ('restart')
+    )", sol::script_pass_on_error);
+    BOOST_REQUIRE_MESSAGE (result.valid(), sol::error (result).what());
+}
+
+BOOST_AUTO_TEST_CASE (Filter)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+    auto result = lua.safe_script (R"(
+        local MidiBuffer = require ('el.MidiBuffer')
+        local buf = MidiBuffer.new()
+        buf:insertRaw (0x90, 60, 100, 1)
+        buf:insertRaw (0xb0, 7, 64, 5)
+        buf:insertRaw (0x80, 60, 0, 11)
+
+        -- drop controllers, transpose notes, keep the rest
+        buf:filter (function (status, d1, d2)
+            local kind = status & 0xf0
+            if kind == 0xb0 then return false end
+            if kind == 0x90 then return status, d1 + 12 end
+            return true
+        end)
+
+        assert (buf:size() == 2)
+        local notes = {}
+        for status, d1, d2, frame in buf:raw() do
+            notes[#notes + 1] = { status, d1, d2, frame }
+        end
+        assert (notes[1][1] == 0x90 and notes[1][2] == 72 and notes[1][3] == 100 and notes[1][4] == 1)
+        assert (notes[2][1] == 0x80 and notes[2][2] == 60 and notes[2][4] == 11)
+    )", sol::script_pass_on_error);
+    BOOST_REQUIRE_MESSAGE (result.valid(), sol::error (result).what());
+}
+
+BOOST_AUTO_TEST_CASE (InsertRawChecksArguments)
+{
+    LuaFixture fix;
+    sol::state_view lua (fix.luaState());
+    auto result = lua.safe_script (R"(
+        local MidiBuffer = require ('el.MidiBuffer')
+        local buf = MidiBuffer.new()
+        local function fails (...)
+            return not pcall (buf.insertRaw, buf, ...)
+        end
+
+        assert (fails (0x90, 60, 100, 0), "frame 0 accepted")
+        assert (fails (0x90, 60, 100, -5), "negative frame accepted")
+        assert (fails (0x90, 60, 100, 1 << 40), "huge frame accepted")
+        assert (fails (0x90, 60, 100, 1.5), "fractional frame accepted")
+        assert (fails (0x40, 60, 100, 1), "data byte as status accepted")
+        assert (fails (0x90, 200, 100, 1), "bad data byte accepted")
+        assert (fails (0x90, 60, 100), "missing frame accepted")
+        assert (buf:size() == 0)
+
+        buf:insertRaw (0x90, 60, 100, 1)
+        assert (buf:size() == 1)
+    )", sol::script_pass_on_error);
+    BOOST_REQUIRE_MESSAGE (result.valid(), sol::error (result).what());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
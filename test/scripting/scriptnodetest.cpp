@@ -0,0 +1,83 @@
+// Copyright 2023 Kushview, LLC <info@kushview.net>
+// SPDX-License-Identifier: GPL3-or-later
+
+#include <boost/test/unit_test.hpp>
+
+#include "nodes/scriptnode.hpp"
+#include "fixture/ScriptNodes.h"
+#include "testutil.hpp"
+
+using namespace element;
+
+namespace {
+
+const char* muteScript = R"(
+local S = {}
+function S.layout() return { audio = { 1, 1 }, midi = { 0, 0 } } end
+function S.process (a) a:clear() end
+return S
+)";
+
+struct Block
+{
+    Block() : audio (1, 64) {}
+
+    float render (ScriptNode& node)
+    {
+        for (int i = 0; i < audio.getNumSamples(); ++i)
+            audio.setSample (0, i, 1.f);
+        RenderContext rc (audio.getArrayOfWritePointers(), 1, audio.getArrayOfWritePointers(), 0, midi, midiIndexes, audio.getNumSamples());
+        node.render (rc);
+        return audio.getSample (0, audio.getNumSamples() - 1);
+    }
+
+    AudioSampleBuffer audio;
+    OwnedArray<MidiBuffer> midi;
+    Array<int> midiIndexes;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE (ScriptNodeTest)
+
+BOOST_AUTO_TEST_CASE (HotSwap)
+{
+    ScriptNode::Ptr node = new ScriptNode();
+    node->setCrossfadeTime (0.0);
+    node->prepareToRender (44100.0, 64);
+
+    Block block;
+    BOOST_REQUIRE (node->loadScript (test::passScript).wasOk());
+    BOOST_REQUIRE (block.render (*node) == 1.f);
+    BOOST_REQUIRE (node->loadScript (muteScript).wasOk());
+    BOOST_REQUIRE (block.render (*node) == 0.f);
+
+    // a script that doesn't compile leaves the running one alone.
+    BOOST_REQUIRE (node->loadScript ("return {").failed());
+    BOOST_REQUIRE (block.render (*node) == 0.f);
+
+    node->releaseResources();
+}
+
+BOOST_AUTO_TEST_CASE (Crossfade)
+{
+    ScriptNode::Ptr node = new ScriptNode();
+    node->setCrossfadeTime (128.0 / 44100.0);
+    node->prepareToRender (44100.0, 64);
+
+    Block block;
+    BOOST_REQUIRE (node->loadScript (test::passScript).wasOk());
+    BOOST_REQUIRE (block.render (*node) == 1.f);
+
+    // same ports, so the old script fades out over two blocks.
+    BOOST_REQUIRE (node->loadScript (muteScript).wasOk());
+    const auto first = block.render (*node);
+    const auto second = block.render (*node);
+    BOOST_REQUIRE (first > 0.f && first < 1.f);
+    BOOST_REQUIRE (second >= 0.f && second < first);
+    BOOST_REQUIRE (block.render (*node) == 0.f);
+
+    node->releaseResources();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,178 @@
+#include <boost/test/unit_test.hpp>
+
+#include <element/session.hpp>
+#include "session/sessionarchive.hpp"
+#include "session/statecache.hpp"
+
+using namespace juce;
+using namespace element;
+
+BOOST_AUTO_TEST_SUITE (SessionArchiveTests)
+
+static ValueTree createSessionData (int numGraphs)
+{
+    ValueTree data (types::Session);
+    data.setProperty (tags::version, EL_SESSION_VERSION, nullptr);
+    data.setProperty (tags::name, "Archive", nullptr);
+    auto graphs = data.getOrCreateChildWithName (tags::graphs, nullptr);
+    graphs.setProperty (tags::active, 0, nullptr);
+
+    Random rand (1234);
+    for (int g = 0; g < numGraphs; ++g)
+    {
+        auto graph = Node::createGraph (String ("Graph ") + String (g)).data();
+        auto nodes = graph.getOrCreateChildWithName (tags::nodes, nullptr);
+        for (int n = 0; n < 3; ++n)
+        {
+            ValueTree node (types::Node);
+            node.setProperty (tags::name, String ("Node ") + String (n), nullptr);
+
+            MemoryBlock state;
+            state.setSize ((size_t) (n == 0 ? 16 : 8192));
+            for (size_t i = 0; i < state.getSize(); ++i)
+                state[i] = (char) rand.nextInt (256);
+            node.setProperty (tags::state, state.toBase64Encoding(), nullptr);
+            nodes.addChild (node, -1, nullptr);
+        }
+
+        graphs.addChild (graph, -1, nullptr);
+    }
+
+    return data;
+}
+
+BOOST_AUTO_TEST_CASE (RoundTrip)
+{
+    const auto data = createSessionData (3);
+    TemporaryFile tempFile (".els");
+    const auto& file = tempFile.getFile();
+
+    String error;
+    BOOST_REQUIRE (SessionArchive::write (data, file, error));
+    BOOST_REQUIRE (error.isEmpty());
+    BOOST_REQUIRE (SessionArchive::isArchive (file));
+
+    const auto result = SessionArchive::read (file, error);
+    BOOST_REQUIRE_MESSAGE (error.isEmpty(), error.toStdString());
+    BOOST_REQUIRE (result.isEquivalentTo (data));
+
+    // states read from an archive can be written again as they are.
+    TemporaryFile again (".els");
+    BOOST_REQUIRE (SessionArchive::write (SessionArchive::read (file, error), again.getFile(), error));
+    const auto rewritten = SessionArchive::read (again.getFile(), error);
+    BOOST_REQUIRE (rewritten.isEquivalentTo (data));
+}
+
+BOOST_AUTO_TEST_CASE (IdenticalStatesStoredOnce)
+{
+    Random rand (4321);
+    MemoryBlock state;
+    state.setSize (64 * 1024);
+    for (size_t i = 0; i < state.getSize(); ++i)
+        state[i] = (char) rand.nextInt (256);
+    const auto encoded = state.toBase64Encoding();
+
+    auto data = createSessionData (2);
+    for (int g = 0; g < 2; ++g)
+    {
+        auto nodes = data.getChildWithName (tags::graphs).getChild (g).getChildWithName (tags::nodes);
+        for (int n = 0; n < 8; ++n)
+        {
+            ValueTree node (types::Node);
+            node.setProperty (tags::state, encoded, nullptr);
+            nodes.addChild (node, -1, nullptr);
+        }
+    }
+
+    TemporaryFile tempFile (".els");
+    const auto& file = tempFile.getFile();
+
+    String error;
+    BOOST_REQUIRE (SessionArchive::write (data, file, error));
+    BOOST_REQUIRE (file.getSize() < (int64) state.getSize() * 2);
+
+    const auto result = SessionArchive::read (file, error);
+    BOOST_REQUIRE_MESSAGE (error.isEmpty(), error.toStdString());
+    BOOST_REQUIRE (result.isEquivalentTo (data));
+
+    // every node restoring the state shares one copy of it.
+    const auto first = result.getChildWithName (tags::graphs).getChild (0).getChildWithName (tags::nodes).getChild (3);
+    const auto last = result.getChildWithName (tags::graphs).getChild (1).getChildWithName (tags::nodes).getChild (10);
+    const auto text = first.getProperty (tags::state).toString();
+    BOOST_REQUIRE (text.getCharPointer() == last.getProperty (tags::state).toString().getCharPointer());
+    const auto decoded = StateCache::decode (first.getProperty (tags::state));
+    BOOST_REQUIRE (decoded == StateCache::decode (last.getProperty (tags::state)));
+    BOOST_REQUIRE (*decoded == state);
+}
+
+BOOST_AUTO_TEST_CASE (Damaged)
+{
+    TemporaryFile tempFile (".els");
+    const auto& file = tempFile.getFile();
+    String error;
+    BOOST_REQUIRE (SessionArchive::write (createSessionData (1), file, error));
+
+    int64 tocOffset = 0;
+    {
+        FileInputStream in (file);
+        BOOST_REQUIRE (in.setPosition (4 + 4 + 4));
+        tocOffset = in.readInt64();
+    }
+
+    // a chunk claiming far more data than its compressed size could hold.
+    {
+        FileOutputStream out (file);
+        BOOST_REQUIRE (out.setPosition (tocOffset + 4 + 4 + 8 + 8));
+        out.writeInt64 ((int64) 1 << 40);
+    }
+
+    BOOST_REQUIRE (! SessionArchive::read (file, error).isValid());
+    BOOST_REQUIRE_EQUAL (error, String ("Session archive is damaged"));
+
+    // a chunk count that would overflow 32 bit math.
+    {
+        FileOutputStream out (file);
+        BOOST_REQUIRE (out.setPosition (4 + 4));
+        out.writeInt (std::numeric_limits<int>::max());
+    }
+
+    BOOST_REQUIRE (! SessionArchive::read (file, error).isValid());
+    BOOST_REQUIRE_EQUAL (error, String ("Session archive is damaged"));
+}
+
+BOOST_AUTO_TEST_CASE (Version)
+{
+    TemporaryFile tempFile (".els");
+    const auto& file = tempFile.getFile();
+    String error;
+    BOOST_REQUIRE (SessionArchive::write (createSessionData (1), file, error));
+
+    {
+        FileInputStream in (file);
+        BOOST_REQUIRE (in.setPosition (4));
+        BOOST_REQUIRE_EQUAL (in.readInt(), 1);
+    }
+
+    {
+        FileOutputStream out (file);
+        BOOST_REQUIRE (out.setPosition (4));
+        out.writeInt (2);
+    }
+
+    BOOST_REQUIRE (! SessionArchive::read (file, error).isValid());
+    BOOST_REQUIRE_EQUAL (error, String ("Session archive was written by a newer version"));
+}
+
+BOOST_AUTO_TEST_CASE (NotAnArchive)
+{
+    TemporaryFile tempFile (".els");
+    const auto& file = tempFile.getFile();
+    BOOST_REQUIRE (file.replaceWithText ("<session />"));
+    BOOST_REQUIRE (! SessionArchive::isArchive (file));
+
+    String error;
+    BOOST_REQUIRE (! SessionArchive::read (file, error).isValid());
+    BOOST_REQUIRE (error.isNotEmpty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,75 @@
+local AudioBuffer = require ('el.AudioBuffer')
+local Vector = require ('el.Vector')
+local dsp = require ('el.dsp')
+
+local function near (a, b) return math.abs (a - b) < 1.0e-5 end
+
+-- vectors
+local v = Vector.new (8)
+BOOST_REQUIRE (#v == 8 and v:size() == 8)
+BOOST_REQUIRE (v[1] == 0.0 and v[9] == nil)
+v:fill (0.5)
+local w = Vector.new (8)
+for i = 1, #w do w[i] = i end
+v:add (w)
+BOOST_REQUIRE (near (v[3], 3.5))
+v:multiply (2)
+BOOST_REQUIRE (near (v[3], 7.0))
+v:copy (w, 0.5)
+BOOST_REQUIRE (near (v[8], 4.0))
+v:mix (w, 1.0)
+BOOST_REQUIRE (near (v[8], 8.0))
+BOOST_REQUIRE (near (v:peak(), 8.0))
+
+-- buffers
+local a = AudioBuffer.new (2, 8)
+local b = AudioBuffer.new (2, 8)
+a:clear()
+b:clear()
+w:write (b, 2)
+a:add (b, 0.5)
+BOOST_REQUIRE (near (a:get (2, 4), 2.0) and a:get (1, 4) == 0.0)
+a:copy (1, b, 2)
+BOOST_REQUIRE (near (a:get (1, 4), 4.0))
+a:multiply (1, b, 2)
+BOOST_REQUIRE (near (a:get (1, 4), 16.0))
+a:mix (b, 0.0)
+BOOST_REQUIRE (near (a:get (1, 4), 16.0))
+v:read (a, 1)
+BOOST_REQUIRE (near (v[4], 16.0))
+
+-- delay by three samples
+local d = dsp.delay (16)
+d:set (3)
+local impulse = Vector.new (8)
+impulse[1] = 1.0
+d:process (impulse)
+BOOST_REQUIRE (impulse[1] == 0.0 and near (impulse[4], 1.0))
+
+-- fir is a convolution
+local fir = dsp.fir ({ 0.5, 0.25 })
+impulse:clear()
+impulse[1] = 1.0
+fir:process (impulse)
+BOOST_REQUIRE (near (impulse[1], 0.5) and near (impulse[2], 0.25) and impulse[3] == 0.0)
+
+-- a low-pass passes DC, a high-pass removes it
+local lp = dsp.biquad()
+lp:lowpass (48000, 1000)
+local hp = dsp.onepole()
+hp:highpass (48000, 1000)
+local dc = Vector.new (4096)
+dc:fill (1.0)
+local dc2 = Vector.new (4096)
+dc2:copy (dc)
+lp:process (dc)
+hp:process (dc2)
+BOOST_REQUIRE (near (dc[4096], 1.0))
+BOOST_REQUIRE (math.abs (dc2[4096]) < 1.0e-3)
+
+-- processors work on buffer channels too
+local c = AudioBuffer.new (2, 8)
+c:clear()
+c:set (2, 1, 1.0)
+dsp.delay (4):process (c, 2)
+BOOST_REQUIRE (c:get (2, 1) == 0.0 and near (c:get (2, 5), 1.0))